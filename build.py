@@ -1,5 +1,6 @@
 import argparse
 import errno
+import json
 import os
 import shutil
 import stat
@@ -122,6 +123,21 @@ def parse_args():
         default="benchmark_other.json",
         help="specify the other json file path to compare for the benchmarks",
     )
+    parser.add_argument(
+        "--benchmark_baseline",
+        default=None,
+        help=(
+            "specify the json baseline file path to flag the scene benchmark regressions, which is"
+            " the --benchmark_out file of an earlier --benchmark run on the same machine, since"
+            " the medians are absolute (defaults to none)"
+        ),
+    )
+    parser.add_argument(
+        "--benchmark_threshold",
+        type=float,
+        default=0.05,
+        help="specify the relative slowdown threshold to flag the scene benchmark regressions",
+    )
     parser.add_argument(
         "--test",
         action="store_true",
@@ -172,6 +188,8 @@ def get_cmake_targets(args):
         targets.append("barelymusicianwasm")
     if args.benchmark:
         targets.append("barelymusician_benchmark")
+        targets.append("dsp_benchmark")
+        targets.append("barelymusician_stress")
     if args.test:
         targets.append("barelymusician_test")
     if args.examples:
@@ -337,6 +355,37 @@ def run_tests(build_dir):
             run_command(ctest_command, os.path.join(build_dir, platform))
 
 
+def load_benchmark_frame_times(path):
+    with open(path) as file:
+        benchmarks = json.load(file)["benchmarks"]
+    frame_times = {}
+    for benchmark in benchmarks:
+        if "ns_per_frame" not in benchmark:
+            continue
+        name = benchmark.get("run_name", benchmark["name"])
+        if benchmark.get("aggregate_name", "median") == "median":
+            frame_times[name] = benchmark["ns_per_frame"]
+    return frame_times
+
+
+def compare_benchmark_baseline(baseline_path, benchmark_path, threshold):
+    baseline_frame_times = load_benchmark_frame_times(baseline_path)
+    frame_times = load_benchmark_frame_times(benchmark_path)
+    regressions = []
+    for name, baseline_frame_time in baseline_frame_times.items():
+        if name not in frame_times:
+            continue
+        change = frame_times[name] / baseline_frame_time - 1.0
+        print(
+            f"{name}: {baseline_frame_time:.1f} -> {frame_times[name]:.1f} ns/frame ({change:+.1%})"
+        )
+        if change > threshold:
+            regressions.append(name)
+    for name in regressions:
+        print(f"REGRESSION: {name} is more than {threshold:.0%} slower than the baseline")
+    return not regressions
+
+
 def run_benchmarks(args, build_dir):
     for platform in os.listdir(build_dir):
         if (
@@ -354,6 +403,13 @@ def run_benchmarks(args, build_dir):
                 f"{benchmark_path} --benchmark_out={args.benchmark_out} --benchmark_out_format=json"
             )
             run_command(benchmark_command, benchmark_dir)
+            dsp_benchmark_dir = f"{build_dir}/{platform}/src/dsp"
+            if platform != "Linux":
+                dsp_benchmark_dir = os.path.join(dsp_benchmark_dir, f"{get_build_config(args)}")
+            dsp_benchmark_path = os.path.join(dsp_benchmark_dir, "dsp_benchmark")
+            if platform == "Windows":
+                dsp_benchmark_path += ".exe"
+            run_command(dsp_benchmark_path, dsp_benchmark_dir)
             if os.path.exists(
                 os.path.join(benchmark_dir, args.benchmark_compare)
             ) or os.path.exists(args.benchmark_compare):
@@ -364,6 +420,17 @@ def run_benchmarks(args, build_dir):
                     f"python {compare_path} {args.benchmark_compare} {args.benchmark_out}"
                 )
                 run_command(compare_command, benchmark_dir)
+            if args.benchmark_baseline:
+                baseline_path = os.path.join(os.path.dirname(build_dir), args.benchmark_baseline)
+                if not os.path.exists(baseline_path):
+                    print(f"ERROR: Benchmark baseline {baseline_path} does not exist")
+                    sys.exit(1)
+                if not compare_benchmark_baseline(
+                    baseline_path,
+                    os.path.join(benchmark_dir, args.benchmark_out),
+                    args.benchmark_threshold,
+                ):
+                    sys.exit(1)
             break
 
 
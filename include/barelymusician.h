@@ -217,16 +217,22 @@
 #endif  // __cplusplus
 
 /// Default engine configuration.
-#define BARELY_ENGINE_CONFIG_DEFAULT(sample_rate) \
-  {                                               \
-      .sample_##rate = sample_rate,               \
-      .max_instrument_count = 100,                \
-      .max_performer_count = 100,                 \
-      .max_task_count = 5000,                     \
-      .max_command_count = 8192,                  \
-      .max_frame_count = 2048,                    \
-      .max_slice_count = 1000,                    \
-      .max_voice_count = 200,                     \
+#define BARELY_ENGINE_CONFIG_DEFAULT(sample_rate)    \
+  {                                                  \
+      .sample_##rate = sample_rate,                  \
+      .max_instrument_count = 100,                   \
+      .max_performer_count = 100,                    \
+      .max_task_count = 5000,                        \
+      .max_command_count = 8192,                     \
+      .max_frame_count = 2048,                       \
+      .max_slice_count = 1000,                       \
+      .max_voice_count = 200,                        \
+      .max_delay_time = 8.0f,                        \
+      .effect_flags = BarelyEngineEffectFlags_kAll,  \
+      .memory_flags = BarelyEngineMemoryFlags_kNone, \
+      .seed = -1,                                    \
+      .render_cache_frame_count = 0,                 \
+      .freeze_frame_count = 0,                       \
   }
 
 /// Engine control types.
@@ -283,7 +289,8 @@ BARELY_ENUM(EngineControlType, BARELY_ENGINE_CONTROL_TYPES)
   X(InstrumentControlType, ReverbSend, 0.0f, 0.0f, 2.0f, "Reverb Send")                \
   X(InstrumentControlType, SidechainSend, 0.0f, -1.0f, 1.0f, "Sidechain Send")         \
   X(InstrumentControlType, Retrigger, 0, 0, 1, "Retrigger")                            \
-  X(InstrumentControlType, VoiceCount, 8, 1, 16, "Voice Count")
+  X(InstrumentControlType, VoiceCount, 8, 1, 16, "Voice Count")                        \
+  X(InstrumentControlType, RenderCache, 0, 0, 1, "Render Cache")
 BARELY_ENUM(InstrumentControlType, BARELY_INSTRUMENT_CONTROL_TYPES)
 
 /// Note control types.
@@ -309,15 +316,57 @@ BARELY_ENUM(OscMode, BARELY_OSC_MODES)
   X(SliceMode, Once, "Once")
 BARELY_ENUM(SliceMode, BARELY_SLICE_MODES)
 
+/// Engine event types.
+#define BARELY_ENGINE_EVENT_TYPES(EngineEventType, X)         \
+  X(EngineEventType, EngineControl, "Engine Control")         \
+  X(EngineEventType, InstrumentControl, "Instrument Control") \
+  X(EngineEventType, NoteControl, "Note Control")             \
+  X(EngineEventType, NoteOff, "Note Off")                     \
+  X(EngineEventType, NoteOn, "Note On")
+BARELY_ENUM(EngineEventType, BARELY_ENGINE_EVENT_TYPES)
+
 /// Task event types.
 #define BARELY_TASK_EVENT_TYPES(TaskEventType, X) \
   X(TaskEventType, Begin, "Begin")                \
   X(TaskEventType, End, "End")
 BARELY_ENUM(TaskEventType, BARELY_TASK_EVENT_TYPES)
 
+/// Engine effect flags, which can be combined to enable the effects that need their own buffers.
+typedef enum BarelyEngineEffectFlags {
+  /// Disables all effects with buffers.
+  BarelyEngineEffectFlags_kNone = 0,
+  /// Enables the delay.
+  BarelyEngineEffectFlags_kDelay = 1 << 0,
+  /// Enables the reverb.
+  BarelyEngineEffectFlags_kReverb = 1 << 1,
+  /// Enables all effects with buffers.
+  BarelyEngineEffectFlags_kAll = BarelyEngineEffectFlags_kDelay | BarelyEngineEffectFlags_kReverb,
+} BarelyEngineEffectFlags;
+
+/// Engine memory flags, which can be combined to prepare the allocation at creation.
+typedef enum BarelyEngineMemoryFlags {
+  /// Leaves the allocation as is.
+  BarelyEngineMemoryFlags_kNone = 0,
+  /// Touches every page of the allocation to avoid page faults on the audio thread.
+  BarelyEngineMemoryFlags_kPrefault = 1 << 0,
+  /// Locks the allocation in physical memory until the engine is destroyed (POSIX only).
+  BarelyEngineMemoryFlags_kLock = 1 << 1,
+  /// Advises transparent huge pages for the allocation to reduce the TLB pressure (Linux only),
+  /// which is most effective on a fresh allocation that was not touched yet.
+  BarelyEngineMemoryFlags_kHugePages = 1 << 2,
+  /// Stores the delay and reverb lines in half precision to halve their memory and bandwidth.
+  BarelyEngineMemoryFlags_kCompactEffects = 1 << 3,
+} BarelyEngineMemoryFlags;
+
 /// Engine handle.
 typedef struct BarelyEngine BarelyEngine;
 
+/// Engine group handle, which processes engines in parallel on a shared pool of worker threads.
+typedef struct BarelyEngineGroup BarelyEngineGroup;
+
+/// Sample bank handle, which can be shared by instruments across engines.
+typedef struct BarelySampleBank BarelySampleBank;
+
 /// Engine configuration.
 typedef struct BarelyEngineConfig {
   /// Sampling rate in hertz.
@@ -343,8 +392,105 @@ typedef struct BarelyEngineConfig {
 
   /// Maximum number of active voices.
   int32_t max_voice_count;
+
+  /// Maximum delay time in seconds.
+  float max_delay_time;
+
+  /// Effect flags of `BarelyEngineEffectFlags`, where the disabled effects are bypassed.
+  int32_t effect_flags;
+
+  /// Memory flags of `BarelyEngineMemoryFlags`.
+  int32_t memory_flags;
+
+  /// Random number generator seed, or negative to seed from the current time.
+  ///
+  /// A fixed seed renders deterministically, where the same calls give bit-identical output. Each
+  /// voice draws from its own random stream, which is derived from the seed, its instrument and the
+  /// number of prior note ons of that instrument, so that the voices do not depend on their
+  /// processing order.
+  int32_t seed;
+
+  /// Number of frames of the render cache, which replays the repeated one-shot slice notes of the
+  /// instruments that enable it instead of processing them again, or zero to disable it.
+  int32_t render_cache_frame_count;
+
+  /// Number of frames that the frozen instruments share to loop their output, or zero to disable
+  /// freezing.
+  int32_t freeze_frame_count;
 } BarelyEngineConfig;
 
+/// Engine memory breakdown in bytes.
+typedef struct BarelyEngineMemoryBreakdown {
+  /// Instrument pool with its parameters.
+  int32_t instrument_pool_size;
+
+  /// Performer pool with its task event queue.
+  int32_t performer_pool_size;
+
+  /// Task pool with its scratch arrays.
+  int32_t task_pool_size;
+
+  /// Voice pool.
+  int32_t voice_pool_size;
+
+  /// Slice pool.
+  int32_t slice_pool_size;
+
+  /// Command queue.
+  int32_t command_queue_size;
+
+  /// Delay line.
+  int32_t delay_size;
+
+  /// Reverb lines.
+  int32_t reverb_size;
+
+  /// Scratch sample buffers.
+  int32_t scratch_size;
+
+  /// Render cache.
+  int32_t render_cache_size;
+
+  /// Freeze frames.
+  int32_t freeze_size;
+
+  /// Total size, which also includes the engine state itself and the alignment padding.
+  int32_t total_size;
+} BarelyEngineMemoryBreakdown;
+
+/// Pool usage.
+typedef struct BarelyPoolUsage {
+  /// Number of active items.
+  int32_t active_count;
+
+  /// Maximum number of active items since the engine was created.
+  int32_t max_active_count;
+
+  /// Maximum number of items.
+  int32_t capacity;
+} BarelyPoolUsage;
+
+/// Engine usage.
+typedef struct BarelyEngineUsage {
+  /// Instrument pool usage.
+  BarelyPoolUsage instruments;
+
+  /// Performer pool usage.
+  BarelyPoolUsage performers;
+
+  /// Task pool usage.
+  BarelyPoolUsage tasks;
+
+  /// Voice pool usage as of the last process.
+  BarelyPoolUsage voices;
+
+  /// Slice pool usage.
+  BarelyPoolUsage slices;
+
+  /// Command queue usage.
+  BarelyPoolUsage commands;
+} BarelyEngineUsage;
+
 /// Musical quantization.
 typedef struct BarelyQuantization {
   /// Subdivision of a beat.
@@ -369,6 +515,21 @@ typedef struct BarelyScale {
   int32_t mode;
 } BarelyScale;
 
+/// Note of a clip.
+typedef struct BarelyNote {
+  /// Position in beats.
+  double position;
+
+  /// Duration in beats.
+  double duration;
+
+  /// Pitch.
+  float pitch;
+
+  /// Gain.
+  float gain;
+} BarelyNote;
+
 /// Slice of sample data.
 typedef struct BarelySlice {
   /// Array of mono samples.
@@ -384,6 +545,18 @@ typedef struct BarelySlice {
   float root_pitch;
 } BarelySlice;
 
+/// Tempo point.
+typedef struct BarelyTempoPoint {
+  /// Timestamp in seconds.
+  double timestamp;
+
+  /// Tempo in beats per minute.
+  double tempo;
+
+  /// Denotes whether the tempo ramps linearly to the next point, or stays constant.
+  bool is_ramp;
+} BarelyTempoPoint;
+
 #ifdef __cplusplus
 extern "C" {
 #endif  // __cplusplus
@@ -393,11 +566,84 @@ extern "C" {
 /// @param user_data Pointer to user data.
 typedef void (*BarelyTaskCallback)(BarelyTaskEventType type, void* user_data);
 
+/// Task description.
+typedef struct BarelyTaskDesc {
+  /// Position in beats.
+  double position;
+
+  /// Duration in beats.
+  double duration;
+
+  /// Priority.
+  int32_t priority;
+
+  /// Callback.
+  BarelyTaskCallback callback;
+
+  /// Pointer to user data.
+  void* user_data;
+} BarelyTaskDesc;
+
+/// Engine process job of an engine group.
+typedef struct BarelyEngineProcessJob {
+  /// Pointer to engine.
+  BarelyEngine* engine;
+
+  /// Array of interleaved output samples.
+  float* output_samples;
+
+  /// Timestamp in seconds.
+  double timestamp;
+} BarelyEngineProcessJob;
+
+/// Engine event, which is applied at a frame of the processed output samples.
+typedef struct BarelyEngineEvent {
+  /// Frame offset in the output samples.
+  int32_t frame;
+
+  /// Engine event type.
+  BarelyEngineEventType type;
+
+  /// Instrument identifier, which is ignored for the engine control events.
+  uint32_t instrument_id;
+
+  /// Engine, instrument, or note control type, which matches the event type.
+  int32_t control_type;
+
+  /// Note pitch.
+  float pitch;
+
+  /// Control value.
+  float value;
+} BarelyEngineEvent;
+
+/// Task event.
+typedef struct BarelyTaskEvent {
+  /// Task identifier.
+  uint32_t task_id;
+
+  /// Task event type.
+  BarelyTaskEventType type;
+
+  /// Performer position in beats.
+  double position;
+
+  /// Timestamp in seconds.
+  double timestamp;
+} BarelyTaskEvent;
+
 /// Returns the required memory allocation size for an engine configuration.
 /// @param config Pointer to engine configuration.
 /// @return Required memory allocation size.
 BARELY_API int32_t BarelyEngineConfig_GetRequiredAllocationSize(const BarelyEngineConfig* config);
 
+/// Gets the memory breakdown for an engine configuration.
+/// @param config Pointer to engine configuration.
+/// @param out_memory_breakdown Output memory breakdown.
+/// @return True if successful, false otherwise.
+BARELY_API bool BarelyEngineConfig_GetMemoryBreakdown(
+    const BarelyEngineConfig* config, BarelyEngineMemoryBreakdown* out_memory_breakdown);
+
 /// Returns the quantized position for a given position.
 /// @param quantization Pointer to quantization.
 /// @param position Position.
@@ -438,11 +684,44 @@ BARELY_API void BarelyEngine_Destroy(BarelyEngine* engine);
 /// @return Random number.
 BARELY_API double BarelyEngine_GenerateRandomNumber(BarelyEngine* engine);
 
+/// Returns the required memory allocation size to grow the pools of an engine.
+/// @param engine Pointer to engine.
+/// @param max_slice_count Maximum number of active slices.
+/// @param max_task_count Maximum number of tasks.
+/// @param max_voice_count Maximum number of active voices.
+/// @return Required memory allocation size in bytes.
+BARELY_API int32_t BarelyEngine_GetRequiredPoolAllocationSize(const BarelyEngine* engine,
+                                                              int32_t max_slice_count,
+                                                              int32_t max_task_count,
+                                                              int32_t max_voice_count);
+
 /// Returns the timestamp of an engine.
 /// @param engine Pointer to engine.
 /// @return Timestamp in seconds.
 BARELY_API double BarelyEngine_GetTimestamp(const BarelyEngine* engine);
 
+/// Gets the pool usage of an engine.
+/// @param engine Pointer to engine.
+/// @param out_usage Output engine usage.
+/// @return True if successful, false otherwise.
+BARELY_API bool BarelyEngine_GetUsage(const BarelyEngine* engine, BarelyEngineUsage* out_usage);
+
+/// Grows the pools of an engine without losing its state, where the counts that do not exceed the
+/// current ones are left as is. The allocation must outlive the engine, and the voices switch over
+/// when the next process reaches the current timestamp. This must not be called from task
+/// callbacks.
+/// @param engine Pointer to engine.
+/// @param max_slice_count Maximum number of active slices.
+/// @param max_task_count Maximum number of tasks, which cannot exceed the identifier capacity of
+/// the initial configuration.
+/// @param max_voice_count Maximum number of active voices.
+/// @param allocation Pointer to memory allocation.
+/// @param allocation_size Memory allocation size.
+/// @return True if successful, false otherwise.
+BARELY_API bool BarelyEngine_GrowPools(BarelyEngine* engine, int32_t max_slice_count,
+                                       int32_t max_task_count, int32_t max_voice_count,
+                                       void* allocation, int32_t allocation_size);
+
 /// Processes the next output samples of an engine at timestamp.
 /// @param engine Pointer to engine.
 /// @param output_samples Array of interleaved output samples.
@@ -453,6 +732,27 @@ BARELY_API void BarelyEngine_Process(BarelyEngine* engine, float* output_samples
                                      int32_t output_channel_count, int32_t output_frame_count,
                                      double timestamp);
 
+/// Processes the next output samples of an engine at timestamp, and applies the events of the host
+/// at their frames.
+///
+/// The events skip the command queue, which makes them sample accurate without any lookahead. They
+/// get applied in array order, so they should be sorted by their frames, where the out of order
+/// frames are applied right away, and the frames outside of the output samples are ignored. Each
+/// event matches its setter in the audio thread, where an event of a frozen instrument thaws it,
+/// and the control thread catches up with the thaw in its next update.
+/// @param engine Pointer to engine.
+/// @param output_samples Array of interleaved output samples.
+/// @param output_channel_count Number of output channels.
+/// @param output_frame_count Number of output frames.
+/// @param timestamp Timestamp in seconds.
+/// @param events Array of engine events.
+/// @param event_count Number of engine events.
+BARELY_API void BarelyEngine_ProcessWithEvents(BarelyEngine* engine, float* output_samples,
+                                               int32_t output_channel_count,
+                                               int32_t output_frame_count, double timestamp,
+                                               const BarelyEngineEvent* events,
+                                               int32_t event_count);
+
 /// Resets the random number generator seed of an engine.
 /// @param engine Pointer to engine.
 /// @param seed Seed value.
@@ -470,16 +770,123 @@ BARELY_API void BarelyEngine_SetControl(BarelyEngine* engine, BarelyEngineContro
 /// @param tempo Tempo in beats per minute.
 BARELY_API void BarelyEngine_SetTempo(BarelyEngine* engine, double tempo);
 
+/// Sets the tempo map of an engine.
+///
+/// The tempo points override the constant tempo from the first point onwards, which advances the
+/// performers across the tempo changes without any callbacks. Up to 64 points are supported, and
+/// setting the tempo clears them.
+/// @param engine Pointer to engine.
+/// @param points Array of tempo points.
+/// @param point_count Number of tempo points.
+BARELY_API void BarelyEngine_SetTempoMap(BarelyEngine* engine, const BarelyTempoPoint* points,
+                                         int32_t point_count);
+
 /// Updates an engine at timestamp.
 /// @param engine Pointer to engine.
 /// @param timestamp Timestamp in seconds.
 BARELY_API void BarelyEngine_Update(BarelyEngine* engine, double timestamp);
 
+/// Updates an engine until the end of the next output samples, and processes them at timestamp.
+///
+/// This replaces the separate `BarelyEngine_Update` calls to advance the performers in the audio
+/// thread, which plays the tasks that are due with sample accuracy and without any lookahead. In
+/// return, the engine must only be accessed from the same thread, including the task callbacks.
+/// @param engine Pointer to engine.
+/// @param output_samples Array of interleaved output samples.
+/// @param output_channel_count Number of output channels.
+/// @param output_frame_count Number of output frames.
+/// @param timestamp Timestamp in seconds.
+BARELY_API void BarelyEngine_UpdateAndProcess(BarelyEngine* engine, float* output_samples,
+                                              int32_t output_channel_count,
+                                              int32_t output_frame_count, double timestamp);
+
+/// Updates an engine at timestamp, and returns the task events in a batch instead of processing
+/// their callbacks.
+///
+/// This allows processing the task events in batches, e.g., to avoid a native to managed transition
+/// per task event in managed runtimes. The task events get returned in their processing order, and
+/// only the tasks with callbacks have task events.
+///
+/// The update stops at the timestamp of the returned task events, so that the instrument calls made
+/// while processing them get scheduled at that timestamp. It also stops once the array is full.
+/// Therefore, it must be called again with the same timestamp until it returns zero, which
+/// completes the update. If more task events happen at once than the array fits, the callbacks of
+/// the remaining task events get processed as usual, and the returned number exceeds the array.
+/// @param engine Pointer to engine.
+/// @param timestamp Timestamp in seconds.
+/// @param out_task_events Array of task events.
+/// @param max_task_event_count Maximum number of task events.
+/// @return Number of task events, where the ones up to the maximum are returned in the array.
+BARELY_API int32_t BarelyEngine_UpdateWithTaskEvents(BarelyEngine* engine, double timestamp,
+                                                     BarelyTaskEvent* out_task_events,
+                                                     int32_t max_task_event_count);
+
+/// Creates a new engine group.
+///
+/// The calling thread of `BarelyEngineGroup_Process` takes part in the processing next to the
+/// worker threads. Without thread support (e.g., on Daisy), the calling thread processes all the
+/// engines in order.
+/// @param worker_count Number of worker threads.
+/// @param worker_cpus Optional array of cpu indices to pin each worker thread to (Linux only),
+/// where negative indices leave the respective worker threads unpinned.
+/// @param allocation Pointer to memory allocation.
+/// @param allocation_size Memory allocation size.
+/// @return Pointer to engine group.
+BARELY_API BarelyEngineGroup* BarelyEngineGroup_Create(int32_t worker_count,
+                                                       const int32_t* worker_cpus,
+                                                       void* allocation, int32_t allocation_size);
+
+/// Destroys an engine group, which joins its worker threads.
+/// @param engine_group Pointer to engine group.
+BARELY_API void BarelyEngineGroup_Destroy(BarelyEngineGroup* engine_group);
+
+/// Returns the required memory allocation size for an engine group.
+/// @param worker_count Number of worker threads.
+/// @return Required memory allocation size.
+BARELY_API int32_t BarelyEngineGroup_GetRequiredAllocationSize(int32_t worker_count);
+
+/// Processes the next output samples of engines in parallel, and returns once all of them are
+/// ready.
+///
+/// Each engine keeps to the same worker thread across the calls with the same job order, and the
+/// idle threads steal the remaining jobs of the others. An engine must not appear in more than one
+/// job, since the worker threads would process it concurrently, and must not be processed
+/// elsewhere during the call.
+/// @param engine_group Pointer to engine group.
+/// @param jobs Array of engine process jobs.
+/// @param job_count Number of engine process jobs.
+/// @param output_channel_count Number of output channels.
+/// @param output_frame_count Number of output frames.
+BARELY_API void BarelyEngineGroup_Process(BarelyEngineGroup* engine_group,
+                                          const BarelyEngineProcessJob* jobs, int32_t job_count,
+                                          int32_t output_channel_count,
+                                          int32_t output_frame_count);
+
 /// Destroys an instrument.
 /// @param engine Pointer to engine.
 /// @param instrument_id Instrument identifier.
 BARELY_API void BarelyInstrument_Destroy(BarelyEngine* engine, uint32_t instrument_id);
 
+/// Freezes an instrument with the clip notes of a performer, which loops its output in place of
+/// processing its voices.
+///
+/// The instrument keeps playing live for the next loop of the performer, which is recorded into the
+/// freeze frames at the current tempo, and then loops the recording back. It thaws once any of its
+/// controls, notes or sample data are set directly, or once the performer, its clip tasks or the
+/// tempo change. The notes of the active clip tasks restart at thaw, while the frozen tails stop.
+/// @param engine Pointer to engine.
+/// @param instrument_id Instrument identifier.
+/// @param performer_id Performer identifier, which must be playing in a loop.
+/// @return True if successful, false otherwise.
+BARELY_API bool BarelyInstrument_Freeze(BarelyEngine* engine, uint32_t instrument_id,
+                                        uint32_t performer_id);
+
+/// Gets whether an instrument is frozen or not.
+/// @param engine Pointer to engine.
+/// @param instrument_id Instrument identifier.
+/// @return True if frozen, false otherwise.
+BARELY_API bool BarelyInstrument_IsFrozen(const BarelyEngine* engine, uint32_t instrument_id);
+
 /// Sets an instrument control value.
 /// @param engine Pointer to engine.
 /// @param instrument_id Instrument identifier.
@@ -512,6 +919,16 @@ BARELY_API void BarelyInstrument_SetNoteOff(BarelyEngine* engine, uint32_t instr
 BARELY_API void BarelyInstrument_SetNoteOn(BarelyEngine* engine, uint32_t instrument_id,
                                            float pitch);
 
+/// Sets an instrument sample bank, which replaces its sample data without copying the slices.
+///
+/// The instrument references the bank until its sample data or sample bank is set again, or until
+/// it is destroyed.
+/// @param engine Pointer to engine.
+/// @param instrument_id Instrument identifier.
+/// @param sample_bank Pointer to sample bank, or null to clear the sample data.
+BARELY_API void BarelyInstrument_SetSampleBank(BarelyEngine* engine, uint32_t instrument_id,
+                                               BarelySampleBank* sample_bank);
+
 /// Sets instrument sample data.
 /// @param engine Pointer to engine.
 /// @param instrument_id Instrument identifier.
@@ -520,6 +937,25 @@ BARELY_API void BarelyInstrument_SetNoteOn(BarelyEngine* engine, uint32_t instru
 BARELY_API void BarelyInstrument_SetSampleData(BarelyEngine* engine, uint32_t instrument_id,
                                                const BarelySlice* slices, int32_t slice_count);
 
+/// Thaws an instrument, which plays its voices live again.
+/// @param engine Pointer to engine.
+/// @param instrument_id Instrument identifier.
+BARELY_API void BarelyInstrument_Thaw(BarelyEngine* engine, uint32_t instrument_id);
+
+/// Creates a new performer clip of notes to play on an instrument.
+///
+/// Each note is created as a task that sets its note on and off directly, without a callback.
+/// @param engine Pointer to engine.
+/// @param performer_id Performer identifier.
+/// @param instrument_id Instrument identifier.
+/// @param notes Array of notes.
+/// @param note_count Number of notes.
+/// @param out_task_ids Array of task identifiers.
+/// @return Number of created tasks, which are the first tasks in the array.
+BARELY_API int32_t BarelyPerformer_CreateClip(BarelyEngine* engine, uint32_t performer_id,
+                                              uint32_t instrument_id, const BarelyNote* notes,
+                                              int32_t note_count, uint32_t* out_task_ids);
+
 /// Creates a new performer task.
 /// @param engine Pointer to engine.
 /// @param performer_id Performer identifier.
@@ -533,6 +969,17 @@ BARELY_API uint32_t BarelyPerformer_CreateTask(BarelyEngine* engine, uint32_t pe
                                                double position, double duration, int32_t priority,
                                                BarelyTaskCallback callback, void* user_data);
 
+/// Creates new performer tasks in a batch.
+/// @param engine Pointer to engine.
+/// @param performer_id Performer identifier.
+/// @param task_descs Array of task descriptions.
+/// @param task_count Number of tasks.
+/// @param out_task_ids Array of task identifiers.
+/// @return Number of created tasks, which are the first tasks in the array.
+BARELY_API int32_t BarelyPerformer_CreateTasks(BarelyEngine* engine, uint32_t performer_id,
+                                               const BarelyTaskDesc* task_descs,
+                                               int32_t task_count, uint32_t* out_task_ids);
+
 /// Destroys a performer.
 /// @param engine Pointer to engine.
 /// @param performer_id Performer identifier.
@@ -582,6 +1029,30 @@ BARELY_API void BarelyPerformer_Start(BarelyEngine* engine, uint32_t performer_i
 /// @param performer_id Performer identifier.
 BARELY_API void BarelyPerformer_Stop(BarelyEngine* engine, uint32_t performer_id);
 
+/// Creates a new sample bank, which sorts the slices by their root pitches.
+/// @param slices Array of slices.
+/// @param slice_count Number of slices.
+/// @param allocation Pointer to memory allocation.
+/// @param allocation_size Memory allocation size.
+/// @return Pointer to sample bank.
+BARELY_API BarelySampleBank* BarelySampleBank_Create(const BarelySlice* slices, int32_t slice_count,
+                                                     void* allocation, int32_t allocation_size);
+
+/// Destroys a sample bank, which fails while any instrument still references it.
+/// @param sample_bank Pointer to sample bank.
+/// @return True if successful, false otherwise.
+BARELY_API bool BarelySampleBank_Destroy(BarelySampleBank* sample_bank);
+
+/// Returns the number of instruments that reference a sample bank.
+/// @param sample_bank Pointer to sample bank.
+/// @return Reference count.
+BARELY_API int32_t BarelySampleBank_GetReferenceCount(const BarelySampleBank* sample_bank);
+
+/// Returns the required memory allocation size for a sample bank.
+/// @param slice_count Number of slices.
+/// @return Required memory allocation size.
+BARELY_API int32_t BarelySampleBank_GetRequiredAllocationSize(int32_t slice_count);
+
 /// Destroys a task.
 /// @param engine Pointer to engine.
 /// @param task_id Task identifier.
@@ -629,6 +1100,7 @@ BARELY_API void BarelyTask_SetPriority(BarelyEngine* engine, uint32_t task_id, i
 /// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 #ifdef __cplusplus
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cstddef>
@@ -640,6 +1112,7 @@ BARELY_API void BarelyTask_SetPriority(BarelyEngine* engine, uint32_t task_id, i
 #include <span>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace barely {
 
@@ -659,6 +1132,16 @@ struct EngineConfig : public BarelyEngineConfig {
   // NOLINTNEXTLINE(google-explicit-constructor)
   constexpr EngineConfig(BarelyEngineConfig config) noexcept : BarelyEngineConfig{config} {}
 
+  /// Returns the memory breakdown.
+  /// @return Memory breakdown in bytes.
+  [[nodiscard]] BarelyEngineMemoryBreakdown GetMemoryBreakdown() const noexcept {
+    BarelyEngineMemoryBreakdown memory_breakdown = {};
+    [[maybe_unused]] const bool success =
+        BarelyEngineConfig_GetMemoryBreakdown(this, &memory_breakdown);
+    assert(success);
+    return memory_breakdown;
+  }
+
   /// Returns the required memory allocation size.
   /// @return Required memory allocation size.
   [[nodiscard]] int32_t GetRequiredAllocationSize() const noexcept {
@@ -749,10 +1232,227 @@ struct Slice : public BarelySlice {
   constexpr Slice(BarelySlice slice) noexcept : BarelySlice{slice} {}
 };
 
+/// Note of a clip.
+struct Note : public BarelyNote {
+  /// Default constructor.
+  Note() noexcept = default;
+
+  /// Constructs a new `Note`.
+  /// @param position Position in beats.
+  /// @param duration Duration in beats.
+  /// @param pitch Pitch.
+  /// @param gain Gain.
+  constexpr Note(double position, double duration, float pitch, float gain = 1.0f) noexcept
+      : Note(BarelyNote{position, duration, pitch, gain}) {}
+
+  /// Constructs a new `Note` from a raw type.
+  /// @param note Raw note.
+  // NOLINTNEXTLINE(google-explicit-constructor)
+  constexpr Note(BarelyNote note) noexcept : BarelyNote{note} {}
+};
+
+/// Tempo point.
+struct TempoPoint : public BarelyTempoPoint {
+  /// Default constructor.
+  TempoPoint() noexcept = default;
+
+  /// Constructs a new `TempoPoint`.
+  /// @param timestamp Timestamp in seconds.
+  /// @param tempo Tempo in beats per minute.
+  /// @param is_ramp True if ramps linearly to the next point, false otherwise.
+  constexpr TempoPoint(double timestamp, double tempo, bool is_ramp = false) noexcept
+      : TempoPoint(BarelyTempoPoint{timestamp, tempo, is_ramp}) {}
+
+  /// Constructs a new `TempoPoint` from a raw type.
+  /// @param tempo_point Raw tempo point.
+  // NOLINTNEXTLINE(google-explicit-constructor)
+  constexpr TempoPoint(BarelyTempoPoint tempo_point) noexcept : BarelyTempoPoint{tempo_point} {}
+};
+
+/// Engine process job of an engine group.
+struct EngineProcessJob : public BarelyEngineProcessJob {
+  /// Default constructor.
+  EngineProcessJob() noexcept = default;
+
+  /// Constructs a new `EngineProcessJob`.
+  /// @param engine Pointer to raw engine.
+  /// @param output_samples Array of interleaved output samples.
+  /// @param timestamp Timestamp in seconds.
+  constexpr EngineProcessJob(BarelyEngine* engine, float* output_samples, double timestamp) noexcept
+      : EngineProcessJob(BarelyEngineProcessJob{engine, output_samples, timestamp}) {}
+
+  /// Constructs a new `EngineProcessJob` from a raw type.
+  /// @param job Raw engine process job.
+  // NOLINTNEXTLINE(google-explicit-constructor)
+  constexpr EngineProcessJob(BarelyEngineProcessJob job) noexcept : BarelyEngineProcessJob{job} {}
+};
+
+/// Engine event, which is applied at a frame of the processed output samples.
+struct EngineEvent : public BarelyEngineEvent {
+  /// Default constructor.
+  EngineEvent() noexcept = default;
+
+  /// Constructs a new `EngineEvent` from a raw type.
+  /// @param event Raw engine event.
+  // NOLINTNEXTLINE(google-explicit-constructor)
+  constexpr EngineEvent(BarelyEngineEvent event) noexcept : BarelyEngineEvent{event} {}
+
+  /// Returns a new engine control event.
+  /// @param frame Frame offset in the output samples.
+  /// @param type Engine control type.
+  /// @param value Engine control value.
+  /// @return Engine event.
+  [[nodiscard]] static constexpr EngineEvent EngineControl(int32_t frame, EngineControlType type,
+                                                           float value) noexcept {
+    return BarelyEngineEvent{frame, BarelyEngineEventType_kEngineControl, 0,
+                             static_cast<int32_t>(type), 0.0f, value};
+  }
+
+  /// Returns a new instrument control event.
+  /// @param frame Frame offset in the output samples.
+  /// @param instrument_id Instrument identifier.
+  /// @param type Instrument control type.
+  /// @param value Instrument control value.
+  /// @return Engine event.
+  [[nodiscard]] static constexpr EngineEvent InstrumentControl(int32_t frame,
+                                                               uint32_t instrument_id,
+                                                               InstrumentControlType type,
+                                                               float value) noexcept {
+    return BarelyEngineEvent{frame, BarelyEngineEventType_kInstrumentControl, instrument_id,
+                             static_cast<int32_t>(type), 0.0f, value};
+  }
+
+  /// Returns a new note control event.
+  /// @param frame Frame offset in the output samples.
+  /// @param instrument_id Instrument identifier.
+  /// @param pitch Note pitch.
+  /// @param type Note control type.
+  /// @param value Note control value.
+  /// @return Engine event.
+  [[nodiscard]] static constexpr EngineEvent NoteControl(int32_t frame, uint32_t instrument_id,
+                                                         float pitch, NoteControlType type,
+                                                         float value) noexcept {
+    return BarelyEngineEvent{frame, BarelyEngineEventType_kNoteControl, instrument_id,
+                             static_cast<int32_t>(type), pitch, value};
+  }
+
+  /// Returns a new note off event.
+  /// @param frame Frame offset in the output samples.
+  /// @param instrument_id Instrument identifier.
+  /// @param pitch Note pitch.
+  /// @return Engine event.
+  [[nodiscard]] static constexpr EngineEvent NoteOff(int32_t frame, uint32_t instrument_id,
+                                                     float pitch) noexcept {
+    return BarelyEngineEvent{frame, BarelyEngineEventType_kNoteOff, instrument_id, 0, pitch, 0.0f};
+  }
+
+  /// Returns a new note on event.
+  /// @param frame Frame offset in the output samples.
+  /// @param instrument_id Instrument identifier.
+  /// @param pitch Note pitch.
+  /// @return Engine event.
+  [[nodiscard]] static constexpr EngineEvent NoteOn(int32_t frame, uint32_t instrument_id,
+                                                    float pitch) noexcept {
+    return BarelyEngineEvent{frame, BarelyEngineEventType_kNoteOn, instrument_id, 0, pitch, 0.0f};
+  }
+};
+
 /// Task callback function.
 /// @param type Task event type.
 using TaskCallback = std::function<void(TaskEventType type)>;
 
+/// Task description.
+struct TaskDesc {
+  /// Position in beats.
+  double position = 0.0;
+
+  /// Duration in beats.
+  double duration = 0.0;
+
+  /// Priority.
+  int32_t priority = 0;
+
+  /// Callback.
+  TaskCallback callback = nullptr;
+};
+
+/// Class that wraps a sample bank, which can be shared by instruments across engines.
+///
+/// The engines keep the sample bank alive while their instruments reference it, so it can be
+/// destroyed before them.
+class SampleBank {
+ public:
+  /// Constructs a new `SampleBank`.
+  /// @param slices Span of slices.
+  explicit SampleBank(std::span<const Slice> slices) noexcept
+      : storage_(std::make_shared<Storage>()) {
+    storage_->allocation.resize(static_cast<size_t>(
+        BarelySampleBank_GetRequiredAllocationSize(static_cast<int32_t>(slices.size()))));
+    storage_->sample_bank = BarelySampleBank_Create(
+        reinterpret_cast<const BarelySlice*>(slices.data()), static_cast<int32_t>(slices.size()),
+        storage_->allocation.data(), static_cast<int32_t>(storage_->allocation.size()));
+    assert(storage_->sample_bank != nullptr);
+  }
+
+  /// Destroys `SampleBank`.
+  ~SampleBank() noexcept = default;
+
+  /// Non-copyable.
+  SampleBank(const SampleBank& other) noexcept = delete;
+  SampleBank& operator=(const SampleBank& other) noexcept = delete;
+
+  /// Constructs a new `SampleBank` via move.
+  /// @param other Other sample bank.
+  SampleBank(SampleBank&& other) noexcept : storage_(std::exchange(other.storage_, {})) {}
+
+  /// Assigns `SampleBank` via move.
+  /// @param other Other sample bank.
+  /// @return Sample bank.
+  SampleBank& operator=(SampleBank&& other) noexcept {
+    if (this != &other) {
+      storage_ = std::exchange(other.storage_, {});
+    }
+    return *this;
+  }
+
+  /// Returns the number of instruments that reference the sample bank.
+  /// @return Reference count.
+  [[nodiscard]] int32_t GetReferenceCount() const noexcept {
+    return BarelySampleBank_GetReferenceCount(*this);
+  }
+
+  /// Returns the raw sample bank.
+  /// @return Pointer to raw sample bank.
+  // NOLINTNEXTLINE(google-explicit-constructor)
+  [[nodiscard]] operator BarelySampleBank*() const noexcept {
+    return (storage_ != nullptr) ? storage_->sample_bank : nullptr;
+  }
+
+ private:
+  friend class Engine;
+  friend class Instrument;
+
+  // Storage that is shared with the engines, which is destroyed with its last owner.
+  struct Storage {
+    Storage() noexcept = default;
+    ~Storage() noexcept {
+      if (sample_bank != nullptr) {
+        // The engines release their instrument references before their storage.
+        [[maybe_unused]] const bool success = BarelySampleBank_Destroy(sample_bank);
+        assert(success);
+      }
+    }
+    Storage(const Storage& other) noexcept = delete;
+    Storage& operator=(const Storage& other) noexcept = delete;
+
+    std::vector<std::byte> allocation;
+    BarelySampleBank* sample_bank = nullptr;
+  };
+  using StoragePtrs = std::vector<std::shared_ptr<Storage>>;
+
+  std::shared_ptr<Storage> storage_;
+};
+
 /// Class that wraps an instrument.
 class Instrument {
  public:
@@ -769,6 +1469,20 @@ class Instrument {
   // NOLINTNEXTLINE(google-explicit-constructor)
   [[nodiscard]] constexpr operator uint32_t() const noexcept { return instrument_id_; }
 
+  /// Freezes the instrument with the clip notes of a performer, which loops its output in place of
+  /// processing its voices until it thaws.
+  /// @param performer_id Performer identifier.
+  /// @return True if successful, false otherwise.
+  bool Freeze(uint32_t performer_id) noexcept {
+    return BarelyInstrument_Freeze(engine_, instrument_id_, performer_id);
+  }
+
+  /// Returns whether the instrument is frozen or not.
+  /// @return True if frozen, false otherwise.
+  [[nodiscard]] bool IsFrozen() const noexcept {
+    return BarelyInstrument_IsFrozen(engine_, instrument_id_);
+  }
+
   /// Sets a control value.
   /// @param type Instrument control type.
   /// @param value Instrument control value.
@@ -814,6 +1528,23 @@ class Instrument {
     }
   }
 
+  /// Sets the sample bank, which the engine keeps alive while its instruments reference it.
+  /// @param sample_bank Sample bank.
+  void SetSampleBank(const SampleBank& sample_bank) noexcept {
+    BarelyInstrument_SetSampleBank(engine_, instrument_id_, sample_bank);
+    if (sample_banks_ == nullptr) {
+      return;
+    }
+    std::erase_if(*sample_banks_, [](const auto& storage) {
+      return BarelySampleBank_GetReferenceCount(storage->sample_bank) == 0;
+    });
+    if (sample_bank.storage_ != nullptr && sample_bank.GetReferenceCount() > 0 &&
+        std::find(sample_banks_->begin(), sample_banks_->end(), sample_bank.storage_) ==
+            sample_banks_->end()) {
+      sample_banks_->push_back(sample_bank.storage_);
+    }
+  }
+
   /// Sets the sample data.
   /// @param slices Span of slices.
   void SetSampleData(std::span<const Slice> slices) noexcept {
@@ -822,10 +1553,15 @@ class Instrument {
                                    static_cast<int32_t>(slices.size()));
   }
 
+  /// Thaws the instrument, which plays its voices live again.
+  void Thaw() noexcept { BarelyInstrument_Thaw(engine_, instrument_id_); }
+
  private:
   friend class Engine;
-  Instrument(BarelyEngine* engine, uint32_t instrument_id) noexcept
-      : engine_(engine), instrument_id_(instrument_id) {}
+  Instrument(SampleBank::StoragePtrs* sample_banks, BarelyEngine* engine,
+             uint32_t instrument_id) noexcept
+      : sample_banks_(sample_banks), engine_(engine), instrument_id_(instrument_id) {}
+  SampleBank::StoragePtrs* sample_banks_ = nullptr;
   BarelyEngine* engine_ = nullptr;
   uint32_t instrument_id_ = 0;
 };
@@ -905,20 +1641,32 @@ class Task {
   template <typename T>
   struct Pool {
     Pool() noexcept = default;
-    explicit Pool(int32_t capacity) noexcept
-        : items_(std::make_unique<T[]>(capacity)),
-          free_(std::make_unique<T*[]>(capacity)),
-          free_count_(capacity) {
-      for (int32_t i = 0; i < capacity; ++i) {
-        free_[i] = &items_[i];
-      }
-    }
+    explicit Pool(int32_t capacity) noexcept { Grow(capacity); }
     [[nodiscard]] T* Acquire() noexcept { return free_[--free_count_]; }
     void Release(T* item) noexcept { free_[free_count_++] = item; }
-    std::unique_ptr<T[]> items_;
+    void Grow(int32_t capacity) noexcept {  // keeps the existing items in place.
+      if (capacity <= capacity_) {
+        return;
+      }
+      auto free = std::make_unique<T*[]>(capacity);
+      std::copy_n(free_.get(), free_count_, free.get());
+      T* items = items_.emplace_back(std::make_unique<T[]>(capacity - capacity_)).get();
+      for (int32_t i = 0; i < capacity - capacity_; ++i) {
+        free[free_count_++] = &items[i];
+      }
+      free_ = std::move(free);
+      capacity_ = capacity;
+    }
+    std::vector<std::unique_ptr<T[]>> items_;
     std::unique_ptr<T*[]> free_;
     int32_t free_count_ = 0;
+    int32_t capacity_ = 0;
   };
+  static void ProcessCallback(BarelyTaskEventType type, void* user_data) noexcept {
+    if (user_data != nullptr) {
+      (*static_cast<TaskCallback*>(user_data))(static_cast<TaskEventType>(type));
+    }
+  }
   static void ReleaseTaskCallback(Pool<CallbackNode>* task_callbacks,
                                   CallbackNode* task_callback) noexcept {
     if (task_callback->prev != nullptr) {
@@ -953,6 +1701,24 @@ class Performer {
   /// @return Identifier.
   [[nodiscard]] constexpr operator uint32_t() const noexcept { return performer_id_; }
 
+  /// Creates a new clip of notes to play on an instrument, which does not need task callbacks.
+  /// @param instrument Instrument.
+  /// @param notes Span of notes.
+  /// @param tasks Span of tasks with the same size as the notes.
+  void CreateClip(const Instrument& instrument, std::span<const Note> notes,
+                  std::span<Task> tasks) noexcept {
+    assert(notes.size() == tasks.size());
+    const auto task_ids = std::make_unique<uint32_t[]>(notes.size());
+    [[maybe_unused]] const int32_t task_count = BarelyPerformer_CreateClip(
+        engine_, performer_id_, instrument, reinterpret_cast<const BarelyNote*>(notes.data()),
+        static_cast<int32_t>(notes.size()), task_ids.get());
+    assert(task_count == static_cast<int32_t>(notes.size()));
+    for (size_t i = 0; i < notes.size(); ++i) {
+      tasks[i] = {task_callbacks_, first_task_callback_, AcquireTaskCallback(nullptr), engine_,
+                  task_ids[i]};
+    }
+  }
+
   /// Creates a new task.
   /// @param position Task position in beats.
   /// @param duration Task duration in beats.
@@ -961,26 +1727,34 @@ class Performer {
   /// @return Task.
   Task CreateTask(double position, double duration, int32_t priority,
                   TaskCallback callback) noexcept {
-    const uint32_t task_id = BarelyPerformer_CreateTask(engine_, performer_id_, position, duration,
-                                                        priority, nullptr, nullptr);
+    Task::CallbackNode* task_callback = AcquireTaskCallback(std::move(callback));
+    const uint32_t task_id =
+        BarelyPerformer_CreateTask(engine_, performer_id_, position, duration, priority,
+                                   &Task::ProcessCallback, &task_callback->callback);
     assert(task_id != 0);
-    Task::CallbackNode* task_callback = task_callbacks_->Acquire();
-    *task_callback = {.callback = std::move(callback)};
+    return {task_callbacks_, first_task_callback_, task_callback, engine_, task_id};
+  }
 
-    if (*first_task_callback_ != nullptr) {
-      (*first_task_callback_)->prev = task_callback;
-      task_callback->next = *first_task_callback_;
+  /// Creates new tasks in a batch, which is faster than creating them one by one.
+  /// @param task_descs Span of task descriptions, where the callbacks get moved into the tasks.
+  /// @param tasks Span of tasks with the same size as the task descriptions.
+  void CreateTasks(std::span<TaskDesc> task_descs, std::span<Task> tasks) noexcept {
+    assert(task_descs.size() == tasks.size());
+    const auto raw_task_descs = std::make_unique<BarelyTaskDesc[]>(task_descs.size());
+    for (size_t i = 0; i < task_descs.size(); ++i) {
+      Task::CallbackNode* task_callback = AcquireTaskCallback(std::move(task_descs[i].callback));
+      raw_task_descs[i] = {task_descs[i].position, task_descs[i].duration, task_descs[i].priority,
+                           &Task::ProcessCallback, &task_callback->callback};
+      tasks[i] = {task_callbacks_, first_task_callback_, task_callback, engine_, 0};
+    }
+    const auto task_ids = std::make_unique<uint32_t[]>(task_descs.size());
+    [[maybe_unused]] const int32_t task_count =
+        BarelyPerformer_CreateTasks(engine_, performer_id_, raw_task_descs.get(),
+                                    static_cast<int32_t>(task_descs.size()), task_ids.get());
+    assert(task_count == static_cast<int32_t>(task_descs.size()));
+    for (size_t i = 0; i < tasks.size(); ++i) {
+      tasks[i].task_id_ = task_ids[i];
     }
-    *first_task_callback_ = task_callback;
-    BarelyTask_SetCallback(
-        engine_, task_id,
-        [](BarelyTaskEventType type, void* user_data) noexcept {
-          if (user_data != nullptr) {
-            (*static_cast<TaskCallback*>(user_data))(static_cast<TaskEventType>(type));
-          }
-        },
-        &task_callback->callback);
-    return {task_callbacks_, first_task_callback_, task_callback, engine_, task_id};
   }
 
   /// Destroys the performer.
@@ -1045,6 +1819,16 @@ class Performer {
     first_task_callback_ = first_task_callbacks->Acquire();
     *first_task_callback_ = nullptr;
   }
+  Task::CallbackNode* AcquireTaskCallback(TaskCallback callback) noexcept {
+    Task::CallbackNode* task_callback = task_callbacks_->Acquire();
+    *task_callback = {.callback = std::move(callback)};
+    if (*first_task_callback_ != nullptr) {
+      (*first_task_callback_)->prev = task_callback;
+      task_callback->next = *first_task_callback_;
+    }
+    *first_task_callback_ = task_callback;
+    return task_callback;
+  }
   Task::Pool<Task::CallbackNode>* task_callbacks_ = nullptr;
   Task::Pool<Task::CallbackNode*>* first_task_callbacks_ = nullptr;
   Task::CallbackNode** first_task_callback_ = nullptr;
@@ -1065,6 +1849,7 @@ class Engine {
       : task_callbacks_(std::make_unique<Task::Pool<Task::CallbackNode>>(config.max_task_count)),
         first_task_callbacks_(
             std::make_unique<Task::Pool<Task::CallbackNode*>>(config.max_performer_count)),
+        sample_banks_(std::make_unique<SampleBank::StoragePtrs>()),
         allocation_(config.GetRequiredAllocationSize()) {
     engine_ =
         BarelyEngine_Create(&config, allocation_.data(), static_cast<int32_t>(allocation_.size()));
@@ -1082,7 +1867,9 @@ class Engine {
   Engine(Engine&& other) noexcept
       : task_callbacks_(std::exchange(other.task_callbacks_, {})),
         first_task_callbacks_(std::exchange(other.first_task_callbacks_, {})),
+        sample_banks_(std::exchange(other.sample_banks_, {})),
         allocation_(std::exchange(other.allocation_, {})),
+        pool_allocations_(std::exchange(other.pool_allocations_, {})),
         engine_(std::exchange(other.engine_, nullptr)) {}
 
   /// Assigns `Engine` via move.
@@ -1093,7 +1880,9 @@ class Engine {
       BarelyEngine_Destroy(engine_);
       task_callbacks_ = std::exchange(other.task_callbacks_, {});
       first_task_callbacks_ = std::exchange(other.first_task_callbacks_, {});
+      sample_banks_ = std::exchange(other.sample_banks_, {});
       allocation_ = std::exchange(other.allocation_, {});
+      pool_allocations_ = std::exchange(other.pool_allocations_, {});
       engine_ = std::exchange(other.engine_, nullptr);
     }
     return *this;
@@ -1107,7 +1896,7 @@ class Engine {
   /// Creates a new instrument.
   /// @return Instrument.
   Instrument CreateInstrument() noexcept {
-    return {engine_, BarelyEngine_CreateInstrument(engine_)};
+    return {sample_banks_.get(), engine_, BarelyEngine_CreateInstrument(engine_)};
   }
 
   /// Creates a new performer.
@@ -1137,6 +1926,35 @@ class Engine {
   /// @return Timestamp in seconds.
   [[nodiscard]] double GetTimestamp() const noexcept { return BarelyEngine_GetTimestamp(engine_); }
 
+  /// Returns the pool usage.
+  /// @return Engine usage.
+  [[nodiscard]] BarelyEngineUsage GetUsage() const noexcept {
+    BarelyEngineUsage usage = {};
+    [[maybe_unused]] const bool success = BarelyEngine_GetUsage(engine_, &usage);
+    assert(success);
+    return usage;
+  }
+
+  /// Grows the pools without losing the engine state, where the counts that do not exceed the
+  /// current ones are left as is.
+  /// @param max_slice_count Maximum number of active slices.
+  /// @param max_task_count Maximum number of tasks.
+  /// @param max_voice_count Maximum number of active voices.
+  /// @return True if successful, false otherwise.
+  bool GrowPools(int32_t max_slice_count, int32_t max_task_count,
+                 int32_t max_voice_count) noexcept {
+    const int32_t allocation_size = BarelyEngine_GetRequiredPoolAllocationSize(
+        engine_, max_slice_count, max_task_count, max_voice_count);
+    std::vector<std::byte> allocation(static_cast<size_t>(allocation_size));
+    if (!BarelyEngine_GrowPools(engine_, max_slice_count, max_task_count, max_voice_count,
+                                allocation.data(), allocation_size)) {
+      return false;
+    }
+    pool_allocations_.push_back(std::move(allocation));
+    task_callbacks_->Grow(max_task_count);
+    return true;
+  }
+
   /// Processes the next output samples at timestamp.
   /// @param output_samples Array of interleaved output samples.
   /// @param output_channel_count Number of output channels.
@@ -1148,6 +1966,26 @@ class Engine {
                          timestamp);
   }
 
+  /// Processes the next output samples at timestamp, and applies the events of the host at their
+  /// frames.
+  ///
+  /// This replaces the instrument and engine setters in plugin hosts, where the events skip the
+  /// command queue to be sample accurate. The events should be sorted by their frames, and the
+  /// events outside of the output frames are ignored.
+  /// @param output_samples Array of interleaved output samples.
+  /// @param output_channel_count Number of output channels.
+  /// @param output_frame_count Number of output frames.
+  /// @param timestamp Timestamp in seconds.
+  /// @param events Span of engine events.
+  void ProcessWithEvents(float* output_samples, int32_t output_channel_count,
+                         int32_t output_frame_count, double timestamp,
+                         std::span<const EngineEvent> events) noexcept {
+    BarelyEngine_ProcessWithEvents(engine_, output_samples, output_channel_count,
+                                   output_frame_count, timestamp,
+                                   reinterpret_cast<const BarelyEngineEvent*>(events.data()),
+                                   static_cast<int32_t>(events.size()));
+  }
+
   /// Resets the random number generator seed.
   void ResetSeed(int32_t seed) noexcept { BarelyEngine_ResetSeed(engine_, seed); }
 
@@ -1166,18 +2004,122 @@ class Engine {
   /// @param tempo Tempo in beats per minute.
   void SetTempo(double tempo) noexcept { BarelyEngine_SetTempo(engine_, tempo); }
 
+  /// Sets the tempo map.
+  ///
+  /// The tempo points override the constant tempo from the first point onwards, which advances the
+  /// performers across the tempo changes without any callbacks. Up to 64 points are supported, and
+  /// setting the tempo clears them.
+  /// @param points Span of tempo points.
+  void SetTempoMap(std::span<const TempoPoint> points) noexcept {
+    BarelyEngine_SetTempoMap(engine_, reinterpret_cast<const BarelyTempoPoint*>(points.data()),
+                             static_cast<int32_t>(points.size()));
+  }
+
   /// Updates the engine at timestamp.
   /// @param timestamp Timestamp in seconds.
   void Update(double timestamp) noexcept { BarelyEngine_Update(engine_, timestamp); }
 
+  /// Updates the engine until the end of the next output samples, and processes them at timestamp.
+  ///
+  /// This replaces the separate `Update` calls to advance the performers in the audio thread, which
+  /// plays the tasks that are due with sample accuracy and without any lookahead. In return, the
+  /// engine must only be accessed from the same thread, including the task callbacks.
+  /// @param output_samples Array of interleaved output samples.
+  /// @param output_channel_count Number of output channels.
+  /// @param output_frame_count Number of output frames.
+  /// @param timestamp Timestamp in seconds.
+  void UpdateAndProcess(float* output_samples, int32_t output_channel_count,
+                        int32_t output_frame_count, double timestamp) noexcept {
+    BarelyEngine_UpdateAndProcess(engine_, output_samples, output_channel_count,
+                                  output_frame_count, timestamp);
+  }
+
+  /// Updates the engine at timestamp, and returns the task events in a batch instead of processing
+  /// their callbacks.
+  ///
+  /// The update stops at the timestamp of the returned task events, and once the span is full.
+  /// Therefore, it must be called again with the same timestamp until it returns zero. If more task
+  /// events happen at once than the span fits, the callbacks of the remaining task events get
+  /// processed as usual, and the returned number exceeds the span size.
+  /// @param timestamp Timestamp in seconds.
+  /// @param task_events Span of task events.
+  /// @return Number of task events, where the ones up to the span size are returned in the span.
+  int32_t UpdateWithTaskEvents(double timestamp, std::span<BarelyTaskEvent> task_events) noexcept {
+    return BarelyEngine_UpdateWithTaskEvents(engine_, timestamp, task_events.data(),
+                                             static_cast<int32_t>(task_events.size()));
+  }
+
  private:
   // Heap allocated fixed size buffers below (for pointer stability on move).
   std::unique_ptr<Task::Pool<Task::CallbackNode>> task_callbacks_;
   std::unique_ptr<Task::Pool<Task::CallbackNode*>> first_task_callbacks_;
+  std::unique_ptr<SampleBank::StoragePtrs> sample_banks_;  // kept alive while referenced
   std::vector<std::byte> allocation_;
+  std::vector<std::vector<std::byte>> pool_allocations_;  // chained to grow the pools
   BarelyEngine* engine_ = nullptr;
 };
 
+/// Class that wraps an engine group, which processes engines in parallel on a shared pool of worker
+/// threads.
+class EngineGroup {
+ public:
+  /// Constructs a new `EngineGroup`.
+  /// @param worker_count Number of worker threads.
+  /// @param worker_cpus Optional span of cpu indices to pin each worker thread to (Linux only).
+  explicit EngineGroup(int32_t worker_count, std::span<const int32_t> worker_cpus = {}) noexcept
+      : allocation_(
+            static_cast<size_t>(BarelyEngineGroup_GetRequiredAllocationSize(worker_count))) {
+    assert(worker_cpus.empty() || worker_cpus.size() == static_cast<size_t>(worker_count));
+    engine_group_ = BarelyEngineGroup_Create(
+        worker_count, worker_cpus.empty() ? nullptr : worker_cpus.data(), allocation_.data(),
+        static_cast<int32_t>(allocation_.size()));
+    assert(engine_group_ != nullptr);
+  }
+
+  /// Destroys `EngineGroup`.
+  ~EngineGroup() noexcept { BarelyEngineGroup_Destroy(engine_group_); }
+
+  /// Non-copyable.
+  EngineGroup(const EngineGroup& other) noexcept = delete;
+  EngineGroup& operator=(const EngineGroup& other) noexcept = delete;
+
+  /// Constructs a new `EngineGroup` via move.
+  /// @param other Other engine group.
+  EngineGroup(EngineGroup&& other) noexcept
+      : allocation_(std::exchange(other.allocation_, {})),
+        engine_group_(std::exchange(other.engine_group_, nullptr)) {}
+
+  /// Assigns `EngineGroup` via move.
+  /// @param other Other engine group.
+  /// @return Engine group.
+  EngineGroup& operator=(EngineGroup&& other) noexcept {
+    if (this != &other) {
+      BarelyEngineGroup_Destroy(engine_group_);
+      allocation_ = std::exchange(other.allocation_, {});
+      engine_group_ = std::exchange(other.engine_group_, nullptr);
+    }
+    return *this;
+  }
+
+  /// Processes the next output samples of engines in parallel, and returns once all of them are
+  /// ready.
+  ///
+  /// An engine must not appear in more than one job, since the worker threads would process it
+  /// concurrently.
+  /// @param jobs Span of engine process jobs.
+  /// @param output_channel_count Number of output channels.
+  /// @param output_frame_count Number of output frames.
+  void Process(std::span<const EngineProcessJob> jobs, int32_t output_channel_count,
+               int32_t output_frame_count) noexcept {
+    BarelyEngineGroup_Process(engine_group_, jobs.data(), static_cast<int32_t>(jobs.size()),
+                              output_channel_count, output_frame_count);
+  }
+
+ private:
+  std::vector<std::byte> allocation_;
+  BarelyEngineGroup* engine_group_ = nullptr;
+};
+
 }  // namespace barely
 #endif  // __cplusplus
 
@@ -43,6 +43,9 @@ Engine g_engine{EngineConfig{{
     .max_frame_count = kFrameCount,
     .max_slice_count = 1,
     .max_voice_count = 32,
+    .max_delay_time = 0.0f,
+    .effect_flags = BarelyEngineEffectFlags_kNone,  // the delay and reverb are unused.
+    .seed = -1,
 }}};
 Instrument g_instrument = {};
 float g_osc_shape = 0.0f;
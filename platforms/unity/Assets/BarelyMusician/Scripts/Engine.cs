@@ -404,6 +404,8 @@ public enum InstrumentControlType {
         [InspectorName("Retrigger")] RETRIGGER,
         // Number of voices.
         [InspectorName("Voice Count")] VOICE_COUNT,
+        // Render cache.
+        [InspectorName("Render Cache")] RENDER_CACHE,
         // Number of instrument control types.
         COUNT,
       }
@@ -618,6 +620,20 @@ public struct BarelyEngineConfig {
         public Int32 maxFrameCount;
         public Int32 maxSliceCount;
         public Int32 maxVoiceCount;
+        public float maxDelayTime;
+        public Int32 effectFlags;
+        public Int32 memoryFlags;
+        public Int32 seed;
+        public Int32 renderCacheFrameCount;
+        public Int32 freezeFrameCount;
+      }
+
+      [StructLayout(LayoutKind.Sequential)]
+      private struct BarelyTaskEvent {
+        public UInt32 taskId;
+        public TaskEventType type;
+        public double position;
+        public double timestamp;
       }
 
       [StructLayout(LayoutKind.Sequential)]
@@ -669,6 +685,9 @@ private struct Slice {
       private static Dictionary<UInt32, Performer> _performers = null;
       private static Dictionary<UInt32, Task> _tasks = null;
 
+      // Task events that get processed in a batch per update.
+      private static BarelyTaskEvent[] _taskEvents = new BarelyTaskEvent[1024];
+
       private static Scale _scale = new Scale {
         pitches = null,
         pitchCount = 0,
@@ -749,7 +768,19 @@ private class State : MonoBehaviour {
         }
 
         private void LateUpdate() {
-          BarelyEngine_Update(_handle, GetNextTimestamp());
+          // The update stops at the timestamp of each batch, so that the notes set by the task
+          // events get scheduled at their exact timestamps.
+          double timestamp = GetNextTimestamp();
+          int taskEventCount = 0;
+          do {
+            taskEventCount = BarelyEngine_UpdateWithTaskEvents(_handle, timestamp, _taskEvents,
+                                                               _taskEvents.Length);
+            for (int i = 0; i < Math.Min(taskEventCount, _taskEvents.Length); ++i) {
+              if (_tasks.TryGetValue(_taskEvents[i].taskId, out var task)) {
+                Task.Internal.OnProcess(task, _taskEvents[i].type);
+              }
+            }
+          } while (taskEventCount > 0);
         }
 
         private void Initialize() {
@@ -760,6 +791,8 @@ private class State : MonoBehaviour {
             maxPerformerCount = 100,        maxTaskCount = 5000,
             maxCommandCount = 8192,         maxFrameCount = config.dspBufferSize,
             maxSliceCount = 1000,           maxVoiceCount = 200,
+            maxDelayTime = 8.0f,            effectFlags = 3,  // delay and reverb
+            seed = -1,
           };
           Int32 allocationSize = BarelyEngineConfig_GetRequiredAllocationSize(ref engineConfig);
           _allocation = Marshal.AllocHGlobal(allocationSize);
@@ -867,6 +900,11 @@ private class State : MonoBehaviour {
       [DllImport(_pluginName, EntryPoint = "BarelyEngine_Update")]
       private static extern void BarelyEngine_Update(IntPtr engine, double timestamp);
 
+      [DllImport(_pluginName, EntryPoint = "BarelyEngine_UpdateWithTaskEvents")]
+      private static extern Int32 BarelyEngine_UpdateWithTaskEvents(
+          IntPtr engine, double timestamp, [In, Out] BarelyTaskEvent[] outTaskEvents,
+          Int32 maxTaskEventCount);
+
       [DllImport(_pluginName, EntryPoint = "BarelyInstrument_Destroy")]
       private static extern void BarelyInstrument_Destroy(IntPtr engine, UInt32 instrumentId);
 
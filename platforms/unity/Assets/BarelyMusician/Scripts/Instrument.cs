@@ -205,6 +205,9 @@ public class Slice {
     [Range(1, 16)]
     public int VoiceCount = 8;
 
+    /// Denotes whether the repeated one-shot slice notes are played back from the render cache.
+    public bool RenderCache = false;
+
     /// Note off callback.
     /// @param pitch Note pitch.
     public delegate void NoteOffCallback(float pitch);
@@ -327,6 +330,7 @@ public class NoteOnEvent : UnityEngine.Events.UnityEvent<float> {}
       SetControl(Engine.Internal.InstrumentControlType.SIDECHAIN_SEND, SidechainSend);
       SetControl(Engine.Internal.InstrumentControlType.RETRIGGER, Retrigger ? 1.0f : 0.0f);
       SetControl(Engine.Internal.InstrumentControlType.VOICE_COUNT, (float)VoiceCount);
+      SetControl(Engine.Internal.InstrumentControlType.RENDER_CACHE, RenderCache ? 1.0f : 0.0f);
     }
 
     private void SetControl(Engine.Internal.InstrumentControlType type, float value) {
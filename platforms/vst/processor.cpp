@@ -16,6 +16,9 @@ namespace {
 
 constexpr int kStereoChannelCount = 2;
 
+// Number of events to reserve for each block.
+constexpr int kMaxEventCount = 1024;
+
 float MidiNoteToPitch(Steinberg::int16 midi_note) noexcept {
   return (static_cast<float>(midi_note) - 60.0f) / 12.0f;
 }
@@ -57,7 +60,7 @@ Steinberg::tresult PLUGIN_API Processor::process(Steinberg::Vst::ProcessData& da
     return Steinberg::kResultTrue;
   }
 
-  // TODO(#162): The parameter changes and the MIDI events below can be made sample accurate.
+  events_.clear();
 
   // Process parameter changes.
   if (data.inputParameterChanges) {
@@ -73,7 +76,8 @@ Steinberg::tresult PLUGIN_API Processor::process(Steinberg::Vst::ProcessData& da
         double value = 0.0;
         if (param_queue->getPoint(queue_index, sample_offset, value) == Steinberg::kResultTrue) {
           const float plainValue = Controller::ToPlainControlValue(type, value);
-          instrument_.SetControl(type, plainValue);
+          events_.push_back(EngineEvent::InstrumentControl(sample_offset, instrument_, type,
+                                                           plainValue));
           controls_[param_queue->getParameterId()] = plainValue;
         }
       }
@@ -88,16 +92,28 @@ Steinberg::tresult PLUGIN_API Processor::process(Steinberg::Vst::ProcessData& da
         continue;
       }
       if (event.type == Steinberg::Vst::Event::kNoteOnEvent) {
-        instrument_.SetNoteOn(MidiNoteToPitch(event.noteOn.pitch), event.noteOn.velocity);
+        const float pitch = MidiNoteToPitch(event.noteOn.pitch);
+        events_.push_back(EngineEvent::NoteOn(event.sampleOffset, instrument_, pitch));
+        if (event.noteOn.velocity != 1.0f) {
+          events_.push_back(EngineEvent::NoteControl(event.sampleOffset, instrument_, pitch,
+                                                     NoteControlType::kGain,
+                                                     event.noteOn.velocity));
+        }
       } else if (event.type == Steinberg::Vst::Event::kNoteOffEvent) {
-        instrument_.SetNoteOff(MidiNoteToPitch(event.noteOff.pitch));
+        events_.push_back(EngineEvent::NoteOff(event.sampleOffset, instrument_,
+                                               MidiNoteToPitch(event.noteOff.pitch)));
       }
     }
   }
 
-  // Process instrument.
+  // Process instrument with the events at their sample offsets.
+  std::stable_sort(events_.begin(), events_.end(),
+                   [](const EngineEvent& lhs, const EngineEvent& rhs) noexcept {
+                     return lhs.frame < rhs.frame;
+                   });
   const int frame_count = static_cast<int>(data.numSamples);
-  engine_->Process(output_samples_.data(), kStereoChannelCount, frame_count, /*timestamp=*/0.0);
+  engine_->ProcessWithEvents(output_samples_.data(), kStereoChannelCount, frame_count,
+                             /*timestamp=*/0.0, events_);
   for (int frame = 0; frame < frame_count; ++frame) {
     data.outputs[0].channelBuffers32[0][frame] = output_samples_[frame * kStereoChannelCount];
     data.outputs[0].channelBuffers32[1][frame] = output_samples_[frame * kStereoChannelCount + 1];
@@ -131,6 +147,7 @@ Steinberg::tresult PLUGIN_API Processor::setupProcessing(Steinberg::Vst::Process
 #undef BARELY_FETCH_DEFAULT
   };
   output_samples_.resize(kStereoChannelCount * setup.maxSamplesPerBlock);
+  events_.reserve(kMaxEventCount);
   return Steinberg::kResultTrue;
 }
 
@@ -36,6 +36,7 @@ class Processor : public Steinberg::Vst::AudioEffect {
   std::optional<Engine> engine_;
   Instrument instrument_;
   std::array<float, BarelyInstrumentControlType_kCount> controls_;
+  std::vector<EngineEvent> events_;
   std::vector<float> output_samples_;
 };
 
@@ -52,7 +52,8 @@ export const InstrumentControlType = Object.freeze({
   SIDECHAIN_SEND: 23,
   RETRIGGER: 24,
   VOICE_COUNT: 25,
-  COUNT: 26,
+  RENDER_CACHE: 26,
+  COUNT: 27,
 });
 
 export const NoteControlType = Object.freeze({
@@ -425,6 +426,13 @@ export const INSTRUMENT_CONTROLS = Object.freeze({
     minValue: 1,
     maxValue: 20,
   },
+  [InstrumentControlType.RENDER_CACHE]: {
+    name: 'Render Cache',
+    valueType: 'bool',
+    defaultValue: false,
+    minValue: 0,
+    maxValue: 1,
+  },
 });
 
 export const NOTE_CONTROLS = Object.freeze({
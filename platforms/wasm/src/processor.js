@@ -5,7 +5,7 @@ import {INSTRUMENT_CONTROLS, NoteControlType} from './control.js';
 const RENDER_QUANTUM_SIZE = 128;
 const STEREO_CHANNEL_COUNT = 2;
 
-const ENGINE_CONFIG_SIZE = 32;  // sizeof(BarelyEngineConfig)
+const ENGINE_CONFIG_SIZE = 56;  // sizeof(BarelyEngineConfig)
 const SLICE_SIZE = 24;          // sizeof(BarelySlice)
 
 class Processor extends AudioWorkletProcessor {
@@ -33,7 +33,7 @@ class Processor extends AudioWorkletProcessor {
           STEREO_CHANNEL_COUNT * RENDER_QUANTUM_SIZE * Float32Array.BYTES_PER_ELEMENT);
 
       const configPtr = this._module._malloc(ENGINE_CONFIG_SIZE);
-      const configView = new Int32Array(this._module.HEAP32.buffer, configPtr, 8);
+      const configView = new Int32Array(this._module.HEAP32.buffer, configPtr, 14);
       configView[0] = sampleRate;           // sample_rate
       configView[1] = 32;                   // max_instrument_count
       configView[2] = 32;                   // max_performer_count
@@ -42,6 +42,12 @@ class Processor extends AudioWorkletProcessor {
       configView[5] = RENDER_QUANTUM_SIZE;  // max_frame_count
       configView[6] = 128;                  // max_slice_count
       configView[7] = 128;                  // max_voice_count
+      new Float32Array(this._module.HEAPF32.buffer, configPtr, 14)[8] = 8.0;  // max_delay_time
+      configView[9] = 3;                    // effect_flags
+      configView[10] = 0;                   // memory_flags
+      configView[11] = -1;                  // seed
+      configView[12] = 0;                   // render_cache_frame_count
+      configView[13] = 0;                   // freeze_frame_count
 
       const allocationSize = this._module._BarelyEngineConfig_GetRequiredAllocationSize(configPtr);
       this._allocationPtr = this._module._malloc(allocationSize * Uint8Array.BYTES_PER_ELEMENT);
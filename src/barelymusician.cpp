@@ -9,25 +9,42 @@
 
 #include "core/arena.h"
 #include "core/constants.h"
+#include "core/memory.h"
 #include "core/scale.h"
 #include "core/time.h"
+#include "core/worker_pool.h"
 #include "engine/cmd.h"
 #include "engine/engine_controller.h"
 #include "engine/engine_processor.h"
 #include "engine/engine_state.h"
+#include "engine/sample_bank_state.h"
 
 struct BarelyEngine {
   barely::EngineState state;
   barely::EngineController controller;
   barely::EngineProcessor processor;
 
+  // Allocation range that is locked in physical memory.
+  void* locked_allocation = nullptr;
+  size_t locked_allocation_size = 0;
+
   BarelyEngine(barely::Arena& arena, const BarelyEngineConfig& config) noexcept
       : state(arena, config), controller(state), processor(state) {}
 
+  ~BarelyEngine() noexcept {
+    // Release the sample banks that are still referenced by the remaining instruments.
+    for (uint32_t i = 0; i < state.instrument_pool.Count(); ++i) {
+      if (state.instrument_pool.IsActive(i) && state.GetInstrument(i).sample_bank != nullptr) {
+        state.GetInstrument(i).sample_bank->RemoveReference();
+      }
+    }
+    if (locked_allocation != nullptr) {
+      barely::UnlockMemory(locked_allocation, locked_allocation_size);
+    }
+  }
+
   [[nodiscard]] bool IsValidInstrument(uint32_t instrument_id) const noexcept {
-    const uint32_t instrument_index = state.GetIdIndex(instrument_id);
-    return state.instrument_pool.IsActive(instrument_index) &&
-           state.GetIdGeneration(instrument_id) == state.instrument_generations[instrument_index];
+    return state.IsValidInstrument(instrument_id);
   }
 
   [[nodiscard]] bool IsValidPerformer(uint32_t performer_id) const noexcept {
@@ -43,11 +60,35 @@ struct BarelyEngine {
   }
 };
 
+struct BarelyEngineGroup {
+  barely::WorkerPool worker_pool;
+
+  BarelyEngineGroup(barely::Arena& arena, uint32_t worker_count,
+                    const int32_t* worker_cpus) noexcept
+      : worker_pool(arena, worker_count, worker_cpus) {}
+};
+
+struct BarelySampleBank {
+  barely::SampleBankState sample_bank;
+
+  BarelySampleBank(barely::Arena& arena, const BarelySlice* slices, uint32_t slice_count) noexcept
+      : sample_bank(arena, slices, slice_count) {}
+};
+
 int32_t BarelyEngineConfig_GetRequiredAllocationSize(const BarelyEngineConfig* config) {
   return (config != nullptr) ? static_cast<int32_t>(barely::GetAllocSize<BarelyEngine>(*config))
                              : 0;
 }
 
+bool BarelyEngineConfig_GetMemoryBreakdown(const BarelyEngineConfig* config,
+                                           BarelyEngineMemoryBreakdown* out_memory_breakdown) {
+  if (config == nullptr || out_memory_breakdown == nullptr) return false;
+
+  *out_memory_breakdown = barely::GetMemoryBreakdown(*config);
+  out_memory_breakdown->total_size = BarelyEngineConfig_GetRequiredAllocationSize(config);
+  return true;
+}
+
 double BarelyQuantization_GetPosition(const BarelyQuantization* quantization, double position) {
   return (quantization != nullptr)
              ? barely::Quantize(position, std::max(quantization->subdivision, 1),
@@ -71,8 +112,22 @@ BarelyEngine* BarelyEngine_Create(const BarelyEngineConfig* config, void* alloca
   const size_t size = barely::GetAllocSize<BarelyEngine>(*config);
   if (allocation == nullptr || static_cast<size_t>(allocation_size) < size) return nullptr;
 
+  // Huge pages need to be advised before the pages are touched for the first time.
+  if ((config->memory_flags & BarelyEngineMemoryFlags_kHugePages) != 0) {
+    barely::AdviseHugePages(allocation, size);
+  }
+  if ((config->memory_flags & BarelyEngineMemoryFlags_kPrefault) != 0) {
+    barely::PrefaultMemory(allocation, size);
+  }
+
   barely::Arena arena(allocation, size);
-  return ::new (arena.Alloc<BarelyEngine>()) BarelyEngine(arena, *config);
+  BarelyEngine* engine = ::new (arena.Alloc<BarelyEngine>()) BarelyEngine(arena, *config);
+  if ((config->memory_flags & BarelyEngineMemoryFlags_kLock) != 0 &&
+      barely::LockMemory(allocation, size)) {
+    engine->locked_allocation = allocation;
+    engine->locked_allocation_size = size;
+  }
+  return engine;
 }
 
 uint32_t BarelyEngine_CreateInstrument(BarelyEngine* engine) {
@@ -107,15 +162,82 @@ double BarelyEngine_GenerateRandomNumber(BarelyEngine* engine) {
   return (engine != nullptr) ? engine->state.main_rng.Generate() : 0.0;
 }
 
+int32_t BarelyEngine_GetRequiredPoolAllocationSize(const BarelyEngine* engine,
+                                                   int32_t max_slice_count, int32_t max_task_count,
+                                                   int32_t max_voice_count) {
+  if (engine == nullptr || max_slice_count < 0 || max_task_count < 0 || max_voice_count < 0) {
+    return 0;
+  }
+  return static_cast<int32_t>(barely::GetAllocSize<barely::EnginePoolStorage>(
+      engine->state, static_cast<uint32_t>(max_slice_count),
+      static_cast<uint32_t>(max_task_count), static_cast<uint32_t>(max_voice_count)));
+}
+
 double BarelyEngine_GetTimestamp(const BarelyEngine* engine) {
   return (engine != nullptr) ? engine->state.timestamp : 0.0;
 }
 
+bool BarelyEngine_GrowPools(BarelyEngine* engine, int32_t max_slice_count, int32_t max_task_count,
+                            int32_t max_voice_count, void* allocation, int32_t allocation_size) {
+  if (engine == nullptr || max_slice_count < 0 || max_task_count < 0 || max_voice_count < 0 ||
+      static_cast<uint32_t>(max_task_count) > engine->state.id_index_mask) {
+    return false;
+  }
+  const size_t size = static_cast<size_t>(BarelyEngine_GetRequiredPoolAllocationSize(
+      engine, max_slice_count, max_task_count, max_voice_count));
+  if (allocation == nullptr || static_cast<size_t>(allocation_size) < size) return false;
+
+  barely::Arena arena(allocation, size);
+  barely::EnginePoolStorage* storage = ::new (arena.Alloc<barely::EnginePoolStorage>())
+      barely::EnginePoolStorage(arena, engine->state, static_cast<uint32_t>(max_slice_count),
+                                static_cast<uint32_t>(max_task_count),
+                                static_cast<uint32_t>(max_voice_count));
+  engine->controller.GrowPools(*storage);
+  return true;
+}
+
+bool BarelyEngine_GetUsage(const BarelyEngine* engine, BarelyEngineUsage* out_usage) {
+  if (engine == nullptr || out_usage == nullptr) return false;
+
+  const auto get_usage = [](uint32_t active_count, uint32_t max_active_count,
+                            uint32_t capacity) noexcept {
+    return BarelyPoolUsage{static_cast<int32_t>(active_count),
+                           static_cast<int32_t>(max_active_count), static_cast<int32_t>(capacity)};
+  };
+  const barely::EngineState& state = engine->state;
+  out_usage->instruments =
+      get_usage(state.instrument_pool.ActiveCount(), state.instrument_pool.MaxActiveCount(),
+                state.instrument_pool.Count());
+  out_usage->performers =
+      get_usage(state.performer_pool.ActiveCount(), state.performer_pool.MaxActiveCount(),
+                state.performer_pool.Count());
+  out_usage->tasks = get_usage(state.task_pool.ActiveCount(), state.task_pool.MaxActiveCount(),
+                               state.task_pool.Count());
+  out_usage->voices = get_usage(state.active_voice_count.load(std::memory_order_relaxed),
+                                state.max_active_voice_count.load(std::memory_order_relaxed),
+                                state.voice_capacity.load(std::memory_order_relaxed));
+  out_usage->slices = get_usage(state.slice_pool.ActiveCount(), state.slice_pool.MaxActiveCount(),
+                                state.slice_pool.Count());
+  out_usage->commands = get_usage(state.cmd_queue.ActiveCount(), state.cmd_queue.MaxActiveCount(),
+                                  state.cmd_queue.Count());
+  return true;
+}
+
 void BarelyEngine_Process(BarelyEngine* engine, float* output_samples, int32_t output_channel_count,
                           int32_t output_frame_count, double timestamp) {
+  BarelyEngine_ProcessWithEvents(engine, output_samples, output_channel_count, output_frame_count,
+                                 timestamp, nullptr, 0);
+}
+
+void BarelyEngine_ProcessWithEvents(BarelyEngine* engine, float* output_samples,
+                                    int32_t output_channel_count, int32_t output_frame_count,
+                                    double timestamp, const BarelyEngineEvent* events,
+                                    int32_t event_count) {
   if (!engine || !output_samples || output_channel_count <= 0 || output_frame_count <= 0) return;
+  if ((events == nullptr && event_count != 0) || event_count < 0) return;
 
-  engine->processor.Process(output_samples, output_channel_count, output_frame_count, timestamp);
+  engine->processor.Process(output_samples, output_channel_count, output_frame_count, timestamp,
+                            {events, static_cast<size_t>(event_count)});
   for (int32_t i = 0; i < output_channel_count * output_frame_count; ++i) {
     output_samples[i] = std::tanh(output_samples[i] * 0.5f);  // soft-clip with -6dB headroom
   }
@@ -136,7 +258,18 @@ void BarelyEngine_ResetSeed(BarelyEngine* engine, int32_t seed) {
 
 void BarelyEngine_SetTempo(BarelyEngine* engine, double tempo) {
   if (engine != nullptr) {
-    engine->state.tempo = std::max(tempo, 0.0);
+    if (engine->state.tempo_map.GetTempo(engine->state.timestamp) != tempo) {
+      engine->state.ThawInstruments();
+    }
+    engine->state.tempo_map.SetTempo(tempo);
+  }
+}
+
+void BarelyEngine_SetTempoMap(BarelyEngine* engine, const BarelyTempoPoint* points,
+                              int32_t point_count) {
+  if (engine != nullptr && (points != nullptr || point_count == 0) && point_count >= 0) {
+    engine->state.ThawInstruments();
+    engine->state.tempo_map.SetPoints({points, static_cast<size_t>(point_count)});
   }
 }
 
@@ -146,6 +279,78 @@ void BarelyEngine_Update(BarelyEngine* engine, double timestamp) {
   }
 }
 
+void BarelyEngine_UpdateAndProcess(BarelyEngine* engine, float* output_samples,
+                                   int32_t output_channel_count, int32_t output_frame_count,
+                                   double timestamp) {
+  if (!engine || !output_samples || output_channel_count <= 0 || output_frame_count <= 0) return;
+
+  // Schedule the due tasks ahead of processing, which get applied at their exact frames.
+  engine->controller.Update(timestamp + barely::FramesToSeconds(engine->state.sample_rate,
+                                                                output_frame_count));
+  BarelyEngine_Process(engine, output_samples, output_channel_count, output_frame_count,
+                       timestamp);
+}
+
+int32_t BarelyEngine_UpdateWithTaskEvents(BarelyEngine* engine, double timestamp,
+                                          BarelyTaskEvent* out_task_events,
+                                          int32_t max_task_event_count) {
+  if (!engine || !out_task_events || max_task_event_count <= 0) return 0;
+
+  auto& performer_controller = engine->controller.performer_controller();
+  performer_controller.BeginTaskEvents(
+      {out_task_events, static_cast<size_t>(max_task_event_count)});
+  engine->controller.Update(timestamp);
+  return static_cast<int32_t>(performer_controller.EndTaskEvents());
+}
+
+BarelyEngineGroup* BarelyEngineGroup_Create(int32_t worker_count, const int32_t* worker_cpus,
+                                             void* allocation, int32_t allocation_size) {
+  if (worker_count < 0) return nullptr;
+
+  const size_t size = barely::GetAllocSize<BarelyEngineGroup>(
+      static_cast<uint32_t>(worker_count), static_cast<const int32_t*>(nullptr));
+  if (allocation == nullptr || static_cast<size_t>(allocation_size) < size) return nullptr;
+
+  barely::Arena arena(allocation, size);
+  return ::new (arena.Alloc<BarelyEngineGroup>())
+      BarelyEngineGroup(arena, static_cast<uint32_t>(worker_count), worker_cpus);
+}
+
+void BarelyEngineGroup_Destroy(BarelyEngineGroup* engine_group) {
+  if (engine_group != nullptr) {
+    std::destroy_at(engine_group);
+  }
+}
+
+int32_t BarelyEngineGroup_GetRequiredAllocationSize(int32_t worker_count) {
+  return (worker_count >= 0)
+             ? static_cast<int32_t>(barely::GetAllocSize<BarelyEngineGroup>(
+                   static_cast<uint32_t>(worker_count), static_cast<const int32_t*>(nullptr)))
+             : 0;
+}
+
+void BarelyEngineGroup_Process(BarelyEngineGroup* engine_group, const BarelyEngineProcessJob* jobs,
+                               int32_t job_count, int32_t output_channel_count,
+                               int32_t output_frame_count) {
+  if (engine_group == nullptr || jobs == nullptr || job_count <= 0) return;
+  if (output_channel_count <= 0 || output_frame_count <= 0) return;
+
+  struct ProcessBatch {
+    const BarelyEngineProcessJob* jobs;
+    int32_t output_channel_count;
+    int32_t output_frame_count;
+  } batch = {jobs, output_channel_count, output_frame_count};
+  engine_group->worker_pool.Run(
+      static_cast<uint32_t>(job_count),
+      {[](uint32_t job_index, void* user_data) noexcept {
+         const auto& batch = *static_cast<const ProcessBatch*>(user_data);
+         const BarelyEngineProcessJob& job = batch.jobs[job_index];
+         BarelyEngine_Process(job.engine, job.output_samples, batch.output_channel_count,
+                              batch.output_frame_count, job.timestamp);
+       },
+       &batch});
+}
+
 void BarelyInstrument_Destroy(BarelyEngine* engine, uint32_t instrument_id) {
   if (engine != nullptr && engine->IsValidInstrument(instrument_id)) {
     const uint32_t instrument_index = engine->state.GetIdIndex(instrument_id);
@@ -155,6 +360,19 @@ void BarelyInstrument_Destroy(BarelyEngine* engine, uint32_t instrument_id) {
   }
 }
 
+bool BarelyInstrument_Freeze(BarelyEngine* engine, uint32_t instrument_id,
+                             uint32_t performer_id) {
+  return engine != nullptr && engine->IsValidInstrument(instrument_id) &&
+         engine->IsValidPerformer(performer_id) &&
+         engine->controller.instrument_controller().Freeze(engine->state.GetIdIndex(instrument_id),
+                                                           engine->state.GetIdIndex(performer_id));
+}
+
+bool BarelyInstrument_IsFrozen(const BarelyEngine* engine, uint32_t instrument_id) {
+  return engine != nullptr && engine->IsValidInstrument(instrument_id) &&
+         engine->state.IsFrozenInstrument(engine->state.GetIdIndex(instrument_id));
+}
+
 void BarelyInstrument_SetControl(BarelyEngine* engine, uint32_t instrument_id,
                                  BarelyInstrumentControlType type, float value) {
   if (engine != nullptr && engine->IsValidInstrument(instrument_id) &&
@@ -196,6 +414,39 @@ void BarelyInstrument_SetSampleData(BarelyEngine* engine, uint32_t instrument_id
   }
 }
 
+void BarelyInstrument_SetSampleBank(BarelyEngine* engine, uint32_t instrument_id,
+                                    BarelySampleBank* sample_bank) {
+  if (engine != nullptr && engine->IsValidInstrument(instrument_id)) {
+    engine->controller.instrument_controller().SetSampleBank(
+        engine->state.GetIdIndex(instrument_id),
+        (sample_bank != nullptr) ? &sample_bank->sample_bank : nullptr);
+  }
+}
+
+void BarelyInstrument_Thaw(BarelyEngine* engine, uint32_t instrument_id) {
+  if (engine != nullptr && engine->IsValidInstrument(instrument_id)) {
+    engine->state.ThawInstrument(engine->state.GetIdIndex(instrument_id));
+  }
+}
+
+int32_t BarelyPerformer_CreateClip(BarelyEngine* engine, uint32_t performer_id,
+                                   uint32_t instrument_id, const BarelyNote* notes,
+                                   int32_t note_count, uint32_t* out_task_ids) {
+  if (engine != nullptr && engine->IsValidPerformer(performer_id) &&
+      engine->IsValidInstrument(instrument_id) && notes != nullptr && note_count > 0 &&
+      out_task_ids != nullptr) {
+    const uint32_t task_count = engine->controller.performer_controller().AcquireClipTasks(
+        engine->state.GetIdIndex(performer_id), instrument_id,
+        {notes, static_cast<size_t>(note_count)}, out_task_ids);
+    for (uint32_t i = 0; i < task_count; ++i) {
+      out_task_ids[i] =
+          engine->state.BuildId(out_task_ids[i], engine->state.task_generations[out_task_ids[i]]);
+    }
+    return static_cast<int32_t>(task_count);
+  }
+  return 0;
+}
+
 uint32_t BarelyPerformer_CreateTask(BarelyEngine* engine, uint32_t performer_id, double position,
                                     double duration, int32_t priority, BarelyTaskCallback callback,
                                     void* user_data) {
@@ -210,6 +461,23 @@ uint32_t BarelyPerformer_CreateTask(BarelyEngine* engine, uint32_t performer_id,
   return 0;
 }
 
+int32_t BarelyPerformer_CreateTasks(BarelyEngine* engine, uint32_t performer_id,
+                                    const BarelyTaskDesc* task_descs, int32_t task_count,
+                                    uint32_t* out_task_ids) {
+  if (engine != nullptr && engine->IsValidPerformer(performer_id) && task_descs != nullptr &&
+      task_count > 0 && out_task_ids != nullptr) {
+    const uint32_t created_task_count = engine->controller.performer_controller().AcquireTasks(
+        engine->state.GetIdIndex(performer_id),
+        {task_descs, static_cast<size_t>(task_count)}, out_task_ids);
+    for (uint32_t i = 0; i < created_task_count; ++i) {
+      out_task_ids[i] =
+          engine->state.BuildId(out_task_ids[i], engine->state.task_generations[out_task_ids[i]]);
+    }
+    return static_cast<int32_t>(created_task_count);
+  }
+  return 0;
+}
+
 void BarelyPerformer_Destroy(BarelyEngine* engine, uint32_t performer_id) {
   if (engine != nullptr && engine->IsValidPerformer(performer_id)) {
     const uint32_t performer_index = engine->state.GetIdIndex(performer_id);
@@ -221,7 +489,8 @@ void BarelyPerformer_Destroy(BarelyEngine* engine, uint32_t performer_id) {
 
 double BarelyPerformer_GetPosition(const BarelyEngine* engine, uint32_t performer_id) {
   return (engine != nullptr && engine->IsValidPerformer(performer_id))
-             ? engine->state.GetPerformer(engine->state.GetIdIndex(performer_id)).position
+             ? engine->controller.performer_controller().GetPosition(
+                   engine->state.GetIdIndex(performer_id))
              : 0.0;
 }
 
@@ -267,6 +536,39 @@ void BarelyPerformer_Stop(BarelyEngine* engine, uint32_t performer_id) {
   }
 }
 
+BarelySampleBank* BarelySampleBank_Create(const BarelySlice* slices, int32_t slice_count,
+                                          void* allocation, int32_t allocation_size) {
+  if (slices == nullptr || slice_count <= 0) return nullptr;
+
+  const size_t size =
+      barely::GetAllocSize<BarelySampleBank>(slices, static_cast<uint32_t>(slice_count));
+  if (allocation == nullptr || static_cast<size_t>(allocation_size) < size) return nullptr;
+
+  barely::Arena arena(allocation, size);
+  return ::new (arena.Alloc<BarelySampleBank>())
+      BarelySampleBank(arena, slices, static_cast<uint32_t>(slice_count));
+}
+
+bool BarelySampleBank_Destroy(BarelySampleBank* sample_bank) {
+  if (sample_bank == nullptr || sample_bank->sample_bank.GetReferenceCount() > 0) return false;
+
+  std::destroy_at(sample_bank);
+  return true;
+}
+
+int32_t BarelySampleBank_GetReferenceCount(const BarelySampleBank* sample_bank) {
+  return (sample_bank != nullptr)
+             ? static_cast<int32_t>(sample_bank->sample_bank.GetReferenceCount())
+             : 0;
+}
+
+int32_t BarelySampleBank_GetRequiredAllocationSize(int32_t slice_count) {
+  return (slice_count > 0)
+             ? static_cast<int32_t>(barely::GetAllocSize<BarelySampleBank>(
+                   static_cast<const BarelySlice*>(nullptr), static_cast<uint32_t>(slice_count)))
+             : 0;
+}
+
 void BarelyTask_Destroy(BarelyEngine* engine, uint32_t task_id) {
   if (engine != nullptr && engine->IsValidTask(task_id)) {
     const uint32_t task_index = engine->state.GetIdIndex(task_id);
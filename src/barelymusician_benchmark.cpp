@@ -1,12 +1,17 @@
 #include <barelymusician.h>
 
 #include <array>
+#include <cmath>
+#include <numbers>
+#include <utility>
+#include <vector>
 
 #include "benchmark/benchmark.h"
 
 namespace barely {
 namespace {
 
+using ::benchmark::Counter;
 using ::benchmark::State;
 
 constexpr int kSampleRate = 48000;
@@ -176,6 +181,284 @@ void BM_BarelyInstrument_PlayMultipleNotesWithOsc(State& state) {
 BENCHMARK(BM_BarelyInstrument_PlayMultipleNotesWithOsc<0.0f>);
 BENCHMARK(BM_BarelyInstrument_PlayMultipleNotesWithOsc<1.0f>);
 
+// Full scene with all effects active, the sidechain in use and multisampled instruments.
+constexpr int kSceneInstrumentCount = 50;
+constexpr int kSceneNoteCount = 4;  // per instrument, 200 voices in total.
+constexpr int kSceneRootPitchCount = 4;
+constexpr int kSceneRoundRobinCount = 2;
+constexpr int kSceneSampleCount = kSampleRate;
+constexpr int kSceneRetriggerFrameCount = kSampleRate / 2;
+
+template <SliceMode kSliceMode, OscMode kOscMode>
+void BM_BarelyEngine_ProcessScene(State& state) {
+  Engine engine(kSampleRate);
+
+  engine.SetControl(EngineControlType::kCompThreshold, 0.5f);
+  engine.SetControl(EngineControlType::kCompRatio, 0.25f);
+  engine.SetControl(EngineControlType::kCompAttack, 0.01f);
+  engine.SetControl(EngineControlType::kCompRelease, 0.1f);
+  engine.SetControl(EngineControlType::kDelayTime, 0.375f);
+  engine.SetControl(EngineControlType::kDelayFeedback, 0.5f);
+  engine.SetControl(EngineControlType::kDelayLpfCutoff, 0.75f);
+  engine.SetControl(EngineControlType::kDelayHpfCutoff, 0.1f);
+  engine.SetControl(EngineControlType::kDelayPingPong, 0.5f);
+  engine.SetControl(EngineControlType::kDelayReverbSend, 0.5f);
+  engine.SetControl(EngineControlType::kReverbDamping, 0.5f);
+  engine.SetControl(EngineControlType::kReverbRoomSize, 0.75f);
+  engine.SetControl(EngineControlType::kReverbStereoWidth, 0.8f);
+  engine.SetControl(EngineControlType::kSidechainThreshold, 0.25f);
+  engine.SetControl(EngineControlType::kSidechainRatio, 0.5f);
+  engine.SetControl(EngineControlType::kSidechainAttack, 0.005f);
+  engine.SetControl(EngineControlType::kSidechainRelease, 0.2f);
+
+  std::vector<float> samples(kSceneSampleCount);
+  for (int i = 0; i < kSceneSampleCount; ++i) {
+    samples[i] = std::sin(2.0f * std::numbers::pi_v<float> * 220.0f * static_cast<float>(i) /
+                          static_cast<float>(kSampleRate));
+  }
+  std::vector<Slice> slices;
+  for (int i = 0; i < kSceneRootPitchCount; ++i) {
+    for (int j = 0; j < kSceneRoundRobinCount; ++j) {
+      slices.emplace_back(samples, kSampleRate, static_cast<float>(i - 1));
+    }
+  }
+
+  std::vector<Instrument> instruments;
+  for (int i = 0; i < kSceneInstrumentCount; ++i) {
+    auto instrument = engine.CreateInstrument();
+    instrument.SetSampleData(slices);
+    instrument.SetControl(InstrumentControlType::kSliceMode, kSliceMode);
+    instrument.SetControl(InstrumentControlType::kOscMode, kOscMode);
+    instrument.SetControl(InstrumentControlType::kOscMix, 0.5f);
+    instrument.SetControl(InstrumentControlType::kOscNoiseMix, 0.1f);
+    instrument.SetControl(InstrumentControlType::kOscShape, static_cast<float>(i % 4) / 3.0f);
+    instrument.SetControl(InstrumentControlType::kOscSkew, 0.25f);
+    instrument.SetControl(InstrumentControlType::kAttack, 0.01f);
+    instrument.SetControl(InstrumentControlType::kDecay, 0.1f);
+    instrument.SetControl(InstrumentControlType::kSustain, 0.8f);
+    instrument.SetControl(InstrumentControlType::kRelease, 0.2f);
+    instrument.SetControl(InstrumentControlType::kStereoPan,
+                          static_cast<float>(i % 3 - 1) * 0.5f);
+    instrument.SetControl(InstrumentControlType::kCrushDepth, 0.25f);
+    instrument.SetControl(InstrumentControlType::kCrushRate, 0.1f);
+    instrument.SetControl(InstrumentControlType::kDistortionMix, 0.5f);
+    instrument.SetControl(InstrumentControlType::kDistortionDrive, 0.25f);
+    instrument.SetControl(InstrumentControlType::kFilterCutoff, 0.6f);
+    instrument.SetControl(InstrumentControlType::kFilterResonance, 0.7f);
+    instrument.SetControl(InstrumentControlType::kFilterTone, 0.25f);
+    instrument.SetControl(InstrumentControlType::kDelaySend, 0.25f);
+    instrument.SetControl(InstrumentControlType::kReverbSend, 0.5f);
+    instrument.SetControl(InstrumentControlType::kSidechainSend, (i % 5 == 0) ? 1.0f : -0.5f);
+    instrument.SetControl(InstrumentControlType::kRetrigger, true);
+    instruments.push_back(instrument);
+  }
+
+  const auto set_all_notes_on = [&]() {
+    for (int i = 0; i < kSceneInstrumentCount; ++i) {
+      for (int note = 0; note < kSceneNoteCount; ++note) {
+        instruments[i].SetNoteOn(static_cast<float>(i % 12 + note * 7) / 12.0f - 1.0f);
+      }
+    }
+  };
+  set_all_notes_on();
+
+  std::array<float, kChannelCount * kFrameCount> output_samples;
+  engine.Process(output_samples.data(), kChannelCount, kFrameCount, 0.0);  // start voices
+
+  int frame = 0;
+  for (auto _ : state) {  // NOLINT(clang-analyzer-deadcode.DeadStores)
+    if ((frame += kFrameCount) >= kSceneRetriggerFrameCount) {
+      state.PauseTiming();
+      set_all_notes_on();
+      frame = 0;
+      state.ResumeTiming();
+    }
+    engine.Process(output_samples.data(), kChannelCount, kFrameCount, 0.0);
+  }
+
+  state.counters["ns_per_frame"] =
+      Counter(static_cast<double>(kFrameCount) * 1e-9,
+              Counter::kIsIterationInvariantRate | Counter::kInvert);
+  state.counters["realtime_factor"] =
+      Counter(static_cast<double>(kFrameCount) / static_cast<double>(kSampleRate),
+              Counter::kIsIterationInvariantRate);
+}
+BENCHMARK_TEMPLATE(BM_BarelyEngine_ProcessScene, SliceMode::kSustain, OscMode::kCrossfade);
+BENCHMARK_TEMPLATE(BM_BarelyEngine_ProcessScene, SliceMode::kSustain, OscMode::kAm);
+BENCHMARK_TEMPLATE(BM_BarelyEngine_ProcessScene, SliceMode::kSustain, OscMode::kFm);
+BENCHMARK_TEMPLATE(BM_BarelyEngine_ProcessScene, SliceMode::kSustain, OscMode::kMa);
+BENCHMARK_TEMPLATE(BM_BarelyEngine_ProcessScene, SliceMode::kSustain, OscMode::kMf);
+BENCHMARK_TEMPLATE(BM_BarelyEngine_ProcessScene, SliceMode::kSustain, OscMode::kRing);
+BENCHMARK_TEMPLATE(BM_BarelyEngine_ProcessScene, SliceMode::kLoop, OscMode::kCrossfade);
+BENCHMARK_TEMPLATE(BM_BarelyEngine_ProcessScene, SliceMode::kLoop, OscMode::kAm);
+BENCHMARK_TEMPLATE(BM_BarelyEngine_ProcessScene, SliceMode::kLoop, OscMode::kFm);
+BENCHMARK_TEMPLATE(BM_BarelyEngine_ProcessScene, SliceMode::kLoop, OscMode::kMa);
+BENCHMARK_TEMPLATE(BM_BarelyEngine_ProcessScene, SliceMode::kLoop, OscMode::kMf);
+BENCHMARK_TEMPLATE(BM_BarelyEngine_ProcessScene, SliceMode::kLoop, OscMode::kRing);
+BENCHMARK_TEMPLATE(BM_BarelyEngine_ProcessScene, SliceMode::kOnce, OscMode::kCrossfade);
+BENCHMARK_TEMPLATE(BM_BarelyEngine_ProcessScene, SliceMode::kOnce, OscMode::kAm);
+BENCHMARK_TEMPLATE(BM_BarelyEngine_ProcessScene, SliceMode::kOnce, OscMode::kFm);
+BENCHMARK_TEMPLATE(BM_BarelyEngine_ProcessScene, SliceMode::kOnce, OscMode::kMa);
+BENCHMARK_TEMPLATE(BM_BarelyEngine_ProcessScene, SliceMode::kOnce, OscMode::kMf);
+BENCHMARK_TEMPLATE(BM_BarelyEngine_ProcessScene, SliceMode::kOnce, OscMode::kRing);
+
+// Scheduler layouts to measure `Update` cost with large task counts.
+enum class TaskLayout {
+  // Tasks packed at a few equal positions with mixed priorities.
+  kDense,
+  // Long tasks that overlap half the loop, which keeps many tasks active at once.
+  kOverlapping,
+  // Short loops that wrap around multiple times per beat.
+  kLooping,
+  // Tasks that move themselves to the next beat when they end.
+  kRescheduling,
+  // Tasks that are offset per performer, so that performers never share an event position.
+  kStaggered,
+};
+
+constexpr double kSchedulerLoopLength = 4.0;
+constexpr double kSchedulerShortLoopLength = 0.25;
+constexpr int kSchedulerPositionCount = 16;
+constexpr int kSchedulerPriorityCount = 8;
+
+template <TaskLayout kTaskLayout>
+void BM_BarelyEngine_UpdateTasks(State& state) {
+  const int task_count = static_cast<int>(state.range(0));
+  const int performer_count = static_cast<int>(state.range(1));
+  const int performer_task_count = task_count / performer_count;
+
+  EngineConfig config(kSampleRate);
+  config.max_performer_count = performer_count;
+  config.max_task_count = task_count;
+  Engine engine(config);
+  engine.SetTempo(60.0);  // one beat per second.
+
+  std::vector<Performer> performers;
+  std::vector<Task> tasks;
+  std::vector<double> task_positions(task_count);
+  tasks.reserve(task_count);
+  for (int i = 0; i < performer_count; ++i) {
+    auto performer = engine.CreatePerformer();
+    for (int j = 0; j < performer_task_count; ++j) {
+      const double offset = static_cast<double>(j) / static_cast<double>(performer_task_count);
+      const int32_t priority = j % kSchedulerPriorityCount - kSchedulerPriorityCount / 2;
+      const int task_index = static_cast<int>(tasks.size());
+      if constexpr (kTaskLayout == TaskLayout::kDense) {
+        constexpr double kStep = kSchedulerLoopLength / kSchedulerPositionCount;
+        task_positions[task_index] = kStep * static_cast<double>(j % kSchedulerPositionCount);
+        tasks.push_back(performer.CreateTask(task_positions[task_index], kStep, priority,
+                                             [](TaskEventType /*type*/) {}));
+      } else if constexpr (kTaskLayout == TaskLayout::kOverlapping) {
+        task_positions[task_index] = kSchedulerLoopLength * offset;
+        tasks.push_back(performer.CreateTask(task_positions[task_index],
+                                             0.5 * kSchedulerLoopLength, priority,
+                                             [](TaskEventType /*type*/) {}));
+      } else if constexpr (kTaskLayout == TaskLayout::kLooping) {
+        task_positions[task_index] = kSchedulerShortLoopLength * offset;
+        tasks.push_back(performer.CreateTask(task_positions[task_index],
+                                             0.25 * kSchedulerShortLoopLength, priority,
+                                             [](TaskEventType /*type*/) {}));
+      } else if constexpr (kTaskLayout == TaskLayout::kRescheduling) {
+        task_positions[task_index] = offset;
+        tasks.push_back(performer.CreateTask(
+            task_positions[task_index], 0.5 / static_cast<double>(performer_task_count), priority,
+            [&tasks, &task_positions, task_index](TaskEventType type) {
+              if (type == TaskEventType::kEnd) {
+                task_positions[task_index] += 1.0;
+                tasks[task_index].SetPosition(task_positions[task_index]);
+              }
+            }));
+      } else if constexpr (kTaskLayout == TaskLayout::kStaggered) {
+        const double step = kSchedulerLoopLength / static_cast<double>(performer_task_count);
+        task_positions[task_index] =
+            step * (static_cast<double>(j) +
+                    static_cast<double>(i) / static_cast<double>(performer_count));
+        tasks.push_back(performer.CreateTask(task_positions[task_index],
+                                             0.5 * step / static_cast<double>(performer_count),
+                                             priority, [](TaskEventType /*type*/) {}));
+      }
+    }
+    if constexpr (kTaskLayout != TaskLayout::kRescheduling) {
+      performer.SetLoopLength(kTaskLayout == TaskLayout::kLooping ? kSchedulerShortLoopLength
+                                                                   : kSchedulerLoopLength);
+      performer.SetLooping(true);
+    }
+    performer.Start();
+    performers.push_back(performer);
+  }
+
+  double timestamp = 0.0;
+  engine.Update(timestamp);
+
+  for (auto _ : state) {  // NOLINT(clang-analyzer-deadcode.DeadStores)
+    timestamp += 1.0;
+    engine.Update(timestamp);
+  }
+
+  state.counters["ns_per_beat"] =
+      Counter(1e-9, Counter::kIsIterationInvariantRate | Counter::kInvert);
+}
+BENCHMARK_TEMPLATE(BM_BarelyEngine_UpdateTasks, TaskLayout::kDense)
+    ->ArgsProduct({{1000, 5000, 50000}, {1, 10, 100}})
+    ->Unit(::benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_BarelyEngine_UpdateTasks, TaskLayout::kOverlapping)
+    ->ArgsProduct({{1000, 5000, 50000}, {1, 10, 100}})
+    ->Unit(::benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_BarelyEngine_UpdateTasks, TaskLayout::kLooping)
+    ->ArgsProduct({{1000, 5000, 50000}, {1, 10, 100}})
+    ->Unit(::benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_BarelyEngine_UpdateTasks, TaskLayout::kRescheduling)
+    ->ArgsProduct({{1000, 5000, 50000}, {1, 10, 100}})
+    ->Unit(::benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_BarelyEngine_UpdateTasks, TaskLayout::kStaggered)
+    ->ArgsProduct({{1000, 5000, 50000}, {1, 10, 100}})
+    ->Unit(::benchmark::kMillisecond);
+
+template <bool kIsBatched>
+void BM_BarelyPerformer_CreateTasks(State& state) {
+  const int task_count = static_cast<int>(state.range(0));
+
+  EngineConfig config(kSampleRate);
+  config.max_task_count = task_count;
+  Engine engine(config);
+
+  std::vector<TaskDesc> task_descs(task_count);
+  std::vector<Task> tasks(task_count);
+  for (auto _ : state) {  // NOLINT(clang-analyzer-deadcode.DeadStores)
+    state.PauseTiming();
+    for (int i = 0; i < task_count; ++i) {
+      // Scramble the positions to avoid inserting the tasks in order.
+      task_descs[i] = {static_cast<double>((i * 7919) % task_count) / kSchedulerPositionCount, 0.25,
+                       i % kSchedulerPriorityCount, [](TaskEventType /*type*/) {}};
+    }
+    auto performer = engine.CreatePerformer();
+    state.ResumeTiming();
+
+    if constexpr (kIsBatched) {
+      performer.CreateTasks(task_descs, tasks);
+    } else {
+      for (int i = 0; i < task_count; ++i) {
+        tasks[i] = performer.CreateTask(task_descs[i].position, task_descs[i].duration,
+                                        task_descs[i].priority, std::move(task_descs[i].callback));
+      }
+    }
+
+    state.PauseTiming();
+    performer.Destroy();
+    state.ResumeTiming();
+  }
+
+  state.SetItemsProcessed(state.iterations() * task_count);
+}
+BENCHMARK_TEMPLATE(BM_BarelyPerformer_CreateTasks, false)
+    ->Arg(1000)
+    ->Arg(50000)
+    ->Unit(::benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_BarelyPerformer_CreateTasks, true)
+    ->Arg(1000)
+    ->Arg(50000)
+    ->Unit(::benchmark::kMillisecond);
+
 void BM_BarelyInstrument_SetMultipleControls(State& state) {
   Engine engine(kSampleRate);
 
@@ -0,0 +1,309 @@
+// Headless stress harness that runs `Process` on a simulated real-time audio thread with a fixed
+// period, while one or more control threads call `Update` and setters under randomized load.
+//
+// Reports the `Process` duration percentiles, the deadline misses, and the command-to-audio
+// latency distribution, which is measured from the wall time a note-on command is issued to the
+// wall time the audio block that consumes it is done processing.
+//
+// Usage:
+//   barelymusician_stress [--duration=10] [--frame_count=256] [--control_thread_count=2]
+//                         [--instrument_count=16] [--lookahead_block_count=2] [--seed=0]
+//                         [--fail_on_deadline_miss]
+
+#include <barelymusician.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif  // defined(__linux__)
+
+namespace barely {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kSampleRate = 48000;
+constexpr int kChannelCount = 2;
+constexpr int kSampleCount = kSampleRate / 4;
+constexpr int kPerformerTaskCount = 32;
+constexpr int kMaxLatencyRecordCount = 1 << 20;
+
+struct Options {
+  double duration = 10.0;
+  int frame_count = 256;
+  int control_thread_count = 2;
+  int instrument_count = 16;
+  int lookahead_block_count = 2;
+  unsigned int seed = 0;
+  bool fail_on_deadline_miss = false;
+};
+
+// Audio block record.
+struct BlockRecord {
+  int64_t frame = 0;
+  Clock::time_point begin_time;
+  Clock::time_point end_time;
+};
+
+// Note-on command record.
+struct LatencyRecord {
+  int64_t frame = 0;
+  Clock::time_point issue_time;
+};
+
+bool ParseOptions(int argc, char* argv[], Options& options) {
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    const char* value = std::strchr(arg, '=');
+    const auto is_flag = [&](const char* name) {
+      const size_t length = std::strlen(name);
+      return std::strncmp(arg, name, length) == 0 && arg[length] == '=';
+    };
+    if (std::strcmp(arg, "--fail_on_deadline_miss") == 0) {
+      options.fail_on_deadline_miss = true;
+    } else if (is_flag("--duration")) {
+      options.duration = std::atof(value + 1);
+    } else if (is_flag("--frame_count")) {
+      options.frame_count = std::atoi(value + 1);
+    } else if (is_flag("--control_thread_count")) {
+      options.control_thread_count = std::atoi(value + 1);
+    } else if (is_flag("--instrument_count")) {
+      options.instrument_count = std::atoi(value + 1);
+    } else if (is_flag("--lookahead_block_count")) {
+      options.lookahead_block_count = std::atoi(value + 1);
+    } else if (is_flag("--seed")) {
+      options.seed = static_cast<unsigned int>(std::atoi(value + 1));
+    } else {
+      std::fprintf(stderr, "Unknown argument: %s\n", arg);
+      return false;
+    }
+  }
+  return options.duration > 0.0 && options.frame_count > 0 && options.control_thread_count > 0 &&
+         options.instrument_count > 0 && options.lookahead_block_count >= 0;
+}
+
+// Raises the calling thread to real-time priority when permitted, returns whether it succeeded.
+bool SetRealtimePriority() noexcept {
+#if defined(__linux__)
+  sched_param param = {};
+  param.sched_priority = sched_get_priority_max(SCHED_FIFO);
+  return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+#else   // defined(__linux__)
+  return false;
+#endif  // defined(__linux__)
+}
+
+double ToMicroseconds(Clock::duration duration) noexcept {
+  return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+void PrintPercentiles(const char* name, std::vector<double>& values) {
+  if (values.empty()) {
+    std::printf("%-20s n=0\n", name);
+    return;
+  }
+  std::sort(values.begin(), values.end());
+  const auto percentile = [&](double p) {
+    return values[std::min(values.size() - 1,
+                           static_cast<size_t>(p * static_cast<double>(values.size())))];
+  };
+  std::printf("%-20s n=%-8zu p50=%9.1fus p99=%9.1fus p99.9=%9.1fus max=%9.1fus\n", name,
+              values.size(), percentile(0.5), percentile(0.99), percentile(0.999), values.back());
+}
+
+}  // namespace
+}  // namespace barely
+
+int main(int argc, char* argv[]) {
+  using ::barely::BlockRecord;
+  using ::barely::Clock;
+  using ::barely::Engine;
+  using ::barely::EngineConfig;
+  using ::barely::Instrument;
+  using ::barely::InstrumentControlType;
+  using ::barely::LatencyRecord;
+  using ::barely::NoteControlType;
+  using ::barely::Options;
+  using ::barely::Performer;
+  using ::barely::Slice;
+  using ::barely::Task;
+  using ::barely::TaskEventType;
+
+  Options options;
+  if (!::barely::ParseOptions(argc, argv, options)) {
+    return EXIT_FAILURE;
+  }
+
+  EngineConfig config(::barely::kSampleRate);
+  config.max_frame_count = std::max(config.max_frame_count, options.frame_count);
+  Engine engine(config);
+  engine.SetTempo(120.0);
+
+  std::vector<float> samples(::barely::kSampleCount);
+  for (int i = 0; i < ::barely::kSampleCount; ++i) {
+    samples[i] = std::sin(0.05f * static_cast<float>(i));
+  }
+  const Slice slices[] = {Slice(samples, ::barely::kSampleRate, 0.0f),
+                          Slice(samples, ::barely::kSampleRate, 1.0f)};
+
+  std::vector<Instrument> instruments;
+  for (int i = 0; i < options.instrument_count; ++i) {
+    instruments.push_back(engine.CreateInstrument());
+    instruments.back().SetControl(InstrumentControlType::kReverbSend, 0.25f);
+    instruments.back().SetControl(InstrumentControlType::kDelaySend, 0.25f);
+  }
+
+  std::vector<Task> tasks;
+  tasks.reserve(::barely::kPerformerTaskCount);
+  Performer performer = engine.CreatePerformer();
+  for (int i = 0; i < ::barely::kPerformerTaskCount; ++i) {
+    Instrument& instrument = instruments[i % options.instrument_count];
+    const float pitch = static_cast<float>(i % 12) / 12.0f;
+    tasks.push_back(performer.CreateTask(
+        0.125 * static_cast<double>(i), 0.1, 0, [&instrument, pitch](TaskEventType type) {
+          if (type == TaskEventType::kBegin) {
+            instrument.SetNoteOn(pitch);
+          } else {
+            instrument.SetNoteOff(pitch);
+          }
+        }));
+  }
+  performer.SetLoopLength(4.0);
+  performer.SetLooping(true);
+  performer.Start();
+
+  const double period =
+      static_cast<double>(options.frame_count) / static_cast<double>(::barely::kSampleRate);
+  const auto period_duration =
+      std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(period));
+  const int block_count = static_cast<int>(std::ceil(options.duration / period));
+
+  // All the records are preallocated to avoid any allocations during the run.
+  std::vector<BlockRecord> block_records(block_count);
+  std::vector<LatencyRecord> latency_records(::barely::kMaxLatencyRecordCount);
+  int latency_record_count = 0;
+
+  std::mutex control_mutex;
+  std::atomic<bool> is_running = true;
+  bool is_realtime = false;
+
+  const Clock::time_point start_time = Clock::now() + period_duration;
+
+  std::thread audio_thread([&]() {
+    is_realtime = ::barely::SetRealtimePriority();
+    std::vector<float> output_samples(::barely::kChannelCount * options.frame_count);
+    for (int i = 0; i < block_count; ++i) {
+      std::this_thread::sleep_until(start_time + i * period_duration);
+      BlockRecord& record = block_records[i];
+      record.frame = static_cast<int64_t>(i) * options.frame_count;
+      record.begin_time = Clock::now();
+      engine.Process(output_samples.data(), ::barely::kChannelCount, options.frame_count,
+                     static_cast<double>(i) * period);
+      record.end_time = Clock::now();
+    }
+    is_running = false;
+  });
+
+  std::vector<std::thread> control_threads;
+  for (int thread_index = 0; thread_index < options.control_thread_count; ++thread_index) {
+    control_threads.emplace_back([&, thread_index]() {
+      std::mt19937 rng(options.seed + static_cast<unsigned int>(thread_index));
+      std::uniform_int_distribution<int> action_distribution(0, 99);
+      std::uniform_int_distribution<int> instrument_distribution(0, options.instrument_count - 1);
+      std::uniform_int_distribution<int> pitch_distribution(-24, 24);
+      std::uniform_int_distribution<int> sleep_distribution(0, 2000);  // microseconds
+      std::uniform_real_distribution<float> value_distribution(0.0f, 1.0f);
+      while (is_running) {
+        {
+          std::lock_guard<std::mutex> lock(control_mutex);
+          const double timestamp =
+              std::chrono::duration<double>(Clock::now() - start_time).count() +
+              static_cast<double>(options.lookahead_block_count) * period;
+          engine.Update(std::max(timestamp, 0.0));
+
+          // Issue a randomized burst of commands.
+          const int action_count = 1 + action_distribution(rng) / 10;
+          for (int i = 0; i < action_count; ++i) {
+            Instrument& instrument = instruments[instrument_distribution(rng)];
+            const float pitch = static_cast<float>(pitch_distribution(rng)) / 12.0f;
+            if (const int action = action_distribution(rng); action < 40) {
+              if (latency_record_count < ::barely::kMaxLatencyRecordCount) {
+                latency_records[latency_record_count++] = {
+                    static_cast<int64_t>(std::max(timestamp, 0.0) * ::barely::kSampleRate),
+                    Clock::now()};
+              }
+              instrument.SetNoteOn(pitch);
+            } else if (action < 70) {
+              instrument.SetNoteOff(pitch);
+            } else if (action < 85) {
+              instrument.SetControl(InstrumentControlType::kFilterCutoff, value_distribution(rng));
+            } else if (action < 93) {
+              instrument.SetNoteControl(pitch, NoteControlType::kPitchShift,
+                                        value_distribution(rng));
+            } else if (action < 98) {
+              tasks[(pitch_distribution(rng) + 24) % ::barely::kPerformerTaskCount].SetPosition(
+                  4.0 * static_cast<double>(value_distribution(rng)));
+            } else {
+              instrument.SetSampleData(slices);
+            }
+          }
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(sleep_distribution(rng)));
+      }
+    });
+  }
+
+  audio_thread.join();
+  for (auto& control_thread : control_threads) {
+    control_thread.join();
+  }
+
+  // Compute the results offline.
+  std::vector<double> process_durations(block_count);
+  int deadline_miss_count = 0;
+  for (int i = 0; i < block_count; ++i) {
+    const BlockRecord& record = block_records[i];
+    process_durations[i] = ::barely::ToMicroseconds(record.end_time - record.begin_time);
+    if (record.end_time > start_time + (i + 1) * period_duration) {
+      ++deadline_miss_count;
+    }
+  }
+
+  std::vector<double> latencies;
+  latencies.reserve(latency_record_count);
+  for (int i = 0; i < latency_record_count; ++i) {
+    const LatencyRecord& record = latency_records[i];
+    // Find the first block that was processed after the command got issued, and covers its frame.
+    const auto it = std::lower_bound(
+        block_records.begin(), block_records.end(), record,
+        [&](const BlockRecord& block_record, const LatencyRecord& latency_record) {
+          return block_record.frame + options.frame_count <= latency_record.frame ||
+                 block_record.begin_time < latency_record.issue_time;
+        });
+    if (it != block_records.end()) {
+      latencies.push_back(::barely::ToMicroseconds(it->end_time - record.issue_time));
+    }
+  }
+
+  std::printf("frame_count=%d period=%.1fus control_threads=%d instruments=%d realtime=%s\n",
+              options.frame_count, 1e6 * period, options.control_thread_count,
+              options.instrument_count, is_realtime ? "yes" : "no");
+  ::barely::PrintPercentiles("process_duration", process_durations);
+  ::barely::PrintPercentiles("command_latency", latencies);
+  std::printf("deadline_misses=%d/%d\n", deadline_miss_count, block_count);
+
+  return (options.fail_on_deadline_miss && deadline_miss_count > 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
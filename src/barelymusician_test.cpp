@@ -1,8 +1,12 @@
 #include <barelymusician.h>
 
 #include <array>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <span>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -26,6 +30,139 @@ TEST(BarelyEngineTest, CreateDestroyEngine) {
   BarelyEngine_Destroy(engine);
 }
 
+TEST(BarelyEngineTest, CreateDestroyEngineWithMemoryFlags) {
+  BarelyEngineConfig config = BARELY_ENGINE_CONFIG_DEFAULT(kSampleRate);
+  config.memory_flags = BarelyEngineMemoryFlags_kPrefault | BarelyEngineMemoryFlags_kLock |
+                        BarelyEngineMemoryFlags_kHugePages;
+  const int32_t allocation_size = BarelyEngineConfig_GetRequiredAllocationSize(&config);
+  std::vector<std::byte> allocation(allocation_size);
+  BarelyEngine* engine = BarelyEngine_Create(&config, allocation.data(), allocation_size);
+  EXPECT_TRUE(engine != nullptr);
+
+  // Locking the memory may fail due to the system limits, which should not affect the engine.
+  std::vector<float> output_samples(2 * config.max_frame_count);
+  BarelyEngine_Process(engine, output_samples.data(), 2, config.max_frame_count, 0.0);
+  for (const float sample : output_samples) {
+    EXPECT_FLOAT_EQ(sample, 0.0f);
+  }
+
+  BarelyEngine_Destroy(engine);
+}
+
+TEST(BarelyEngineTest, CreateDestroyEngineWithoutEffects) {
+  BarelyEngineConfig config = BARELY_ENGINE_CONFIG_DEFAULT(kSampleRate);
+  const int32_t default_allocation_size = BarelyEngineConfig_GetRequiredAllocationSize(&config);
+
+  // Shorter delay should require less memory.
+  config.max_delay_time = 1.0f;
+  const int32_t delay_allocation_size = BarelyEngineConfig_GetRequiredAllocationSize(&config);
+  EXPECT_LT(delay_allocation_size, default_allocation_size);
+
+  // Disabling the effects should not require any delay or reverb buffers.
+  config.effect_flags = BarelyEngineEffectFlags_kNone;
+  const int32_t allocation_size = BarelyEngineConfig_GetRequiredAllocationSize(&config);
+  EXPECT_LT(allocation_size, delay_allocation_size);
+
+  std::vector<std::byte> allocation(allocation_size);
+  BarelyEngine* engine = BarelyEngine_Create(&config, allocation.data(), allocation_size);
+  EXPECT_TRUE(engine != nullptr);
+
+  // Send the instrument fully to the bypassed effects, which should silence the output.
+  const uint32_t instrument_id = BarelyEngine_CreateInstrument(engine);
+  BarelyInstrument_SetControl(engine, instrument_id, BarelyInstrumentControlType_kOscMix, 1.0f);
+  BarelyInstrument_SetControl(engine, instrument_id, BarelyInstrumentControlType_kDelaySend, 1.0f);
+  BarelyInstrument_SetControl(engine, instrument_id, BarelyInstrumentControlType_kReverbSend, 2.0f);
+  BarelyInstrument_SetNoteOn(engine, instrument_id, 0.0f);
+  BarelyEngine_SetControl(engine, BarelyEngineControlType_kDelayTime, 0.5f);
+
+  std::vector<float> output_samples(2 * config.max_frame_count);
+  BarelyEngine_Process(engine, output_samples.data(), 2, config.max_frame_count, 0.0);
+  for (const float sample : output_samples) {
+    EXPECT_FLOAT_EQ(sample, 0.0f);
+  }
+
+  BarelyInstrument_Destroy(engine, instrument_id);
+  BarelyEngine_Destroy(engine);
+}
+
+TEST(BarelyEngineTest, CreateDestroyEngineWithCompactEffects) {
+  BarelyEngineConfig config = BARELY_ENGINE_CONFIG_DEFAULT(kSampleRate);
+  BarelyEngineMemoryBreakdown memory_breakdown;
+  ASSERT_TRUE(BarelyEngineConfig_GetMemoryBreakdown(&config, &memory_breakdown));
+
+  // Compact effects should require about half the delay and reverb memory.
+  BarelyEngineConfig compact_config = config;
+  compact_config.memory_flags = BarelyEngineMemoryFlags_kCompactEffects;
+  BarelyEngineMemoryBreakdown compact_memory_breakdown;
+  ASSERT_TRUE(BarelyEngineConfig_GetMemoryBreakdown(&compact_config, &compact_memory_breakdown));
+  EXPECT_LE(2 * compact_memory_breakdown.delay_size, memory_breakdown.delay_size + 4096);
+  EXPECT_LE(2 * compact_memory_breakdown.reverb_size, memory_breakdown.reverb_size + 4096);
+
+  // Both engines should render the same effects within the half precision error.
+  std::array<std::vector<float>, 2> output_samples;
+  for (int i = 0; i < 2; ++i) {
+    const BarelyEngineConfig& engine_config = (i == 0) ? config : compact_config;
+    const int32_t allocation_size = BarelyEngineConfig_GetRequiredAllocationSize(&engine_config);
+    std::vector<std::byte> allocation(allocation_size);
+    BarelyEngine* engine = BarelyEngine_Create(&engine_config, allocation.data(), allocation_size);
+    ASSERT_TRUE(engine != nullptr);
+
+    const uint32_t instrument_id = BarelyEngine_CreateInstrument(engine);
+    BarelyInstrument_SetControl(engine, instrument_id, BarelyInstrumentControlType_kOscMix, 1.0f);
+    BarelyInstrument_SetControl(engine, instrument_id, BarelyInstrumentControlType_kDelaySend,
+                                1.0f);
+    BarelyInstrument_SetControl(engine, instrument_id, BarelyInstrumentControlType_kReverbSend,
+                                1.0f);
+    BarelyEngine_SetControl(engine, BarelyEngineControlType_kDelayTime, 0.01f);
+    BarelyInstrument_SetNoteOn(engine, instrument_id, 0.0f);
+
+    constexpr int kBlockCount = 16;
+    output_samples[i].resize(2 * kBlockCount * config.max_frame_count);
+    for (int block = 0; block < kBlockCount; ++block) {
+      BarelyEngine_Process(engine, &output_samples[i][2 * block * config.max_frame_count], 2,
+                           config.max_frame_count,
+                           static_cast<double>(block * config.max_frame_count) / kSampleRate);
+    }
+
+    BarelyInstrument_Destroy(engine, instrument_id);
+    BarelyEngine_Destroy(engine);
+  }
+  for (size_t i = 0; i < output_samples[0].size(); ++i) {
+    EXPECT_NEAR(output_samples[1][i], output_samples[0][i], 1e-2f) << i;
+  }
+}
+
+TEST(BarelyEngineTest, GetMemoryBreakdown) {
+  BarelyEngineMemoryBreakdown memory_breakdown;
+  EXPECT_FALSE(BarelyEngineConfig_GetMemoryBreakdown(nullptr, &memory_breakdown));
+
+  BarelyEngineConfig config = BARELY_ENGINE_CONFIG_DEFAULT(kSampleRate);
+  ASSERT_TRUE(BarelyEngineConfig_GetMemoryBreakdown(&config, &memory_breakdown));
+  EXPECT_EQ(memory_breakdown.total_size, BarelyEngineConfig_GetRequiredAllocationSize(&config));
+  const int32_t sizes[] = {
+      memory_breakdown.instrument_pool_size, memory_breakdown.performer_pool_size,
+      memory_breakdown.task_pool_size,       memory_breakdown.voice_pool_size,
+      memory_breakdown.slice_pool_size,      memory_breakdown.command_queue_size,
+      memory_breakdown.delay_size,           memory_breakdown.reverb_size,
+      memory_breakdown.scratch_size,
+  };
+  int32_t total_size = 0;
+  for (const int32_t size : sizes) {
+    EXPECT_GT(size, 0);
+    total_size += size;
+  }
+  EXPECT_LE(total_size, memory_breakdown.total_size);
+
+  // More voices should require a larger voice pool.
+  const int32_t voice_pool_size = memory_breakdown.voice_pool_size;
+  config.max_voice_count *= 2;
+  config.effect_flags = BarelyEngineEffectFlags_kNone;
+  ASSERT_TRUE(BarelyEngineConfig_GetMemoryBreakdown(&config, &memory_breakdown));
+  EXPECT_GT(memory_breakdown.voice_pool_size, voice_pool_size);
+  EXPECT_EQ(memory_breakdown.delay_size, 0);
+  EXPECT_EQ(memory_breakdown.reverb_size, 0);
+}
+
 TEST(BarelyEngineTest, CreateDestroyInstrument) {
   const BarelyEngineConfig config = BARELY_ENGINE_CONFIG_DEFAULT(kSampleRate);
   const int32_t allocation_size = BarelyEngineConfig_GetRequiredAllocationSize(&config);
@@ -66,6 +203,691 @@ TEST(EngineTest, CreateDestroyPerformer) {
   engine.CreatePerformer().Destroy();
 }
 
+TEST(EngineTest, CreateClip) {
+  Engine engine(kSampleRate);
+  engine.SetTempo(60.0);
+  auto instrument = engine.CreateInstrument();
+  auto performer = engine.CreatePerformer();
+
+  const std::array<Note, 2> notes = {Note(1.0, 1.0, 0.0f), Note(0.0, 0.5, 1.0f, 0.5f)};
+  std::array<Task, 2> tasks;
+  performer.CreateClip(instrument, notes, tasks);
+  for (const auto& task : tasks) {
+    EXPECT_NE(task, 0);
+    EXPECT_FALSE(task.IsActive());
+  }
+
+  performer.Start();
+  engine.Update(1.5);
+  EXPECT_TRUE(tasks[0].IsActive());
+  EXPECT_FALSE(tasks[1].IsActive());
+
+  // Clip tasks can still have callbacks.
+  bool has_ended = false;
+  tasks[0].SetCallback([&](TaskEventType type) { has_ended = (type == TaskEventType::kEnd); });
+  engine.Update(2.0);
+  EXPECT_TRUE(has_ended);
+
+  tasks[1].Destroy();
+  performer.Destroy();
+}
+
+TEST(EngineTest, EditActiveTasksInCallbacks) {
+  Engine engine(kSampleRate);
+  engine.SetTempo(60.0);
+  auto performer = engine.CreatePerformer();
+
+  std::vector<std::string> events;
+  const auto record_fn = [&](const std::string& name) {
+    return [&events, name](TaskEventType type) {
+      events.push_back(name + ((type == TaskEventType::kBegin) ? " begin" : " end"));
+    };
+  };
+  Task task_a = performer.CreateTask(0.0, 1.0, 0, [](TaskEventType) {});
+  Task task_b = performer.CreateTask(0.0, 1.0, 0, record_fn("b"));
+  Task task_c = performer.CreateTask(0.0, 1.0, 0, record_fn("c"));
+  Task task_d = performer.CreateTask(0.0, 2.0, 0, record_fn("d"));
+  Task task_e;
+
+  performer.Start();
+  engine.Update(0.5);
+  EXPECT_EQ(events, (std::vector<std::string>{"b begin", "c begin", "d begin"}));
+  events.clear();
+
+  // Destroy, move, and create tasks while the active tasks get ended.
+  task_a.SetCallback([&](TaskEventType type) {
+    if (type == TaskEventType::kEnd) {
+      events.push_back("a end");
+      task_b.Destroy();
+      task_d.SetPosition(5.0);
+      task_e = performer.CreateTask(1.0, 0.5, 0, record_fn("e"));
+    }
+  });
+  engine.Update(1.25);
+  EXPECT_EQ(events, (std::vector<std::string>{"a end", "b end", "c end", "d end", "e begin"}));
+  EXPECT_FALSE(task_c.IsActive());
+  EXPECT_FALSE(task_d.IsActive());
+  EXPECT_TRUE(task_e.IsActive());
+}
+
+TEST(EngineTest, SetTempoMap) {
+  Engine engine(kSampleRate);
+  engine.SetTempo(60.0);
+
+  // Ramp from 60 to 180 beats per minute in two seconds, and then stay constant.
+  const std::array<TempoPoint, 2> points = {TempoPoint(0.0, 60.0, true), TempoPoint(2.0, 180.0)};
+  engine.SetTempoMap(points);
+
+  auto performer = engine.CreatePerformer();
+  std::vector<double> timestamps;
+  std::vector<Task> tasks;
+  for (const double position : {1.0, 4.0, 7.0}) {
+    tasks.push_back(performer.CreateTask(position, 0.5, 0, [&](TaskEventType type) {
+      if (type == TaskEventType::kBegin) {
+        timestamps.push_back(engine.GetTimestamp());
+      }
+    }));
+  }
+
+  performer.Start();
+  engine.Update(10.0);
+  ASSERT_EQ(timestamps.size(), 3);
+  EXPECT_DOUBLE_EQ(timestamps[0], std::sqrt(3.0) - 1.0);
+  EXPECT_DOUBLE_EQ(timestamps[1], 2.0);
+  EXPECT_DOUBLE_EQ(timestamps[2], 3.0);
+  EXPECT_DOUBLE_EQ(performer.GetPosition(), 28.0);
+}
+
+TEST(EngineTest, UpdateAndProcess) {
+  constexpr int kFrameCount = 256;
+  constexpr int kNoteFrame = kSampleRate / 4 + 100;
+
+  Engine engine(kSampleRate);
+  engine.SetTempo(60.0);
+  engine.SetControl(EngineControlType::kDelayMix, 0.0f);
+  engine.SetControl(EngineControlType::kReverbMix, 0.0f);
+
+  auto instrument = engine.CreateInstrument();
+  instrument.SetControl(InstrumentControlType::kOscMix, 1.0f);
+  instrument.SetControl(InstrumentControlType::kOscShape, 1.0f);
+
+  // Play a note in the middle of an output buffer.
+  auto performer = engine.CreatePerformer();
+  const std::array<Note, 1> notes = {
+      Note(static_cast<double>(kNoteFrame) / kSampleRate, 1.0, 0.0f),
+  };
+  std::array<Task, 1> tasks;
+  performer.CreateClip(instrument, notes, tasks);
+  performer.Start();
+
+  std::array<float, kFrameCount> output_samples;
+  for (int frame = 0; frame < kNoteFrame + kFrameCount; frame += kFrameCount) {
+    engine.UpdateAndProcess(output_samples.data(), 1, kFrameCount,
+                            static_cast<double>(frame) / kSampleRate);
+    for (int i = 0; i < kFrameCount; ++i) {
+      if (frame + i < kNoteFrame) {
+        EXPECT_FLOAT_EQ(output_samples[i], 0.0f) << frame + i;
+      } else if (frame + i > kNoteFrame) {
+        EXPECT_NE(output_samples[i], 0.0f) << frame + i;
+      }
+    }
+  }
+}
+
+TEST(EngineTest, ProcessWithEvents) {
+  constexpr int kFrameCount = 256;
+  constexpr int kNoteOnFrame = 100;
+  constexpr int kNoteOffFrame = 200;
+
+  struct TestEngine {
+    TestEngine() noexcept : engine(kSampleRate), instrument(engine.CreateInstrument()) {
+      engine.SetControl(EngineControlType::kDelayMix, 0.0f);
+      engine.SetControl(EngineControlType::kReverbMix, 0.0f);
+      instrument.SetControl(InstrumentControlType::kOscMix, 1.0f);
+      instrument.SetControl(InstrumentControlType::kOscShape, 1.0f);
+    }
+
+    Engine engine;
+    Instrument instrument;
+  };
+
+  // Play a note in the middle of an output buffer, where the invalid events are ignored.
+  TestEngine test;
+  const std::array<EngineEvent, 6> events = {
+      EngineEvent::NoteOn(-1, test.instrument, 1.0f),
+      EngineEvent::NoteOn(kNoteOnFrame, 0, 0.0f),
+      EngineEvent::NoteOn(kNoteOnFrame, test.instrument, 0.0f),
+      EngineEvent(BarelyEngineEvent{kNoteOffFrame, BarelyEngineEventType_kInstrumentControl,
+                                    test.instrument, BarelyInstrumentControlType_kCount, 0.0f,
+                                    0.0f}),
+      EngineEvent::NoteOff(kNoteOffFrame, test.instrument, 0.0f),
+      EngineEvent::NoteOn(kFrameCount, test.instrument, 1.0f),
+  };
+  std::array<float, kFrameCount> output_samples;
+  test.engine.ProcessWithEvents(output_samples.data(), 1, kFrameCount, 0.0, events);
+
+  // Schedule the same note with the setters.
+  TestEngine expected;
+  expected.engine.Update(static_cast<double>(kNoteOnFrame) / kSampleRate);
+  expected.instrument.SetNoteOn(0.0f);
+  expected.engine.Update(static_cast<double>(kNoteOffFrame) / kSampleRate);
+  expected.instrument.SetNoteOff(0.0f);
+  std::array<float, kFrameCount> expected_output_samples;
+  expected.engine.Process(expected_output_samples.data(), 1, kFrameCount, 0.0);
+
+  for (int i = 0; i < kFrameCount; ++i) {
+    if (i <= kNoteOnFrame) {
+      EXPECT_FLOAT_EQ(output_samples[i], 0.0f) << i;
+    } else {
+      EXPECT_NE(output_samples[i], 0.0f) << i;
+    }
+    EXPECT_FLOAT_EQ(output_samples[i], expected_output_samples[i]) << i;
+  }
+}
+
+TEST(EngineTest, ProcessWithEventsThaw) {
+  constexpr int kFreezeSampleRate = 1000;
+  constexpr int kFrameCount = 50;
+
+  EngineConfig config(kFreezeSampleRate);
+  config.freeze_frame_count = 500;
+  Engine engine(config);
+  engine.SetTempo(60.0);
+  auto instrument = engine.CreateInstrument();
+  auto performer = engine.CreatePerformer();
+  performer.SetLooping(true);
+  performer.SetLoopLength(0.5);
+  performer.Start();
+  ASSERT_TRUE(instrument.Freeze(performer));
+
+  // An event of the frozen instrument should thaw it, which the control thread catches up with.
+  std::array<float, kFrameCount> output_samples;
+  const std::array<EngineEvent, 1> events = {
+      EngineEvent::InstrumentControl(10, instrument, InstrumentControlType::kGain, 0.5f),
+  };
+  engine.ProcessWithEvents(output_samples.data(), 1, kFrameCount, 0.0, events);
+  EXPECT_FALSE(instrument.IsFrozen());
+  engine.Update(static_cast<double>(kFrameCount) / kFreezeSampleRate);
+  EXPECT_FALSE(instrument.IsFrozen());
+
+  // The instrument should freeze again, and stay frozen without any events.
+  EXPECT_TRUE(instrument.Freeze(performer));
+  engine.ProcessWithEvents(output_samples.data(), 1, kFrameCount,
+                           static_cast<double>(kFrameCount) / kFreezeSampleRate, {});
+  EXPECT_TRUE(instrument.IsFrozen());
+
+  // A thaw of the earlier freeze should not undo the next freeze that is still queued.
+  engine.Update(static_cast<double>(2 * kFrameCount + 20) / kFreezeSampleRate);
+  EXPECT_TRUE(instrument.Freeze(performer));
+  engine.ProcessWithEvents(output_samples.data(), 1, kFrameCount,
+                           static_cast<double>(2 * kFrameCount) / kFreezeSampleRate, events);
+  EXPECT_TRUE(instrument.IsFrozen());
+  engine.Update(static_cast<double>(3 * kFrameCount) / kFreezeSampleRate);
+  EXPECT_TRUE(instrument.IsFrozen());
+}
+
+TEST(EngineTest, GrowPools) {
+  EngineConfig config(kSampleRate);
+  config.max_task_count = 2;
+  Engine engine(config);
+  engine.SetTempo(60.0);
+  auto performer = engine.CreatePerformer();
+
+  int begin_count = 0;
+  const auto callback = [&](TaskEventType type) {
+    if (type == TaskEventType::kBegin) {
+      ++begin_count;
+    }
+  };
+  std::vector<Task> tasks;
+  for (int i = 0; i < 2; ++i) {
+    tasks.push_back(performer.CreateTask(static_cast<double>(i), 0.5, 0, callback));
+  }
+
+  // Task count cannot exceed the identifier capacity.
+  EXPECT_FALSE(engine.GrowPools(0, 1 << 20, 0));
+  EXPECT_TRUE(engine.GrowPools(0, 4, 0));
+  for (int i = 2; i < 4; ++i) {
+    tasks.push_back(performer.CreateTask(static_cast<double>(i), 0.5, 0, callback));
+  }
+  for (const auto& task : tasks) {
+    EXPECT_NE(static_cast<uint32_t>(task), 0);
+  }
+
+  performer.Start();
+  engine.Update(3.25);
+  EXPECT_EQ(begin_count, 4);
+}
+
+TEST(EngineTest, GrowVoicePool) {
+  constexpr int kFrameCount = 16;
+  const auto process = [](int32_t max_voice_count, bool should_grow) {
+    EngineConfig config(kSampleRate);
+    config.max_voice_count = max_voice_count;
+    Engine engine(config);
+    auto instrument = engine.CreateInstrument();
+    instrument.SetControl(InstrumentControlType::kOscMix, 1.0f);
+    instrument.SetControl(InstrumentControlType::kVoiceCount, 2);
+    if (should_grow) {
+      EXPECT_TRUE(engine.GrowPools(0, 0, 2));
+    }
+    instrument.SetNoteOn(0.0f);
+    instrument.SetNoteOn(1.0f);
+    std::array<float, kFrameCount> output_samples = {};
+    engine.Process(output_samples.data(), 1, kFrameCount, 0.0);
+    return output_samples;
+  };
+
+  // The grown voice pool should play both notes as if it had two voices from the start.
+  const auto grown_output_samples = process(1, true);
+  EXPECT_EQ(grown_output_samples, process(2, false));
+  EXPECT_NE(grown_output_samples, process(1, false));
+}
+
+TEST(EngineTest, SetSampleBank) {
+  constexpr int kFrameCount = 4;
+  constexpr std::array<float, kFrameCount> kSamples = {0.5f, -0.25f, 0.75f, 1.0f};
+  const std::array<Slice, 2> kSlices = {
+      Slice(kSamples, kSampleRate, 0.0f),
+      Slice(kSamples, kSampleRate, 1.0f),
+  };
+
+  const auto process = [&](Engine& engine, Instrument& instrument) {
+    instrument.SetNoteOn(0.0f);
+    std::array<float, kFrameCount> output_samples = {};
+    engine.Process(output_samples.data(), 1, kFrameCount, 0.0);
+    return output_samples;
+  };
+
+  Engine engine(kSampleRate);
+  auto instrument = engine.CreateInstrument();
+  instrument.SetSampleData(kSlices);
+  const auto output_samples = process(engine, instrument);
+  EXPECT_NE(output_samples, (std::array<float, kFrameCount>{}));
+
+  // Instruments across engines should share the bank, and play it the same as the sample data.
+  SampleBank sample_bank(kSlices);
+  EXPECT_EQ(sample_bank.GetReferenceCount(), 0);
+  std::array<Engine, 2> engines = {Engine(kSampleRate), Engine(kSampleRate)};
+  for (auto& bank_engine : engines) {
+    auto bank_instrument = bank_engine.CreateInstrument();
+    bank_instrument.SetSampleBank(sample_bank);
+    EXPECT_EQ(process(bank_engine, bank_instrument), output_samples);
+  }
+  EXPECT_EQ(sample_bank.GetReferenceCount(), 2);
+
+  // The bank should not be destroyed while it is referenced.
+  EXPECT_FALSE(BarelySampleBank_Destroy(sample_bank));
+
+  // Replacing the sample data, or destroying the engine, should release the references.
+  auto bank_instrument = engines[0].CreateInstrument();
+  bank_instrument.SetSampleBank(sample_bank);
+  EXPECT_EQ(sample_bank.GetReferenceCount(), 3);
+  bank_instrument.SetSampleData({});
+  EXPECT_EQ(sample_bank.GetReferenceCount(), 2);
+  bank_instrument.Destroy();
+  engines[1] = Engine(kSampleRate);
+  EXPECT_EQ(sample_bank.GetReferenceCount(), 1);
+  engines[0] = Engine(kSampleRate);
+  EXPECT_EQ(sample_bank.GetReferenceCount(), 0);
+
+  // The engine should keep the bank alive while it is referenced, even after it is destroyed.
+  auto scoped_instrument = engines[0].CreateInstrument();
+  {
+    SampleBank scoped_sample_bank(kSlices);
+    scoped_instrument.SetSampleBank(scoped_sample_bank);
+    scoped_sample_bank = std::move(sample_bank);
+    EXPECT_EQ(scoped_sample_bank.GetReferenceCount(), 0);
+    EXPECT_EQ(static_cast<BarelySampleBank*>(sample_bank), nullptr);
+  }
+  EXPECT_EQ(process(engines[0], scoped_instrument), output_samples);
+}
+
+TEST(EngineTest, PlayRenderCache) {
+  constexpr int kChannelCount = 2;
+  constexpr int kFrameCount = 32;
+  constexpr int kNoteCount = 3;
+  constexpr int kSliceSampleCount = 16;
+  std::array<float, kSliceSampleCount> slice_samples = {};
+  for (int i = 0; i < kSliceSampleCount; ++i) {
+    slice_samples[i] = static_cast<float>(i + 1) / static_cast<float>(kSliceSampleCount);
+  }
+  const std::array<Slice, 1> kSlices = {Slice(slice_samples, kSampleRate, 0.0f)};
+
+  const auto render = [&](bool is_render_cache_enabled) {
+    EngineConfig config(kSampleRate);
+    config.render_cache_frame_count = kFrameCount;
+    Engine engine(config);
+
+    auto instrument = engine.CreateInstrument();
+    instrument.SetControl(InstrumentControlType::kSliceMode, SliceMode::kOnce);
+    instrument.SetControl(InstrumentControlType::kOscMix, 0.5f);
+    instrument.SetControl(InstrumentControlType::kFilterCutoff, 0.5f);
+    instrument.SetControl(InstrumentControlType::kRenderCache, is_render_cache_enabled);
+    instrument.SetSampleData(kSlices);
+
+    // The first note records the cache, which the next notes play back with their own gain and pan.
+    std::array<float, kNoteCount * kChannelCount * kFrameCount> output_samples = {};
+    for (int i = 0; i < kNoteCount; ++i) {
+      instrument.SetControl(InstrumentControlType::kStereoPan, 0.5f * static_cast<float>(i - 1));
+      instrument.SetNoteOn(0.0f, 1.0f / static_cast<float>(i + 1));
+      engine.Process(&output_samples[i * kChannelCount * kFrameCount], kChannelCount, kFrameCount,
+                     0.0);
+    }
+    return output_samples;
+  };
+
+  const auto output_samples = render(true);
+  const auto expected_output_samples = render(false);
+  EXPECT_NE(expected_output_samples, (std::array<float, output_samples.size()>{}));
+  for (int i = 0; i < static_cast<int>(output_samples.size()); ++i) {
+    EXPECT_FLOAT_EQ(output_samples[i], expected_output_samples[i]) << i;
+  }
+}
+
+TEST(EngineTest, FreezeInstrument) {
+  constexpr int kFreezeSampleRate = 1000;
+  constexpr int kFrameCount = 50;
+  constexpr int kLoopFrameCount = 500;  // half a beat at 60 beats per minute
+  constexpr int kLoopCount = 6;
+
+  struct Player {
+    explicit Player(EngineConfig config) : engine(config) {
+      engine.SetTempo(60.0);
+      instrument = engine.CreateInstrument();
+      instrument.SetControl(InstrumentControlType::kOscMix, 1.0f);
+      instrument.SetControl(InstrumentControlType::kOscShape, 0.5f);
+      instrument.SetControl(InstrumentControlType::kReverbSend, 0.25f);
+      performer = engine.CreatePerformer();
+      performer.SetLooping(true);
+      performer.SetLoopLength(0.5);
+      const std::array<Note, 2> notes = {Note(0.0, 0.25, 0.0f), Note(0.125, 0.0625, 1.0f)};
+      performer.CreateClip(instrument, notes, tasks);
+      performer.Start();
+    }
+
+    std::array<float, kFrameCount> Process(int frame) noexcept {
+      std::array<float, kFrameCount> output_samples = {};
+      engine.UpdateAndProcess(output_samples.data(), 1, kFrameCount,
+                              static_cast<double>(frame) / kFreezeSampleRate);
+      return output_samples;
+    }
+
+    Engine engine;
+    Instrument instrument;
+    Performer performer;
+    std::array<Task, 2> tasks;
+  };
+
+  EngineConfig config(kFreezeSampleRate);
+  config.freeze_frame_count = kLoopFrameCount;
+  Player player(config);
+  Player live_player(config);
+
+  // The performer needs to be playing in a loop, and the loop needs to fit into the freeze frames.
+  player.performer.SetLoopLength(1.0);
+  EXPECT_FALSE(player.instrument.Freeze(player.performer));
+  player.performer.SetLoopLength(0.5);
+  player.performer.SetLooping(false);
+  EXPECT_FALSE(player.instrument.Freeze(player.performer));
+  player.performer.SetLooping(true);
+  EXPECT_FALSE(player.instrument.IsFrozen());
+
+  for (int frame = 0; frame < kLoopCount * kLoopFrameCount; frame += kFrameCount) {
+    if (frame == kLoopFrameCount) {
+      // Freeze after the first loop, which records the second loop and plays it back afterwards.
+      EXPECT_TRUE(player.instrument.Freeze(player.performer));
+      EXPECT_TRUE(player.instrument.IsFrozen());
+    } else if (frame == (kLoopCount - 1) * kLoopFrameCount + 400) {
+      // Thaw once the notes are done, which plays the next loop live again.
+      player.instrument.SetControl(InstrumentControlType::kGain, 0.5f);
+      live_player.instrument.SetControl(InstrumentControlType::kGain, 0.5f);
+      EXPECT_FALSE(player.instrument.IsFrozen());
+    }
+    const auto output_samples = player.Process(frame);
+    const auto live_output_samples = live_player.Process(frame);
+    for (int i = 0; i < kFrameCount; ++i) {
+      EXPECT_FLOAT_EQ(output_samples[i], live_output_samples[i]) << frame + i;
+    }
+
+    // The frozen notes are played back without any voices.
+    if (frame % kLoopFrameCount == 100) {
+      EXPECT_GT(live_player.engine.GetUsage().voices.active_count, 0);
+      EXPECT_EQ(player.engine.GetUsage().voices.active_count,
+                (frame >= 2 * kLoopFrameCount && player.instrument.IsFrozen())
+                    ? 0
+                    : live_player.engine.GetUsage().voices.active_count);
+    }
+  }
+}
+
+TEST(EngineTest, EngineGroupProcess) {
+  constexpr int kEngineCount = 8;
+  constexpr int kFrameCount = 64;
+  constexpr int kBlockCount = 4;
+
+  // Failures.
+  EXPECT_TRUE(BarelyEngineGroup_Create(-1, nullptr, nullptr, 0) == nullptr);
+  EXPECT_TRUE(BarelyEngineGroup_Create(1, nullptr, nullptr, 0) == nullptr);
+
+  const auto create_engines = [&]() {
+    std::vector<Engine> engines;
+    for (int i = 0; i < kEngineCount; ++i) {
+      auto& engine = engines.emplace_back(kSampleRate);
+      auto instrument = engine.CreateInstrument();
+      instrument.SetControl(InstrumentControlType::kOscMix, 1.0f);
+      instrument.SetNoteOn(static_cast<float>(i) / 12.0f);
+    }
+    return engines;
+  };
+
+  // The group should match processing each engine in order.
+  auto engines = create_engines();
+  auto group_engines = create_engines();
+  EngineGroup engine_group(3);
+
+  std::vector<float> output_samples(kEngineCount * kFrameCount);
+  std::vector<float> group_output_samples(kEngineCount * kFrameCount);
+  std::vector<EngineProcessJob> jobs;
+  for (int block = 0; block < kBlockCount; ++block) {
+    const double timestamp = static_cast<double>(block * kFrameCount) / kSampleRate;
+    jobs.clear();
+    for (int i = 0; i < kEngineCount; ++i) {
+      engines[i].Process(&output_samples[i * kFrameCount], 1, kFrameCount, timestamp);
+      jobs.emplace_back(group_engines[i], &group_output_samples[i * kFrameCount], timestamp);
+    }
+    if (block == kBlockCount / 2) {
+      // Replacing the group should stop its workers before the new ones take over.
+      engine_group = EngineGroup(2);
+    }
+    engine_group.Process(jobs, 1, kFrameCount);
+    EXPECT_EQ(group_output_samples, output_samples) << block;
+  }
+
+  // Invalid output sizes should leave the output samples as is.
+  engine_group.Process(jobs, 0, kFrameCount);
+  engine_group.Process(jobs, 1, 0);
+  EXPECT_EQ(group_output_samples, output_samples);
+}
+
+TEST(EngineTest, GetUsage) {
+  EngineConfig config(kSampleRate);
+  config.max_voice_count = 4;
+  Engine engine(config);
+
+  BarelyEngineUsage usage = engine.GetUsage();
+  EXPECT_EQ(usage.instruments.active_count, 0);
+  EXPECT_EQ(usage.instruments.capacity, config.max_instrument_count);
+  EXPECT_EQ(usage.voices.capacity, config.max_voice_count);
+
+  auto instrument = engine.CreateInstrument();
+  auto performer = engine.CreatePerformer();
+  auto task = performer.CreateTask(0.0, 1.0, 0, [](TaskEventType) {});
+  for (const float pitch : {0.0f, 1.0f, 2.0f}) {
+    instrument.SetNoteOn(pitch);
+  }
+  usage = engine.GetUsage();
+  EXPECT_EQ(usage.instruments.active_count, 1);
+  EXPECT_EQ(usage.performers.active_count, 1);
+  EXPECT_EQ(usage.tasks.active_count, 1);
+  EXPECT_EQ(usage.commands.active_count, 4);
+  EXPECT_EQ(usage.voices.active_count, 0);
+
+  // Voices should be published after processing, which also drains the commands.
+  std::array<float, 1> output_samples;
+  engine.Process(output_samples.data(), 1, 1, 0.0);
+  usage = engine.GetUsage();
+  EXPECT_EQ(usage.commands.active_count, 0);
+  EXPECT_EQ(usage.commands.max_active_count, 4);
+  EXPECT_EQ(usage.voices.active_count, 3);
+  EXPECT_EQ(usage.voices.max_active_count, 3);
+
+  // High-water marks should remain after releasing.
+  task.Destroy();
+  usage = engine.GetUsage();
+  EXPECT_EQ(usage.tasks.active_count, 0);
+  EXPECT_EQ(usage.tasks.max_active_count, 1);
+}
+
+TEST(EngineTest, UpdateWithTaskEvents) {
+  Engine engine(kSampleRate);
+  engine.SetTempo(60.0);
+  auto performer = engine.CreatePerformer();
+
+  int callback_count = 0;
+  std::vector<Task> tasks;
+  for (const double position : {0.0, 1.0, 2.0}) {
+    tasks.push_back(
+        performer.CreateTask(position, 0.5, 0, [&](TaskEventType) { ++callback_count; }));
+  }
+  performer.Start();
+
+  // Task events should be returned in order instead of their callbacks, where the update stops at
+  // the timestamp of each batch.
+  std::array<BarelyTaskEvent, 4> task_events;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_EQ(engine.UpdateWithTaskEvents(1.75, task_events), 1);
+    EXPECT_EQ(task_events[0].task_id, tasks[i / 2]);
+    EXPECT_EQ(task_events[0].type,
+              (i % 2 == 0) ? BarelyTaskEventType_kBegin : BarelyTaskEventType_kEnd);
+    EXPECT_DOUBLE_EQ(task_events[0].position, 0.5 * static_cast<double>(i));
+    EXPECT_DOUBLE_EQ(task_events[0].timestamp, 0.5 * static_cast<double>(i));
+    EXPECT_DOUBLE_EQ(engine.GetTimestamp(), 0.5 * static_cast<double>(i));
+  }
+  EXPECT_EQ(engine.UpdateWithTaskEvents(1.75, task_events), 0);
+  EXPECT_DOUBLE_EQ(engine.GetTimestamp(), 1.75);
+  EXPECT_EQ(callback_count, 0);
+}
+
+TEST(EngineTest, UpdateWithTaskEventsFull) {
+  Engine engine(kSampleRate);
+  engine.SetTempo(60.0);
+  auto performer = engine.CreatePerformer();
+
+  std::vector<std::pair<int, TaskEventType>> callback_events;
+  const auto create_task = [&](double position, int i) {
+    return performer.CreateTask(position, 0.25, 0, [&callback_events, i](TaskEventType type) {
+      callback_events.emplace_back(i, type);
+    });
+  };
+  const std::array<Task, 2> tasks = {create_task(0.5, 0), create_task(0.75, 1)};
+  performer.Start();
+
+  // The update should stop once the array is full, and resume from the next task event.
+  const std::array<std::pair<int, BarelyTaskEventType>, 4> expected_task_events = {
+      std::pair(0, BarelyTaskEventType_kBegin),
+      std::pair(0, BarelyTaskEventType_kEnd),
+      std::pair(1, BarelyTaskEventType_kBegin),
+      std::pair(1, BarelyTaskEventType_kEnd),
+  };
+  std::array<BarelyTaskEvent, 1> task_events;
+  for (const auto& [i, type] : expected_task_events) {
+    ASSERT_EQ(engine.UpdateWithTaskEvents(1.0, task_events), 1);
+    EXPECT_EQ(task_events[0].task_id, tasks[i]);
+    EXPECT_EQ(task_events[0].type, type);
+    EXPECT_DOUBLE_EQ(task_events[0].timestamp, task_events[0].position);
+  }
+  EXPECT_EQ(engine.UpdateWithTaskEvents(1.0, task_events), 0);
+  EXPECT_DOUBLE_EQ(engine.GetTimestamp(), 1.0);
+  EXPECT_TRUE(callback_events.empty());
+
+  // Callbacks should be processed for the task events at once that do not fit, which is reported.
+  const std::array<Task, 2> overlapping_tasks = {create_task(1.5, 2), create_task(1.5, 3)};
+  ASSERT_EQ(engine.UpdateWithTaskEvents(1.75, task_events), 2);
+  EXPECT_EQ(task_events[0].task_id, overlapping_tasks[0]);
+  EXPECT_EQ(task_events[0].type, BarelyTaskEventType_kBegin);
+  ASSERT_EQ(callback_events.size(), 1);
+  EXPECT_EQ(callback_events[0], std::pair(3, TaskEventType::kBegin));
+}
+
+TEST(EngineTest, UpdateWithTaskEventsSetNoteOn) {
+  constexpr int kFrameCount = 256;
+  constexpr int kNoteFrame = 100;
+
+  Engine engine(kSampleRate);
+  engine.SetTempo(60.0);
+  engine.SetControl(EngineControlType::kDelayMix, 0.0f);
+  engine.SetControl(EngineControlType::kReverbMix, 0.0f);
+
+  auto instrument = engine.CreateInstrument();
+  instrument.SetControl(InstrumentControlType::kOscMix, 1.0f);
+  instrument.SetControl(InstrumentControlType::kOscShape, 1.0f);
+
+  auto performer = engine.CreatePerformer();
+  [[maybe_unused]] auto task = performer.CreateTask(
+      static_cast<double>(kNoteFrame) / kSampleRate, 1.0, 0, [](TaskEventType) {});
+  performer.Start();
+
+  // Notes set while processing the task events should get scheduled at their timestamps.
+  std::array<BarelyTaskEvent, 4> task_events;
+  while (const int32_t task_event_count = engine.UpdateWithTaskEvents(
+             static_cast<double>(kFrameCount) / kSampleRate, task_events)) {
+    ASSERT_EQ(task_event_count, 1);
+    ASSERT_EQ(task_events[0].type, BarelyTaskEventType_kBegin);
+    instrument.SetNoteOn(0.0f);
+  }
+  std::array<float, kFrameCount> output_samples;
+  engine.Process(output_samples.data(), 1, kFrameCount, 0.0);
+  for (int i = 0; i < kFrameCount; ++i) {
+    if (i <= kNoteFrame) {
+      EXPECT_FLOAT_EQ(output_samples[i], 0.0f) << i;
+    } else {
+      EXPECT_NE(output_samples[i], 0.0f) << i;
+    }
+  }
+}
+
+TEST(EngineTest, CreateTasks) {
+  Engine engine(kSampleRate);
+  engine.SetTempo(60.0);
+  auto performer = engine.CreatePerformer();
+
+  std::vector<int> begin_task_indices;
+  std::array<TaskDesc, 4> task_descs;
+  for (int i = 0; i < static_cast<int>(task_descs.size()); ++i) {
+    // Tasks at the same position keep their creation order.
+    task_descs[i] = {static_cast<double>(3 - i) / 2, 0.25, 0,
+                     [&, i](TaskEventType type) {
+                       if (type == TaskEventType::kBegin) {
+                         begin_task_indices.push_back(i);
+                       }
+                     }};
+  }
+  task_descs[0].position = 0.5;
+  std::array<Task, 4> tasks;
+  performer.CreateTasks(task_descs, tasks);
+  for (const auto& task : tasks) {
+    EXPECT_NE(task, 0);
+  }
+
+  performer.Start();
+  engine.Update(2.0);
+  EXPECT_EQ(begin_task_indices, (std::vector<int>{3, 0, 2, 1}));
+
+  tasks[0].Destroy();
+  performer.Destroy();
+}
+
 TEST(EngineTest, CreateDestroynstrument) {
   Engine engine(kSampleRate);
   engine.CreateInstrument().Destroy();
@@ -84,6 +906,40 @@ TEST(EngineTest, GenerateRandomNumber) {
   }
 }
 
+TEST(EngineTest, RenderDeterministically) {
+  constexpr int kFrameCount = 64;
+
+  const auto render = [&](int32_t seed, bool has_other_note) {
+    EngineConfig config(kSampleRate);
+    config.seed = seed;
+    Engine engine(config);
+
+    std::array<Instrument, 2> instruments = {engine.CreateInstrument(), engine.CreateInstrument()};
+    for (auto& instrument : instruments) {
+      instrument.SetControl(InstrumentControlType::kOscMix, 1.0f);
+      instrument.SetControl(InstrumentControlType::kOscNoiseMix, 1.0f);
+    }
+    instruments[1].SetControl(InstrumentControlType::kGain, 0.0f);
+    if (has_other_note) {
+      instruments[1].SetNoteOn(1.0f);
+    }
+    instruments[0].SetNoteOn(0.0f);
+
+    std::array<float, kFrameCount> output_samples = {};
+    engine.Process(output_samples.data(), 1, kFrameCount, 0.0);
+    return output_samples;
+  };
+
+  // The same seed should render the same output.
+  const auto output_samples = render(1, false);
+  EXPECT_NE(output_samples, (std::array<float, kFrameCount>{}));
+  EXPECT_EQ(render(1, false), output_samples);
+  EXPECT_NE(render(2, false), output_samples);
+
+  // The noise of a voice should not depend on the other voices that are processed before it.
+  EXPECT_EQ(render(1, true), output_samples);
+}
+
 TEST(EngineTest, ResetSeed) {
   constexpr int kSeed = 1;
   constexpr int kValueCount = 10;
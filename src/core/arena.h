@@ -1,6 +1,7 @@
 #ifndef BARELYMUSICIAN_CORE_ARENA_H_
 #define BARELYMUSICIAN_CORE_ARENA_H_
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -8,16 +9,28 @@
 
 namespace barely {
 
+// Cache line size in bytes to keep the data written by different threads apart.
+inline constexpr size_t kCacheLineSize = 64;
+
+// Page size in bytes to align the large buffers to.
+inline constexpr size_t kPageSize = 4096;
+
 constexpr size_t AlignUp(size_t value, size_t alignment) noexcept {
   return (value + alignment - 1) & ~(alignment - 1);
 }
 
+// Returns the alignment of a buffer with a given size, which starts a new page if it spans at least
+// one, or a new cache line otherwise.
+constexpr size_t GetBufferAlignment(size_t size) noexcept {
+  return (size >= kPageSize) ? kPageSize : kCacheLineSize;
+}
+
 class Arena {
  public:
   Arena() noexcept = default;  // null arena for fetching size.
   Arena(void* data, size_t size) noexcept {
     const size_t unaligned_address = reinterpret_cast<size_t>(data);
-    const size_t aligned_address = AlignUp(unaligned_address, alignof(std::max_align_t));
+    const size_t aligned_address = AlignUp(unaligned_address, kCacheLineSize);
     const size_t adjustment = aligned_address - unaligned_address;
 
     assert(adjustment <= size);
@@ -27,7 +40,14 @@ class Arena {
   }
 
   [[nodiscard]] void* Alloc(size_t size, size_t alignment) noexcept {
-    const size_t aligned_offset = AlignUp(offset_, alignment);
+    // The head is only aligned to a cache line, so the sizing arena reserves the worst case padding
+    // of the larger alignments.
+    const size_t head_address = reinterpret_cast<size_t>(head_);
+    const size_t aligned_offset =
+        (head_ != nullptr)
+            ? AlignUp(head_address + offset_, alignment) - head_address
+            : AlignUp(offset_, std::min(alignment, kCacheLineSize)) +
+                  (alignment - std::min(alignment, kCacheLineSize));
     const size_t next_offset = aligned_offset + size;
     assert(head_ == nullptr || next_offset <= capacity_);
 
@@ -41,8 +61,9 @@ class Arena {
   }
 
   template <typename T>
-  T* AllocArray(size_t count) noexcept {
-    T* array = static_cast<T*>(Alloc(sizeof(T) * count, alignof(T)));
+  T* AllocArray(size_t count, size_t alignment = alignof(T)) noexcept {
+    assert(alignment >= alignof(T));
+    T* array = static_cast<T*>(Alloc(sizeof(T) * count, alignment));
     if (array != nullptr) {
       for (size_t i = 0; i < count; ++i) {
         ::new (&array[i]) T();
@@ -51,6 +72,18 @@ class Arena {
     return array;
   }
 
+  // Allocates an array that does not share its cache lines, or pages if large, with other data.
+  template <typename T>
+  T* AllocBuffer(size_t count) noexcept {
+    if (count == 0) {
+      return nullptr;
+    }
+    const size_t size = AlignUp(sizeof(T) * count, kCacheLineSize);
+    T* array = AllocArray<T>(count, std::max(GetBufferAlignment(size), alignof(T)));
+    offset_ = AlignUp(offset_, kCacheLineSize);  // pad out the last cache line.
+    return array;
+  }
+
   [[nodiscard]] bool is_null() const noexcept { return head_ == nullptr; }
   [[nodiscard]] size_t offset() const noexcept { return offset_; }
 
@@ -65,7 +98,7 @@ template <typename T, typename... Args>
   Arena arena;  // sizing arena
   arena.Alloc<T>();
   T(arena, args...);
-  return AlignUp(arena.offset(), alignof(std::max_align_t)) + alignof(std::max_align_t);
+  return AlignUp(arena.offset(), kCacheLineSize) + kCacheLineSize;
 }
 
 }  // namespace barely
@@ -0,0 +1,46 @@
+#include "core/arena.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "gtest/gtest.h"
+
+namespace barely {
+namespace {
+
+struct TestBuffers {
+  TestBuffers(Arena& arena, size_t count) noexcept
+      : small(arena.AllocArray<uint8_t>(1)),
+        cache_line_buffer(arena.AllocBuffer<float>(count)),
+        shared(arena.AllocArray<uint8_t>(1)),
+        page_buffer(arena.AllocBuffer<float>(kPageSize)) {}
+
+  uint8_t* small = nullptr;
+  float* cache_line_buffer = nullptr;
+  uint8_t* shared = nullptr;
+  float* page_buffer = nullptr;
+};
+
+TEST(ArenaTest, AllocBuffer) {
+  constexpr size_t kCount = 3;
+
+  // Offset the allocation to check against an unaligned data pointer.
+  const auto size = GetAllocSize<TestBuffers>(kCount);
+  auto data = std::make_unique<std::byte[]>(size + 1);
+  Arena arena(data.get() + 1, size);
+
+  const TestBuffers& buffers = *::new (arena.Alloc<TestBuffers>()) TestBuffers(arena, kCount);
+  EXPECT_LE(arena.offset(), size);
+
+  const auto get_address = [](const void* ptr) { return reinterpret_cast<size_t>(ptr); };
+  EXPECT_EQ(get_address(buffers.cache_line_buffer) % kCacheLineSize, 0);
+  EXPECT_EQ(get_address(buffers.page_buffer) % kPageSize, 0);
+
+  // The data after a buffer should start on a new cache line.
+  EXPECT_EQ(get_address(buffers.shared) % kCacheLineSize, 0);
+  EXPECT_GE(get_address(buffers.shared), get_address(buffers.cache_line_buffer + kCount));
+}
+
+}  // namespace
+}  // namespace barely
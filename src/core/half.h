@@ -0,0 +1,70 @@
+#ifndef BARELYMUSICIAN_CORE_HALF_H_
+#define BARELYMUSICIAN_CORE_HALF_H_
+
+#include <bit>
+#include <cstdint>
+
+namespace barely {
+
+// Returns the IEEE 754 half precision bits of a value, rounded to the nearest even.
+constexpr uint16_t FloatToHalfBits(float value) noexcept {
+  constexpr uint32_t kInfinityBits = 255u << 23;
+  constexpr uint32_t kMaxBits = (127u + 16u) << 23;
+  constexpr uint32_t kMinNormalBits = 113u << 23;
+  constexpr uint32_t kSubnormalMagicBits = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+  uint32_t bits = std::bit_cast<uint32_t>(value);
+  const uint32_t sign = bits & 0x80000000u;
+  bits ^= sign;
+
+  uint32_t half_bits = 0;
+  if (bits >= kMaxBits) {
+    half_bits = (bits > kInfinityBits) ? 0x7E00u : 0x7C00u;
+  } else if (bits < kMinNormalBits) {
+    // Let the floating-point addition round the subnormal mantissa.
+    half_bits = std::bit_cast<uint32_t>(std::bit_cast<float>(bits) +
+                                        std::bit_cast<float>(kSubnormalMagicBits)) -
+                kSubnormalMagicBits;
+  } else {
+    const uint32_t is_mantissa_odd = (bits >> 13) & 1u;
+    bits += (static_cast<uint32_t>(15 - 127) << 23) + 0xFFFu + is_mantissa_odd;
+    half_bits = bits >> 13;
+  }
+  return static_cast<uint16_t>(half_bits | (sign >> 16));
+}
+
+// Returns the value of IEEE 754 half precision bits.
+constexpr float HalfBitsToFloat(uint16_t half_bits) noexcept {
+  constexpr uint32_t kExponentBits = 0x7C00u << 13;
+
+  uint32_t bits = (half_bits & 0x7FFFu) << 13;
+  const uint32_t exponent = bits & kExponentBits;
+  bits += (127u - 15u) << 23;
+  if (exponent == kExponentBits) {
+    bits += (128u - 16u) << 23;  // infinity or nan
+  } else if (exponent == 0) {
+    bits = std::bit_cast<uint32_t>(std::bit_cast<float>(bits + (1u << 23)) -
+                                   std::bit_cast<float>(113u << 23));
+  }
+  return std::bit_cast<float>(bits | (static_cast<uint32_t>(half_bits & 0x8000u) << 16));
+}
+
+#if defined(__FLT16_MAX__)
+// Half precision sample, which converts with the native instructions where available.
+using Half = _Float16;
+
+inline Half FloatToHalf(float value) noexcept { return static_cast<Half>(value); }
+inline float HalfToFloat(Half value) noexcept { return static_cast<float>(value); }
+#else   // defined(__FLT16_MAX__)
+// Half precision sample, which converts in software.
+using Half = uint16_t;
+
+inline Half FloatToHalf(float value) noexcept { return FloatToHalfBits(value); }
+inline float HalfToFloat(Half value) noexcept { return HalfBitsToFloat(value); }
+#endif  // defined(__FLT16_MAX__)
+
+static_assert(sizeof(Half) == 2);
+
+}  // namespace barely
+
+#endif  // BARELYMUSICIAN_CORE_HALF_H_
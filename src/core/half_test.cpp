@@ -0,0 +1,55 @@
+#include "core/half.h"
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "gtest/gtest.h"
+
+namespace barely {
+namespace {
+
+TEST(HalfTest, FloatHalfBitsConversion) {
+  constexpr int kValueCount = 8;
+  constexpr std::array<float, kValueCount> kValues = {
+      0.0f, 1.0f, -2.0f, 0.5f, 65504.0f, 6.103515625e-5f, 5.9604645e-8f, -0.333251953125f,
+  };
+  constexpr std::array<uint16_t, kValueCount> kHalfBits = {
+      0x0000, 0x3C00, 0xC000, 0x3800, 0x7BFF, 0x0400, 0x0001, 0xB555,
+  };
+
+  for (int i = 0; i < kValueCount; ++i) {
+    EXPECT_EQ(FloatToHalfBits(kValues[i]), kHalfBits[i]) << i;
+    EXPECT_FLOAT_EQ(HalfBitsToFloat(kHalfBits[i]), kValues[i]) << i;
+  }
+}
+
+TEST(HalfTest, FloatHalfBitsRounding) {
+  // Ties round to the nearest even mantissa.
+  EXPECT_EQ(FloatToHalfBits(1.0f + std::ldexp(1.0f, -11)), 0x3C00);
+  EXPECT_EQ(FloatToHalfBits(1.0f + 3.0f * std::ldexp(1.0f, -11)), 0x3C02);
+
+  // Out of range values saturate to infinity, and nan stays nan.
+  EXPECT_EQ(FloatToHalfBits(1e6f), 0x7C00);
+  EXPECT_EQ(FloatToHalfBits(-std::numeric_limits<float>::infinity()), 0xFC00);
+  // Check the nan bits directly, since the library flags let the compiler fold `std::isnan`.
+  const uint16_t nan_bits = FloatToHalfBits(std::numeric_limits<float>::quiet_NaN());
+  EXPECT_EQ(nan_bits & 0x7C00, 0x7C00);
+  EXPECT_NE(nan_bits & 0x03FF, 0);
+
+  // Values below the smallest subnormal flush to zero.
+  EXPECT_EQ(FloatToHalfBits(1e-9f), 0x0000);
+}
+
+TEST(HalfTest, FloatHalfRoundTrip) {
+  for (int i = -1000; i <= 1000; ++i) {
+    const float value = 0.001f * static_cast<float>(i);
+    EXPECT_NEAR(HalfToFloat(FloatToHalf(value)), value, std::abs(value) * 0x1p-11f) << value;
+    EXPECT_FLOAT_EQ(HalfToFloat(FloatToHalf(value)), HalfBitsToFloat(FloatToHalfBits(value)))
+        << value;
+  }
+}
+
+}  // namespace
+}  // namespace barely
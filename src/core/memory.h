@@ -0,0 +1,56 @@
+#ifndef BARELYMUSICIAN_CORE_MEMORY_H_
+#define BARELYMUSICIAN_CORE_MEMORY_H_
+
+#include <cstddef>
+
+#include "core/arena.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/mman.h>
+#endif  // defined(__linux__) || defined(__APPLE__)
+
+namespace barely {
+
+// Advises transparent huge pages for the whole pages within a memory range.
+inline bool AdviseHugePages([[maybe_unused]] void* data, [[maybe_unused]] size_t size) noexcept {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  const size_t begin = AlignUp(reinterpret_cast<size_t>(data), kPageSize);
+  const size_t end = (reinterpret_cast<size_t>(data) + size) & ~(kPageSize - 1);
+  return begin < end &&
+         madvise(reinterpret_cast<void*>(begin),  // NOLINT(performance-no-int-to-ptr)
+                 end - begin, MADV_HUGEPAGE) == 0;
+#else   // defined(__linux__) && defined(MADV_HUGEPAGE)
+  return false;
+#endif  // defined(__linux__) && defined(MADV_HUGEPAGE)
+}
+
+// Locks a memory range in physical memory.
+inline bool LockMemory([[maybe_unused]] void* data, [[maybe_unused]] size_t size) noexcept {
+#if defined(__linux__) || defined(__APPLE__)
+  return mlock(data, size) == 0;
+#else   // defined(__linux__) || defined(__APPLE__)
+  return false;
+#endif  // defined(__linux__) || defined(__APPLE__)
+}
+
+// Unlocks a memory range that was locked in physical memory.
+inline void UnlockMemory([[maybe_unused]] void* data, [[maybe_unused]] size_t size) noexcept {
+#if defined(__linux__) || defined(__APPLE__)
+  munlock(data, size);
+#endif  // defined(__linux__) || defined(__APPLE__)
+}
+
+// Writes to every page of a memory range, so that they are mapped before the audio thread runs.
+inline void PrefaultMemory(void* data, size_t size) noexcept {
+  volatile std::byte* bytes = static_cast<std::byte*>(data);
+  for (size_t i = 0; i < size; i += kPageSize) {
+    bytes[i] = std::byte{0};
+  }
+  if (size > 0) {
+    bytes[size - 1] = std::byte{0};
+  }
+}
+
+}  // namespace barely
+
+#endif  // BARELYMUSICIAN_CORE_MEMORY_H_
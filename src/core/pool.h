@@ -16,14 +16,13 @@ template <typename ItemType>
 class Pool {
  public:
   Pool(Arena& arena, uint32_t count) noexcept
-      : items_(arena.AllocArray<ItemType>(count)),
+      : items_(arena.AllocBuffer<ItemType>(count)),
         to_active_(arena.AllocArray<uint32_t>(count)),
         active_(arena.AllocArray<uint32_t>(count)),
         free_(arena.AllocArray<uint32_t>(count)) {
-    if (arena.is_null()) {
+    if (arena.is_null() || count == 0) {
       return;
     }
-    assert(count > 0);
     assert(count != kInvalidIndex);
     count_ = count;
     std::fill_n(to_active_, count_, kInvalidIndex);
@@ -44,6 +43,7 @@ class Pool {
       assert(to_active_[index] == kInvalidIndex);
       to_active_[index] = active_count_;
       active_[active_count_++] = index;
+      max_active_count_ = std::max(max_active_count_, active_count_);
 
       return index;
     }
@@ -68,6 +68,10 @@ class Pool {
 
   [[nodiscard]] uint32_t ActiveCount() const noexcept { return active_count_; }
 
+  [[nodiscard]] uint32_t Count() const noexcept { return count_; }
+
+  [[nodiscard]] uint32_t MaxActiveCount() const noexcept { return max_active_count_; }
+
   [[nodiscard]] bool CanAcquire() const noexcept { return active_count_ < count_; }
 
   [[nodiscard]] bool IsActive(uint32_t index) const noexcept {
@@ -89,6 +93,38 @@ class Pool {
     return active_[active_index];
   }
 
+  [[nodiscard]] uint32_t GetActiveIndex(uint32_t index) const noexcept {
+    assert(IsActive(index));
+    return to_active_[index];
+  }
+
+  // Moves the items into the larger arrays of another pool, keeping their indices, and takes over
+  // those arrays.
+  void Extend(Pool& other) noexcept {
+    assert(other.count_ > count_);
+    assert(other.active_count_ == 0);
+    std::copy_n(items_, count_, other.items_);
+    std::copy_n(to_active_, count_, other.to_active_);
+    std::copy_n(active_, active_count_, other.active_);
+
+    // Keep the order of the free items, followed by the new items.
+    const uint32_t free_count = count_ - active_count_;
+    for (uint32_t i = 0; i < free_count; ++i) {
+      other.free_[i] = free_[(free_read_index_ + i) % count_];
+    }
+    for (uint32_t i = count_; i < other.count_; ++i) {
+      other.free_[free_count + i - count_] = i;
+    }
+    free_read_index_ = 0;
+    free_write_index_ = (free_count + other.count_ - count_) % other.count_;
+
+    items_ = other.items_;
+    to_active_ = other.to_active_;
+    active_ = other.active_;
+    free_ = other.free_;
+    count_ = other.count_;
+  }
+
  private:
   ItemType* items_ = nullptr;
   uint32_t* to_active_ = nullptr;  // maps item index to active index.
@@ -98,6 +134,7 @@ class Pool {
 
   uint32_t count_ = 0;
   uint32_t active_count_ = 0;
+  uint32_t max_active_count_ = 0;  // since construction
 
   uint32_t free_read_index_ = 0;
   uint32_t free_write_index_ = 0;
@@ -39,5 +39,39 @@ TEST(PoolTest, AcquireMax) {
   EXPECT_LT(pool.Acquire(), kCount);
 }
 
+TEST(PoolTest, Extend) {
+  constexpr uint32_t kCount = 3;
+  constexpr uint32_t kNewCount = 5;
+
+  const auto size = GetAllocSize<Pool<int>>(kCount) + GetAllocSize<Pool<int>>(kNewCount);
+  auto data = std::make_unique<std::byte[]>(size);
+  Arena arena(data.get(), size);
+
+  Pool<int> pool(arena, kCount);
+  for (uint32_t i = 0; i < kCount; ++i) {
+    const uint32_t index = pool.Acquire();
+    pool.Get(index) = static_cast<int>(index);
+  }
+  pool.Release(1);
+  EXPECT_EQ(pool.Acquire(), 1);
+  pool.Release(0);
+
+  // Active items should keep their indices and values.
+  Pool<int> new_pool(arena, kNewCount);
+  pool.Extend(new_pool);
+  EXPECT_EQ(pool.Count(), kNewCount);
+  EXPECT_EQ(pool.ActiveCount(), 2);
+  EXPECT_FALSE(pool.IsActive(0));
+  EXPECT_EQ(pool.Get(1), 1);
+  EXPECT_EQ(pool.Get(2), 2);
+
+  // Released item should be acquired first, followed by the new items.
+  EXPECT_EQ(pool.Acquire(), 0);
+  EXPECT_EQ(pool.Acquire(), 3);
+  EXPECT_EQ(pool.Acquire(), 4);
+  EXPECT_EQ(pool.Acquire(), kInvalidIndex);
+  EXPECT_EQ(pool.ActiveCount(), kNewCount);
+}
+
 }  // namespace
 }  // namespace barely
@@ -2,11 +2,26 @@
 #define BARELYMUSICIAN_CORE_RNG_H_
 
 #include <cassert>
+#include <cstdint>
 #include <ctime>
 #include <random>
 
 namespace barely {
 
+// Returns the bits of a value mixed into a hash.
+constexpr uint32_t HashBits(uint32_t value) noexcept {
+  value ^= value >> 16;
+  value *= 0x85EBCA6Bu;
+  value ^= value >> 13;
+  value *= 0xC2B2AE35u;
+  return value ^ (value >> 16);
+}
+
+// Returns a seed that is derived from a given seed and value, e.g. to split independent streams.
+constexpr uint32_t CombineSeed(uint32_t seed, uint32_t value) noexcept {
+  return HashBits(seed ^ (value + 0x9E3779B9u + (seed << 6) + (seed >> 2)));
+}
+
 template <typename EngineType, typename RealType>
 class Rng {
  public:
@@ -38,7 +53,31 @@ class Rng {
   EngineType engine_;
 };
 
-using AudioRng = Rng<std::minstd_rand, float>;
+// Random number generator of the audio thread, which is small enough for each voice to draw from
+// its own stream regardless of the processing order of the voices.
+class AudioRng {
+ public:
+  constexpr AudioRng() noexcept = default;
+  constexpr explicit AudioRng(uint32_t seed) noexcept : state_(seed) {}
+
+  void ResetSeed(uint32_t seed) noexcept { state_ = seed; }
+
+  // Generates a new random number with uniform distribution in the normalized range [0, 1).
+  [[nodiscard]] float Generate() noexcept {
+    state_ = state_ * 1664525u + 1013904223u;
+    return static_cast<float>(HashBits(state_) >> 8) * 0x1p-24f;
+  }
+
+  // Generates a new random number with uniform distribution in the range [min, max).
+  [[nodiscard]] uint32_t Generate(uint32_t min, uint32_t max) noexcept {
+    assert(min <= max);
+    return min + static_cast<uint32_t>(Generate() * static_cast<float>(max - min));
+  }
+
+ private:
+  uint32_t state_ = 0;
+};
+
 using MainRng = Rng<std::mt19937_64, double>;
 
 }  // namespace barely
@@ -0,0 +1,190 @@
+#ifndef BARELYMUSICIAN_CORE_WORKER_POOL_H_
+#define BARELYMUSICIAN_CORE_WORKER_POOL_H_
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+
+#include "core/arena.h"
+#include "core/callback.h"
+
+#if !defined(BARELY_DISABLE_THREADS) && \
+    !(defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__))
+#define BARELY_ENABLE_THREADS
+#include <thread>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif  // defined(__linux__)
+#endif  // !defined(BARELY_DISABLE_THREADS) && ...
+
+namespace barely {
+
+// Job callback, which is called with the job index.
+using JobCallback = Callback<void (*)(uint32_t job_index, void* user_data)>;
+
+// Pool of worker threads, which run the jobs of each batch together with the calling thread.
+//
+// Each participant owns a contiguous range of jobs, so that the same job lands on the same worker
+// across batches and keeps its data warm in that core's cache. A participant that runs out of its
+// own jobs steals the remaining jobs of the others. Without thread support, the calling thread runs
+// all the jobs.
+class WorkerPool {
+ public:
+  WorkerPool(Arena& arena, uint32_t worker_count, const int32_t* worker_cpus) noexcept
+#if defined(BARELY_ENABLE_THREADS)
+      : ranges_(arena.AllocBuffer<Range>(worker_count + 1)),
+        threads_(arena.AllocArray<std::thread>(worker_count)),
+        worker_count_(worker_count) {
+    if (arena.is_null()) {
+      return;
+    }
+    for (uint32_t i = 0; i < worker_count_; ++i) {
+      threads_[i] = std::thread([this, i]() noexcept { RunWorker(i + 1); });
+      if (worker_cpus != nullptr && worker_cpus[i] >= 0) {
+        SetThreadCpu(threads_[i], worker_cpus[i]);
+      }
+    }
+  }
+#else   // defined(BARELY_ENABLE_THREADS)
+  {
+    static_cast<void>(arena);
+    static_cast<void>(worker_count);
+    static_cast<void>(worker_cpus);
+  }
+#endif  // defined(BARELY_ENABLE_THREADS)
+
+  ~WorkerPool() noexcept {
+#if defined(BARELY_ENABLE_THREADS)
+    if (threads_ == nullptr) {
+      return;
+    }
+    is_running_.store(false, std::memory_order_relaxed);
+    batch_.fetch_add(1, std::memory_order_release);
+    batch_.notify_all();
+    for (uint32_t i = 0; i < worker_count_; ++i) {
+      if (threads_[i].joinable()) {
+        threads_[i].join();
+      }
+    }
+    std::destroy_n(threads_, worker_count_);
+#endif  // defined(BARELY_ENABLE_THREADS)
+  }
+
+  // Non-copyable and non-movable.
+  WorkerPool(const WorkerPool& other) noexcept = delete;
+  WorkerPool& operator=(const WorkerPool& other) noexcept = delete;
+  WorkerPool(WorkerPool&& other) noexcept = delete;
+  WorkerPool& operator=(WorkerPool&& other) noexcept = delete;
+
+  // Runs a batch of jobs, and returns once all of them are done. Must be called from a single
+  // thread at a time.
+  void Run(uint32_t job_count, JobCallback callback) noexcept {
+#if defined(BARELY_ENABLE_THREADS)
+    if (worker_count_ == 0 || job_count <= 1) {
+      for (uint32_t i = 0; i < job_count; ++i) {
+        callback(i);
+      }
+      return;
+    }
+
+    const uint32_t participant_count = worker_count_ + 1;
+    for (uint32_t i = 0; i < participant_count; ++i) {
+      ranges_[i].next.store(static_cast<uint32_t>(uint64_t{job_count} * i / participant_count),
+                            std::memory_order_relaxed);
+      ranges_[i].end = static_cast<uint32_t>(uint64_t{job_count} * (i + 1) / participant_count);
+    }
+    callback_ = callback;
+    busy_worker_count_.store(worker_count_, std::memory_order_relaxed);
+    batch_.fetch_add(1, std::memory_order_release);
+    batch_.notify_all();
+
+    RunJobs(0);
+
+    // Wait for the workers to leave the batch, so that none of them can claim a job of the next.
+    uint32_t busy_worker_count = busy_worker_count_.load(std::memory_order_acquire);
+    while (busy_worker_count > 0) {
+      busy_worker_count_.wait(busy_worker_count, std::memory_order_acquire);
+      busy_worker_count = busy_worker_count_.load(std::memory_order_acquire);
+    }
+#else   // defined(BARELY_ENABLE_THREADS)
+    for (uint32_t i = 0; i < job_count; ++i) {
+      callback(i);
+    }
+#endif  // defined(BARELY_ENABLE_THREADS)
+  }
+
+  // Returns the number of worker threads, excluding the calling thread.
+  [[nodiscard]] uint32_t GetWorkerCount() const noexcept {
+#if defined(BARELY_ENABLE_THREADS)
+    return worker_count_;
+#else   // defined(BARELY_ENABLE_THREADS)
+    return 0;
+#endif  // defined(BARELY_ENABLE_THREADS)
+  }
+
+ private:
+#if defined(BARELY_ENABLE_THREADS)
+  // Range of jobs that is owned by a participant, which sits on its own cache line.
+  struct alignas(kCacheLineSize) Range {
+    std::atomic<uint32_t> next = 0;
+    uint32_t end = 0;
+  };
+
+  // Pins a thread to a cpu, which is only a hint where the platform does not support it.
+  static void SetThreadCpu([[maybe_unused]] std::thread& thread,
+                           [[maybe_unused]] int32_t cpu) noexcept {
+#if defined(__linux__) && !defined(__ANDROID__)
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set), &cpu_set);
+#endif  // defined(__linux__) && !defined(__ANDROID__)
+  }
+
+  // Runs the own jobs of a participant first, and then steals the remaining jobs of the others.
+  void RunJobs(uint32_t participant_index) noexcept {
+    const uint32_t participant_count = worker_count_ + 1;
+    for (uint32_t i = 0; i < participant_count; ++i) {
+      Range& range = ranges_[(participant_index + i) % participant_count];
+      for (uint32_t job_index = range.next.fetch_add(1, std::memory_order_relaxed);
+           job_index < range.end; job_index = range.next.fetch_add(1, std::memory_order_relaxed)) {
+        callback_(job_index);
+      }
+    }
+  }
+
+  void RunWorker(uint32_t participant_index) noexcept {
+    uint32_t batch = 0;
+    while (true) {
+      batch_.wait(batch, std::memory_order_acquire);
+      batch = batch_.load(std::memory_order_acquire);
+      if (!is_running_.load(std::memory_order_relaxed)) {
+        return;
+      }
+      RunJobs(participant_index);
+      if (busy_worker_count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        busy_worker_count_.notify_one();
+      }
+    }
+  }
+
+  Range* ranges_ = nullptr;
+  std::thread* threads_ = nullptr;
+  uint32_t worker_count_ = 0;
+
+  JobCallback callback_ = {};
+
+  // Written by the calling thread to start each batch, and read by the workers.
+  alignas(kCacheLineSize) std::atomic<uint32_t> batch_ = 0;
+  std::atomic<bool> is_running_ = true;
+
+  // Written by the workers as they leave each batch, and read by the calling thread.
+  alignas(kCacheLineSize) std::atomic<uint32_t> busy_worker_count_ = 0;
+#endif  // defined(BARELY_ENABLE_THREADS)
+};
+
+}  // namespace barely
+
+#endif  // BARELYMUSICIAN_CORE_WORKER_POOL_H_
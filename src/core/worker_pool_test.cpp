@@ -0,0 +1,42 @@
+#include "core/worker_pool.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "core/arena.h"
+#include "gtest/gtest.h"
+
+namespace barely {
+namespace {
+
+TEST(WorkerPoolTest, Run) {
+  constexpr uint32_t kWorkerCount = 3;
+  constexpr uint32_t kMaxJobCount = 32;
+  constexpr int kBatchCount = 100;
+
+  const auto size = GetAllocSize<WorkerPool>(kWorkerCount, static_cast<const int32_t*>(nullptr));
+  auto data = std::make_unique<std::byte[]>(size);
+  Arena arena(data.get(), size);
+
+  WorkerPool worker_pool(arena, kWorkerCount, nullptr);
+
+  // Each job should run exactly once per batch, and be done by the time the batch returns.
+  std::array<std::atomic<int>, kMaxJobCount> run_counts = {};
+  for (int batch = 0; batch < kBatchCount; ++batch) {
+    const uint32_t job_count = static_cast<uint32_t>(batch) % (kMaxJobCount + 1);
+    worker_pool.Run(job_count, {[](uint32_t job_index, void* user_data) noexcept {
+                                  static_cast<std::atomic<int>*>(user_data)[job_index].fetch_add(
+                                      1, std::memory_order_relaxed);
+                                },
+                                run_counts.data()});
+    for (uint32_t i = 0; i < kMaxJobCount; ++i) {
+      EXPECT_EQ(run_counts[i].exchange(0), (i < job_count) ? 1 : 0) << batch << ", " << i;
+    }
+  }
+}
+
+}  // namespace
+}  // namespace barely
@@ -6,11 +6,13 @@
 #include <bit>
 #include <cassert>
 #include <cmath>
+#include <cstddef>
 #include <vector>
 
 #include "core/arena.h"
 #include "core/constants.h"
 #include "core/control.h"
+#include "dsp/delay_line.h"
 #include "dsp/one_pole_filter.h"
 
 namespace barely {
@@ -41,14 +43,20 @@ struct DelayParams {
 // Delay filter with smooth interpolation.
 class DelayFilter {
  public:
-  DelayFilter(Arena& arena, uint32_t max_frame_count) noexcept
-      : delay_samples_(
-            arena.AllocArray<float>(max_frame_count * static_cast<uint32_t>(kStereoChannelCount))),
+  // Constructs a new `DelayFilter` with a power of two maximum number of frames, or zero to leave
+  // it without a buffer when the delay is bypassed. The compact delay line stores half precision
+  // samples to halve its memory.
+  DelayFilter(Arena& arena, uint32_t max_frame_count, bool is_compact = false) noexcept
+      : delay_samples_(arena, static_cast<size_t>(max_frame_count) * kStereoChannelCount,
+                       is_compact),
         bit_mask_(max_frame_count - 1) {
-    assert(max_frame_count > 0);
-    assert(std::has_single_bit(max_frame_count));
+    assert(max_frame_count == 0 || std::has_single_bit(max_frame_count));
   }
 
+  // Returns the maximum number of frames.
+  [[nodiscard]] uint32_t GetMaxFrameCount() const noexcept { return bit_mask_ + 1; }
+
+  template <bool kIsCompact = false>
   void Process(float input_frame[kStereoChannelCount], float reverb_frame[kStereoChannelCount],
                float output_frame[kStereoChannelCount], const DelayParams& params) noexcept {
     assert(params.frame_count > 0);
@@ -63,9 +71,10 @@ class DelayFilter {
     for (uint32_t channel = 0; channel < kStereoChannelCount; ++channel) {
       delay_frame[channel] = lpf_[channel].Next<FilterType::kLowPass>(
           hpf_[channel].Next<FilterType::kHighPass>(
-              std::lerp(delay_samples_[kStereoChannelCount * read_frame_begin + channel],
-                        delay_samples_[kStereoChannelCount * read_frame_end + channel],
-                        params.frame_count - static_cast<float>(delay_frame_count)),
+              std::lerp(
+                  delay_samples_.Read<kIsCompact>(kStereoChannelCount * read_frame_begin + channel),
+                  delay_samples_.Read<kIsCompact>(kStereoChannelCount * read_frame_end + channel),
+                  params.frame_count - static_cast<float>(delay_frame_count)),
               params.hpf_coeff),
           params.lpf_coeff);
     }
@@ -77,9 +86,10 @@ class DelayFilter {
     };
 
     for (uint32_t channel = 0; channel < kStereoChannelCount; ++channel) {
-      delay_samples_[kStereoChannelCount * write_frame_ + channel] =
+      delay_samples_.Write<kIsCompact>(
+          kStereoChannelCount * write_frame_ + channel,
           std::lerp(input_frame[channel] + delay_frame[channel] * params.feedback,
-                    ping_pong_frame[channel], params.ping_pong);
+                    ping_pong_frame[channel], params.ping_pong));
 
       const float output_sample = delay_frame[channel] * params.mix;
       reverb_frame[channel] += std::min(params.reverb_send, 1.0f) * output_sample;
@@ -94,7 +104,7 @@ class DelayFilter {
   std::array<OnePoleFilter, kStereoChannelCount> lpf_ = {};
   std::array<OnePoleFilter, kStereoChannelCount> hpf_ = {};
 
-  float* delay_samples_ = nullptr;  // interleaved
+  DelayLine delay_samples_;  // interleaved
   uint32_t bit_mask_ = 0;
   uint32_t write_frame_ = 0;
 };
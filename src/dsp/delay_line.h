@@ -0,0 +1,55 @@
+#ifndef BARELYMUSICIAN_DSP_DELAY_LINE_H_
+#define BARELYMUSICIAN_DSP_DELAY_LINE_H_
+
+#include <cassert>
+#include <cstddef>
+
+#include "core/arena.h"
+#include "core/half.h"
+
+namespace barely {
+
+// Delay line buffer, which stores its samples in either full or half precision. The precision is
+// passed to each access as a template argument, so that it is resolved once per processing block.
+class DelayLine {
+ public:
+  DelayLine() noexcept = default;
+
+  DelayLine(Arena& arena, size_t sample_count, bool is_compact) noexcept
+      : samples_(is_compact ? static_cast<void*>(arena.AllocBuffer<Half>(sample_count))
+                            : static_cast<void*>(arena.AllocBuffer<float>(sample_count))),
+        is_compact_(is_compact) {}
+
+  // Returns whether the samples are stored in half precision.
+  [[nodiscard]] bool IsCompact() const noexcept { return is_compact_; }
+
+  template <bool kIsCompact>
+  [[nodiscard]] float Read(size_t index) const noexcept {
+    assert(samples_ != nullptr);
+    assert(kIsCompact == is_compact_);
+    if constexpr (kIsCompact) {
+      return HalfToFloat(static_cast<const Half*>(samples_)[index]);
+    } else {
+      return static_cast<const float*>(samples_)[index];
+    }
+  }
+
+  template <bool kIsCompact>
+  void Write(size_t index, float sample) noexcept {
+    assert(samples_ != nullptr);
+    assert(kIsCompact == is_compact_);
+    if constexpr (kIsCompact) {
+      static_cast<Half*>(samples_)[index] = FloatToHalf(sample);
+    } else {
+      static_cast<float*>(samples_)[index] = sample;
+    }
+  }
+
+ private:
+  void* samples_ = nullptr;
+  bool is_compact_ = false;
+};
+
+}  // namespace barely
+
+#endif  // BARELYMUSICIAN_DSP_DELAY_LINE_H_
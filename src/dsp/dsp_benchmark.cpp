@@ -0,0 +1,378 @@
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "core/arena.h"
+#include "core/constants.h"
+#include "core/decibels.h"
+#include "core/rng.h"
+#include "dsp/bit_crusher.h"
+#include "dsp/compressor.h"
+#include "dsp/delay_filter.h"
+#include "dsp/distortion.h"
+#include "dsp/envelope.h"
+#include "dsp/one_pole_filter.h"
+#include "dsp/reverb.h"
+#include "dsp/sample_generators.h"
+#include "dsp/sidechain.h"
+#include "dsp/tone_filter.h"
+
+namespace barely {
+namespace {
+
+using ::benchmark::ClobberMemory;
+using ::benchmark::Counter;
+using ::benchmark::CPUInfo;
+using ::benchmark::DoNotOptimize;
+using ::benchmark::State;
+
+constexpr float kSampleRate = 48000.0f;
+constexpr int64_t kMinBlockSize = 64;
+constexpr int64_t kMaxBlockSize = 1024;
+
+// Returns a block of input samples with a decaying sine wave.
+std::vector<float> GetInput(int64_t sample_count) {
+  std::vector<float> input(sample_count);
+  for (int64_t i = 0; i < sample_count; ++i) {
+    input[i] = std::exp(-4.0f * static_cast<float>(i) / static_cast<float>(sample_count)) *
+               std::sin(0.05f * static_cast<float>(i));
+  }
+  return input;
+}
+
+// Reports the processing cost in cycles per sample.
+void SetCyclesPerSample(State& state, int64_t sample_count) {
+  state.counters["cycles_per_sample"] =
+      Counter(static_cast<double>(sample_count) / CPUInfo::Get().cycles_per_second,
+              Counter::kIsIterationInvariantRate | Counter::kInvert);
+}
+
+template <typename T, typename... Args>
+struct ArenaAllocated {
+  explicit ArenaAllocated(Args... args)
+      : data(GetAllocSize<T>(args...)),
+        arena(data.data(), data.size()),
+        value(*::new (arena.Alloc<T>()) T(arena, args...)) {}
+
+  std::vector<std::byte> data;
+  Arena arena;
+  T& value;
+};
+
+void BM_BitCrusher(State& state) {
+  const int64_t block_size = state.range(0);
+  const std::vector<float> input = GetInput(block_size);
+  std::vector<float> output(block_size);
+
+  BitCrusher bit_crusher;
+  const float range = std::pow(2.0f, 0.75f * 15.0f);
+  const float increment = 0.25f;
+
+  for (auto _ : state) {  // NOLINT(clang-analyzer-deadcode.DeadStores)
+    for (int64_t i = 0; i < block_size; ++i) {
+      output[i] = bit_crusher.Next(input[i], range, increment);
+    }
+    DoNotOptimize(output.data());
+    ClobberMemory();
+  }
+  SetCyclesPerSample(state, block_size);
+}
+BENCHMARK(BM_BitCrusher)->RangeMultiplier(4)->Range(kMinBlockSize, kMaxBlockSize);
+
+void BM_Compressor(State& state) {
+  const int64_t block_size = state.range(0);
+  const std::vector<float> input = GetInput(kStereoChannelCount * block_size);
+  std::vector<float> output(kStereoChannelCount * block_size);
+
+  Compressor comp;
+  comp.SetAttack(0.01f, kSampleRate);
+  comp.SetRelease(0.1f, kSampleRate);
+  CompressorParams params;
+  params.threshold_db = AmplitudeToDecibels(0.25f);
+  params.SetRatio(0.5f);
+
+  for (auto _ : state) {  // NOLINT(clang-analyzer-deadcode.DeadStores)
+    for (int64_t i = 0; i < block_size; ++i) {
+      float frame[kStereoChannelCount] = {input[kStereoChannelCount * i],
+                                          input[kStereoChannelCount * i + 1]};
+      comp.Process(frame, params);
+      output[kStereoChannelCount * i] = frame[0];
+      output[kStereoChannelCount * i + 1] = frame[1];
+    }
+    DoNotOptimize(output.data());
+    ClobberMemory();
+  }
+  SetCyclesPerSample(state, block_size);
+}
+BENCHMARK(BM_Compressor)->RangeMultiplier(4)->Range(kMinBlockSize, kMaxBlockSize);
+
+template <bool kIsTimeModulated, bool kIsCompact>
+void BM_DelayFilter(State& state) {
+  const int64_t block_size = state.range(0);
+  const std::vector<float> input = GetInput(kStereoChannelCount * block_size);
+  std::vector<float> output(kStereoChannelCount * block_size);
+
+  const uint32_t max_frame_count = std::bit_ceil(static_cast<uint32_t>(kSampleRate));
+  ArenaAllocated<DelayFilter, uint32_t, bool> delay_filter(max_frame_count, kIsCompact);
+  DelayParams params;
+  params.frame_count = 0.375f * kSampleRate;
+  params.feedback = 0.5f;
+  params.lpf_coeff = GetFilterCoeff(kSampleRate, 8000.0f);
+  params.hpf_coeff = GetFilterCoeff(kSampleRate, 100.0f);
+  params.ping_pong = 0.5f;
+  params.reverb_send = 0.5f;
+
+  DelayParams target_params = params;
+  target_params.frame_count = 0.25f * kSampleRate;
+  const float coeff = GetCoefficient(kSampleRate, 0.05f);
+
+  for (auto _ : state) {  // NOLINT(clang-analyzer-deadcode.DeadStores)
+    for (int64_t i = 0; i < block_size; ++i) {
+      float input_frame[kStereoChannelCount] = {input[kStereoChannelCount * i],
+                                                input[kStereoChannelCount * i + 1]};
+      float reverb_frame[kStereoChannelCount] = {};
+      delay_filter.value.Process<kIsCompact>(input_frame, reverb_frame,
+                                                      &output[kStereoChannelCount * i], params);
+      if constexpr (kIsTimeModulated) {
+        params.Approach(target_params, coeff);
+        if (std::abs(params.frame_count - target_params.frame_count) < 1.0f) {
+          target_params.frame_count = (target_params.frame_count < 0.3f * kSampleRate)
+                                          ? 0.375f * kSampleRate
+                                          : 0.25f * kSampleRate;
+        }
+      }
+    }
+    DoNotOptimize(output.data());
+    ClobberMemory();
+  }
+  SetCyclesPerSample(state, block_size);
+}
+BENCHMARK(BM_DelayFilter<false, false>)->RangeMultiplier(4)->Range(kMinBlockSize, kMaxBlockSize);
+BENCHMARK(BM_DelayFilter<false, true>)->RangeMultiplier(4)->Range(kMinBlockSize, kMaxBlockSize);
+BENCHMARK(BM_DelayFilter<true, false>)->RangeMultiplier(4)->Range(kMinBlockSize, kMaxBlockSize);
+BENCHMARK(BM_DelayFilter<true, true>)->RangeMultiplier(4)->Range(kMinBlockSize, kMaxBlockSize);
+
+void BM_Distortion(State& state) {
+  const int64_t block_size = state.range(0);
+  const std::vector<float> input = GetInput(block_size);
+  std::vector<float> output(block_size);
+
+  for (auto _ : state) {  // NOLINT(clang-analyzer-deadcode.DeadStores)
+    for (int64_t i = 0; i < block_size; ++i) {
+      output[i] = Distortion(input[i], 0.5f, 5.0f);
+    }
+    DoNotOptimize(output.data());
+    ClobberMemory();
+  }
+  SetCyclesPerSample(state, block_size);
+}
+BENCHMARK(BM_Distortion)->RangeMultiplier(4)->Range(kMinBlockSize, kMaxBlockSize);
+
+void BM_Envelope(State& state) {
+  const int64_t block_size = state.range(0);
+  std::vector<float> output(block_size);
+
+  Envelope::Adsr adsr;
+  adsr.SetAttack(kSampleRate, 0.01f);
+  adsr.SetDecay(kSampleRate, 0.1f);
+  adsr.SetSustain(0.5f);
+  adsr.SetRelease(kSampleRate, 0.2f);
+  Envelope envelope;
+
+  int64_t frame = 0;
+  for (auto _ : state) {  // NOLINT(clang-analyzer-deadcode.DeadStores)
+    for (int64_t i = 0; i < block_size; ++i) {
+      // Cycle through all the envelope stages every half a second.
+      if (frame == 0) {
+        envelope.Start(adsr);
+      } else if (frame == static_cast<int64_t>(0.25f * kSampleRate)) {
+        envelope.Stop();
+      }
+      frame = (frame + 1) % static_cast<int64_t>(0.5f * kSampleRate);
+      output[i] = envelope.Next();
+    }
+    DoNotOptimize(output.data());
+    ClobberMemory();
+  }
+  SetCyclesPerSample(state, block_size);
+}
+BENCHMARK(BM_Envelope)->RangeMultiplier(4)->Range(kMinBlockSize, kMaxBlockSize);
+
+template <FilterType kType>
+void BM_OnePoleFilter(State& state) {
+  const int64_t block_size = state.range(0);
+  const std::vector<float> input = GetInput(block_size);
+  std::vector<float> output(block_size);
+
+  OnePoleFilter filter;
+  const float coeff = GetFilterCoeff(kSampleRate, 1000.0f);
+
+  for (auto _ : state) {  // NOLINT(clang-analyzer-deadcode.DeadStores)
+    for (int64_t i = 0; i < block_size; ++i) {
+      output[i] = filter.Next<kType>(input[i], coeff);
+    }
+    DoNotOptimize(output.data());
+    ClobberMemory();
+  }
+  SetCyclesPerSample(state, block_size);
+}
+BENCHMARK(BM_OnePoleFilter<FilterType::kLowPass>)
+    ->RangeMultiplier(4)
+    ->Range(kMinBlockSize, kMaxBlockSize);
+BENCHMARK(BM_OnePoleFilter<FilterType::kHighPass>)
+    ->RangeMultiplier(4)
+    ->Range(kMinBlockSize, kMaxBlockSize);
+
+template <bool kIsFrozen, bool kIsCompact>
+void BM_Reverb(State& state) {
+  const int64_t block_size = state.range(0);
+  const std::vector<float> input = GetInput(kStereoChannelCount * block_size);
+  std::vector<float> output(kStereoChannelCount * block_size);
+
+  ArenaAllocated<Reverb, float, bool, bool> reverb(kSampleRate, /*is_enabled=*/true, kIsCompact);
+  ReverbParams params;
+  params.SetFeedback(0.75f);
+  params.damping_ratio = 0.5f * kMaxDampingRatio;
+  params.width = 0.8f;
+  params.freeze = kIsFrozen;
+
+  for (auto _ : state) {  // NOLINT(clang-analyzer-deadcode.DeadStores)
+    for (int64_t i = 0; i < block_size; ++i) {
+      reverb.value.Process<kIsCompact>(&input[kStereoChannelCount * i],
+                                                &output[kStereoChannelCount * i], params);
+    }
+    DoNotOptimize(output.data());
+    ClobberMemory();
+  }
+  SetCyclesPerSample(state, block_size);
+}
+BENCHMARK(BM_Reverb<false, false>)->RangeMultiplier(4)->Range(kMinBlockSize, kMaxBlockSize);
+BENCHMARK(BM_Reverb<false, true>)->RangeMultiplier(4)->Range(kMinBlockSize, kMaxBlockSize);
+BENCHMARK(BM_Reverb<true, false>)->RangeMultiplier(4)->Range(kMinBlockSize, kMaxBlockSize);
+BENCHMARK(BM_Reverb<true, true>)->RangeMultiplier(4)->Range(kMinBlockSize, kMaxBlockSize);
+
+template <int kOscShapePercent>
+void BM_GenerateOscSample(State& state) {
+  const int64_t block_size = state.range(0);
+  std::vector<float> output(block_size);
+
+  const float osc_shape = static_cast<float>(kOscShapePercent) / 100.0f;
+  const float osc_increment = 440.0f / kSampleRate;
+  float osc_phase = 0.0f;
+
+  for (auto _ : state) {  // NOLINT(clang-analyzer-deadcode.DeadStores)
+    for (int64_t i = 0; i < block_size; ++i) {
+      output[i] = GenerateOscSample(osc_shape, osc_phase, osc_increment);
+      osc_phase += osc_increment;
+      if (osc_phase >= 1.0f) {
+        osc_phase -= 1.0f;
+      }
+    }
+    DoNotOptimize(output.data());
+    ClobberMemory();
+  }
+  SetCyclesPerSample(state, block_size);
+}
+BENCHMARK(BM_GenerateOscSample<0>)->RangeMultiplier(4)->Range(kMinBlockSize, kMaxBlockSize);
+BENCHMARK(BM_GenerateOscSample<50>)->RangeMultiplier(4)->Range(kMinBlockSize, kMaxBlockSize);
+BENCHMARK(BM_GenerateOscSample<100>)->RangeMultiplier(4)->Range(kMinBlockSize, kMaxBlockSize);
+
+void BM_GenerateNoiseSample(State& state) {
+  const int64_t block_size = state.range(0);
+  std::vector<float> output(block_size);
+
+  AudioRng rng;
+
+  for (auto _ : state) {  // NOLINT(clang-analyzer-deadcode.DeadStores)
+    for (int64_t i = 0; i < block_size; ++i) {
+      output[i] = rng.Generate();
+    }
+    DoNotOptimize(output.data());
+    ClobberMemory();
+  }
+  SetCyclesPerSample(state, block_size);
+}
+BENCHMARK(BM_GenerateNoiseSample)->RangeMultiplier(4)->Range(kMinBlockSize, kMaxBlockSize);
+
+template <bool kIsLooping>
+void BM_GenerateSliceSample(State& state) {
+  const int64_t block_size = state.range(0);
+  const std::vector<float> samples = GetInput(static_cast<int64_t>(kSampleRate));
+  std::vector<float> output(block_size);
+
+  const int32_t sample_count = static_cast<int32_t>(samples.size());
+  const float increment = std::pow(2.0f, 7.0f / 12.0f);
+  float offset = 0.0f;
+
+  for (auto _ : state) {  // NOLINT(clang-analyzer-deadcode.DeadStores)
+    for (int64_t i = 0; i < block_size; ++i) {
+      output[i] = GenerateSliceSample(samples.data(), sample_count, offset, kIsLooping);
+      offset += increment;
+      if (static_cast<int32_t>(offset) >= sample_count) {
+        offset = std::fmod(offset, static_cast<float>(sample_count));
+      }
+    }
+    DoNotOptimize(output.data());
+    ClobberMemory();
+  }
+  SetCyclesPerSample(state, block_size);
+}
+BENCHMARK(BM_GenerateSliceSample<false>)->RangeMultiplier(4)->Range(kMinBlockSize, kMaxBlockSize);
+BENCHMARK(BM_GenerateSliceSample<true>)->RangeMultiplier(4)->Range(kMinBlockSize, kMaxBlockSize);
+
+void BM_Sidechain(State& state) {
+  const int64_t block_size = state.range(0);
+  const std::vector<float> input = GetInput(kStereoChannelCount * block_size);
+  std::vector<float> output(kStereoChannelCount * block_size);
+
+  Sidechain sidechain;
+  sidechain.SetAttack(0.005f, kSampleRate);
+  sidechain.SetRelease(0.2f, kSampleRate);
+  CompressorParams params;
+  params.threshold_db = AmplitudeToDecibels(0.0625f);
+  params.SetRatio(0.5f);
+
+  for (auto _ : state) {  // NOLINT(clang-analyzer-deadcode.DeadStores)
+    for (int64_t i = 0; i < block_size; ++i) {
+      float frame[kStereoChannelCount] = {input[kStereoChannelCount * i],
+                                          input[kStereoChannelCount * i + 1]};
+      sidechain.Process(frame, params);
+      output[kStereoChannelCount * i] = frame[0];
+      output[kStereoChannelCount * i + 1] = frame[1];
+    }
+    DoNotOptimize(output.data());
+    ClobberMemory();
+  }
+  SetCyclesPerSample(state, block_size);
+}
+BENCHMARK(BM_Sidechain)->RangeMultiplier(4)->Range(kMinBlockSize, kMaxBlockSize);
+
+template <int kResonancePercent>
+void BM_ToneFilter(State& state) {
+  const int64_t block_size = state.range(0);
+  const std::vector<float> input = GetInput(block_size);
+  std::vector<float> output(block_size);
+
+  ToneFilter filter;
+  ToneFilterParams params;
+  params.SetCutoff(kSampleRate, 0.5f);
+  params.SetResonance(static_cast<float>(kResonancePercent) / 100.0f);
+  params.SetTone(0.25f);
+
+  for (auto _ : state) {  // NOLINT(clang-analyzer-deadcode.DeadStores)
+    for (int64_t i = 0; i < block_size; ++i) {
+      output[i] = filter.Next(input[i], params);
+    }
+    DoNotOptimize(output.data());
+    ClobberMemory();
+  }
+  SetCyclesPerSample(state, block_size);
+}
+BENCHMARK(BM_ToneFilter<0>)->RangeMultiplier(4)->Range(kMinBlockSize, kMaxBlockSize);
+BENCHMARK(BM_ToneFilter<95>)->RangeMultiplier(4)->Range(kMinBlockSize, kMaxBlockSize);
+
+}  // namespace
+}  // namespace barely
@@ -3,13 +3,13 @@
 
 #include <algorithm>
 #include <array>
-#include <bit>
 #include <cassert>
 #include <cmath>
 
 #include "core/arena.h"
 #include "core/constants.h"
 #include "core/control.h"
+#include "dsp/delay_line.h"
 
 namespace barely {
 
@@ -36,34 +36,27 @@ struct ReverbParams {
 // Simple stereo reverb implementation based on freeverb.
 class Reverb {
  public:
-  Reverb(Arena& arena, float sample_rate) noexcept {
-    const float sample_rate_scale = sample_rate / kTuningSampleRate;
-    const uint32_t max_delay_frame_count = std::bit_ceil(static_cast<uint32_t>(
-        GetScaledTuning(kCombFilterTunings[kCombFilterCount - 1], 1, sample_rate_scale)));
-    for (int channel = 0; channel < kStereoChannelCount; ++channel) {
-      for (int i = 0; i < kCombFilterCount; ++i) {
-        comb_filters_[channel][i].Init(arena, max_delay_frame_count);
-      }
-      for (int i = 0; i < kAllPassFilterCount; ++i) {
-        all_pass_filters_[channel][i].Init(arena, max_delay_frame_count);
-      }
+  // Constructs a new `Reverb`, where the compact filters store half precision samples to halve
+  // their memory.
+  Reverb(Arena& arena, float sample_rate, bool is_enabled, bool is_compact = false) noexcept {
+    if (!is_enabled) {
+      return;  // leave the filters without buffers, since the reverb is bypassed.
     }
-    if (arena.is_null()) {
-      return;
-    }
-
+    const float sample_rate_scale = sample_rate / kTuningSampleRate;
     for (int channel = 0; channel < kStereoChannelCount; ++channel) {
       for (int i = 0; i < kCombFilterCount; ++i) {
-        comb_filters_[channel][i].SetFrameCount(
-            GetScaledTuning(kCombFilterTunings[i], channel, sample_rate_scale));
+        comb_filters_[channel][i].Init(
+            arena, GetScaledTuning(kCombFilterTunings[i], channel, sample_rate_scale), is_compact);
       }
       for (int i = 0; i < kAllPassFilterCount; ++i) {
-        all_pass_filters_[channel][i].SetFrameCount(
-            GetScaledTuning(kAllPassFilterTunings[i], channel, sample_rate_scale));
+        all_pass_filters_[channel][i].Init(
+            arena, GetScaledTuning(kAllPassFilterTunings[i], channel, sample_rate_scale),
+            is_compact);
       }
     }
   }
 
+  template <bool kIsCompact = false>
   void Process(const float input_frame[kStereoChannelCount],
                float output_frame[kStereoChannelCount], const ReverbParams& params) noexcept {
     float damping_ratio = 0.0f;
@@ -79,10 +72,11 @@ class Reverb {
     for (int channel = 0; channel < kStereoChannelCount; ++channel) {
       for (int i = 0; i < kCombFilterCount; ++i) {
         wet_frame[channel] +=
-            comb_filters_[channel][i].Process(input_sample, feedback, damping_ratio);
+            comb_filters_[channel][i].Process<kIsCompact>(input_sample, feedback, damping_ratio);
       }
       for (int i = 0; i < kAllPassFilterCount; ++i) {
-        wet_frame[channel] = all_pass_filters_[channel][i].Process(wet_frame[channel]);
+        wet_frame[channel] =
+            all_pass_filters_[channel][i].Process<kIsCompact>(wet_frame[channel]);
       }
     }
 
@@ -121,24 +115,24 @@ class Reverb {
 
   class CombFilter {
    public:
-    void Init(Arena& arena, uint32_t max_delay_frame_count) noexcept {
-      delay_samples_ = arena.AllocArray<float>(max_delay_frame_count);
+    void Init(Arena& arena, int frame_count, bool is_compact) noexcept {
+      delay_samples_ = DelayLine(arena, static_cast<size_t>(frame_count), is_compact);
+      frame_count_ = frame_count;
     }
 
+    template <bool kIsCompact>
     [[nodiscard]] float Process(float input_sample, float feedback, float damping_ratio) noexcept {
-      const float output_sample = delay_samples_[write_frame_];
+      const float output_sample = delay_samples_.Read<kIsCompact>(write_frame_);
       damped_sample_ = std::lerp(output_sample, damped_sample_, damping_ratio);
-      delay_samples_[write_frame_] = input_sample + damped_sample_ * feedback;
+      delay_samples_.Write<kIsCompact>(write_frame_, input_sample + damped_sample_ * feedback);
       if (++write_frame_ == frame_count_) {
         write_frame_ = 0;
       }
       return output_sample;
     }
 
-    void SetFrameCount(int frame_count) noexcept { frame_count_ = frame_count; }
-
    private:
-    float* delay_samples_ = nullptr;
+    DelayLine delay_samples_;
     float damped_sample_ = 0.0f;
     int write_frame_ = 0;
     int frame_count_ = 1;
@@ -146,24 +140,25 @@ class Reverb {
 
   class AllPassFilter {
    public:
-    void Init(Arena& arena, uint32_t max_delay_frame_count) noexcept {
-      delay_samples_ = arena.AllocArray<float>(max_delay_frame_count);
+    void Init(Arena& arena, int frame_count, bool is_compact) noexcept {
+      delay_samples_ = DelayLine(arena, static_cast<size_t>(frame_count), is_compact);
+      frame_count_ = frame_count;
     }
 
+    template <bool kIsCompact>
     [[nodiscard]] float Process(float input_sample) noexcept {
-      const float delayed_sample = delay_samples_[write_frame_];
+      const float delayed_sample = delay_samples_.Read<kIsCompact>(write_frame_);
       const float output_sample = delayed_sample - input_sample;
-      delay_samples_[write_frame_] = input_sample + delayed_sample * kAllPassFeedback;
+      delay_samples_.Write<kIsCompact>(write_frame_,
+                                       input_sample + delayed_sample * kAllPassFeedback);
       if (++write_frame_ == frame_count_) {
         write_frame_ = 0;
       }
       return output_sample;
     }
 
-    void SetFrameCount(int frame_count) noexcept { frame_count_ = frame_count; }
-
    private:
-    float* delay_samples_ = nullptr;
+    DelayLine delay_samples_;
     int write_frame_ = 0;
     int frame_count_ = 1;
   };
@@ -8,6 +8,8 @@
 #include <variant>
 
 #include "core/constants.h"
+#include "engine/sample_bank_state.h"
+#include "engine/voice_pool.h"
 
 namespace barely {
 
@@ -22,12 +24,24 @@ struct EngineSeedCmd {
 
 struct InstrumentCreateCmd {
   uint32_t instrument_index = kInvalidIndex;
+  uint32_t instrument_id = 0;  // to validate the events of the host
 };
 
 struct InstrumentDestroyCmd {
   uint32_t instrument_index = kInvalidIndex;
 };
 
+struct InstrumentFreezeCmd {
+  uint32_t instrument_index = kInvalidIndex;
+  uint32_t first_frame = 0;  // of the engine freeze frames
+  double loop_frame_count = 0.0;
+  uint32_t freeze_generation = 0;  // to tag the thaws of the host
+};
+
+struct InstrumentThawCmd {
+  uint32_t instrument_index = kInvalidIndex;
+};
+
 struct InstrumentControlCmd {
   uint32_t instrument_index = kInvalidIndex;
   BarelyInstrumentControlType type = BarelyInstrumentControlType_kCount;
@@ -54,11 +68,17 @@ struct NoteOnCmd {
 struct SampleDataCmd {
   uint32_t instrument_index = kInvalidIndex;
   uint32_t first_slice_index = kInvalidIndex;
+  const SampleBankState* sample_bank = nullptr;
+};
+
+struct VoicePoolCmd {
+  VoicePool* voice_pool = nullptr;  // to grow into
 };
 
 using Cmd =
     std::variant<EngineControlCmd, EngineSeedCmd, InstrumentCreateCmd, InstrumentDestroyCmd,
-                 InstrumentControlCmd, NoteControlCmd, NoteOffCmd, NoteOnCmd, SampleDataCmd>;
+                 InstrumentFreezeCmd, InstrumentThawCmd, InstrumentControlCmd, NoteControlCmd,
+                 NoteOffCmd, NoteOnCmd, SampleDataCmd, VoicePoolCmd>;
 
 template <typename... CmdTypes>
 struct CmdVisitor : CmdTypes... {  // NOLINT(misc-multiple-inheritance)
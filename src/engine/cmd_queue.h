@@ -1,6 +1,7 @@
 #ifndef BARELYMUSICIAN_ENGINE_CMD_QUEUE_H_
 #define BARELYMUSICIAN_ENGINE_CMD_QUEUE_H_
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <bit>
@@ -17,7 +18,7 @@ namespace barely {
 class CmdQueue {
  public:
   CmdQueue(Arena& arena, uint32_t max_cmd_count) noexcept
-      : cmds_(arena.AllocArray<std::pair<int64_t, Cmd>>(max_cmd_count)),
+      : cmds_(arena.AllocBuffer<std::pair<int64_t, Cmd>>(max_cmd_count)),
         bit_mask_(max_cmd_count - 1) {
     assert(max_cmd_count > 0);
     assert(std::has_single_bit(max_cmd_count));
@@ -26,14 +27,30 @@ class CmdQueue {
   bool Add(int64_t cmd_frame, Cmd cmd) noexcept {
     const uint32_t index = write_index_.load(std::memory_order_relaxed);
     const uint32_t next_index = (index + 1) & bit_mask_;
-    if (next_index == read_index_.load(std::memory_order_acquire)) {
+    const uint32_t read_index = read_index_.load(std::memory_order_acquire);
+    if (next_index == read_index) {
       return false;
     }
     cmds_[index] = {cmd_frame, cmd};
     write_index_.store(next_index, std::memory_order_release);
+    max_active_count_ = std::max(max_active_count_, (next_index - read_index) & bit_mask_);
     return true;
   }
 
+  // Returns the number of queued commands, which is only safe to call from the producer thread.
+  [[nodiscard]] uint32_t ActiveCount() const noexcept {
+    return (write_index_.load(std::memory_order_relaxed) -
+            read_index_.load(std::memory_order_acquire)) &
+           bit_mask_;
+  }
+
+  // Returns the maximum number of commands that can be queued at once.
+  [[nodiscard]] uint32_t Count() const noexcept { return bit_mask_; }
+
+  // Returns the maximum number of queued commands since construction, which is only safe to call
+  // from the producer thread.
+  [[nodiscard]] uint32_t MaxActiveCount() const noexcept { return max_active_count_; }
+
   std::pair<int64_t, Cmd>* GetNext(int64_t end_frame) noexcept {
     const uint32_t index = read_index_.load(std::memory_order_relaxed);
     if (index == write_index_.load(std::memory_order_acquire) || cmds_[index].first >= end_frame) {
@@ -47,10 +64,12 @@ class CmdQueue {
   // Array of commands with their timestamps in frames.
   std::pair<int64_t, Cmd>* cmds_ = nullptr;
 
-  std::atomic<uint32_t> read_index_ = 0;
-  std::atomic<uint32_t> write_index_ = 0;
+  // Read and written by different threads, so each index sits on its own cache line.
+  alignas(kCacheLineSize) std::atomic<uint32_t> read_index_ = 0;
+  alignas(kCacheLineSize) std::atomic<uint32_t> write_index_ = 0;
 
-  uint32_t bit_mask_ = 0;
+  alignas(kCacheLineSize) uint32_t bit_mask_ = 0;
+  uint32_t max_active_count_ = 0;  // of the producer thread
 };
 
 }  // namespace barely
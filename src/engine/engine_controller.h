@@ -1,11 +1,11 @@
 #ifndef BARELYMUSICIAN_ENGINE_ENGINE_CONTROLLER_H_
 #define BARELYMUSICIAN_ENGINE_ENGINE_CONTROLLER_H_
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <optional>
 
-#include "core/time.h"
 #include "engine/engine_state.h"
 #include "engine/instrument_controller.h"
 #include "engine/performer_controller.h"
@@ -17,34 +17,69 @@ class EngineController {
   explicit EngineController(EngineState& engine) noexcept
       : engine_(engine), instrument_controller_(engine_), performer_controller_(engine_) {}
 
+  // Grows the pools into a given storage, where the voice pool is handed over to the audio thread.
+  void GrowPools(EnginePoolStorage& storage) noexcept {
+    if (storage.slice_pool.Count() > 0) {
+      engine_.slice_pool.Extend(storage.slice_pool);
+    }
+    if (const uint32_t task_count = engine_.task_pool.Count(); storage.task_pool.Count() > 0) {
+      std::copy_n(engine_.task_generations, task_count, storage.task_generations);
+      std::copy_n(engine_.task_edits, task_count, storage.task_edits);
+      engine_.task_generations = storage.task_generations;
+      engine_.sorted_task_indices = storage.sorted_task_indices;
+      engine_.task_edits = storage.task_edits;
+      engine_.task_pool.Extend(storage.task_pool);
+    }
+    if (storage.voice_pool.Count() > 0) {
+      engine_.max_voice_count = storage.voice_pool.Count();
+      engine_.ScheduleCmd(VoicePoolCmd{&storage.voice_pool});
+    }
+  }
+
   void SetControl(BarelyEngineControlType type, float value) noexcept {
     engine_.ScheduleCmd(EngineControlCmd{type, kEngineControls[type].Clamp(value)});
   }
 
+  // Updates the engine at timestamp, which stops early at the time of the batched task events.
   void Update(double timestamp) noexcept {
-    std::optional<int32_t> min_priority = std::nullopt;
+    engine_.ThawHostThawedInstruments();
     while (engine_.timestamp < timestamp) {
-      if (engine_.tempo > 0.0) {
-        const double max_update_duration =
-            SecondsToBeats(engine_.tempo, timestamp - engine_.timestamp);
-
+      if (performer_controller_.IsTaskEventBufferFull()) {
+        // Stop once the batched task events are full, which resumes in the next update.
+        return;
+      }
+      if (const double max_update_duration =
+              engine_.tempo_map.GetBeats(engine_.timestamp, timestamp);
+          max_update_duration > 0.0) {
         double update_duration = max_update_duration;
         int32_t max_priority = INT32_MIN;
-        performer_controller_.GetNextTaskEvent(min_priority, update_duration, max_priority);
+        performer_controller_.GetNextTaskEvent(min_priority_, update_duration, max_priority);
 
         if (update_duration > 0.0) {
+          if (performer_controller_.HasTaskEvents()) {
+            // Stop at the time of the batched task events, which resumes in the next update.
+            return;
+          }
+          // Advance the timestamp first to schedule the ending tasks at the right time.
+          engine_.timestamp =
+              (update_duration < max_update_duration)
+                  ? std::min(engine_.tempo_map.GetTimestamp(engine_.timestamp, update_duration),
+                             timestamp)
+                  : timestamp;
           performer_controller_.UpdatePosition(update_duration);
-          engine_.timestamp += BeatsToSeconds(engine_.tempo, update_duration);
-          min_priority = std::nullopt;
+          min_priority_ = std::nullopt;
         }
-        if (update_duration < max_update_duration) {
-          performer_controller_.ProcessAllTasksAtPosition(min_priority, max_priority);
-          min_priority = max_priority;
+        if (update_duration < max_update_duration &&
+            !performer_controller_.IsTaskEventBufferFull()) {
+          performer_controller_.ProcessAllTasksAtPosition(min_priority_, max_priority);
+          min_priority_ = max_priority;
         }
-      } else if (engine_.timestamp < timestamp) {
+      } else {
         engine_.timestamp = timestamp;
       }
     }
+    min_priority_ = std::nullopt;
+    performer_controller_.SyncAllPositions();
   }
 
   [[nodiscard]] InstrumentController& instrument_controller() noexcept {
@@ -65,6 +100,10 @@ class EngineController {
   EngineState& engine_;
   InstrumentController instrument_controller_;
   PerformerController performer_controller_;
+
+  // Priority up to which the task events at the current beat are processed, which is kept across
+  // the updates that stop early.
+  std::optional<int32_t> min_priority_ = std::nullopt;
 };
 
 }  // namespace barely
@@ -2,13 +2,18 @@
 
 #include <barelymusician.h>
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <optional>
+#include <utility>
+#include <variant>
+#include <vector>
 
 #include "core/arena.h"
+#include "engine/cmd.h"
 #include "engine/engine_state.h"
 #include "gtest/gtest.h"
 
@@ -46,7 +51,7 @@ TEST(EngineControllerTest, AcquireReleasePerformer) {
   const auto& task = engine.GetTask(task_index);
 
   // Start the performer with a tempo of one beat per second.
-  engine.tempo = 60.0;
+  engine.tempo_map.SetTempo(60.0);
   EXPECT_FALSE(performer.is_playing);
   EXPECT_FALSE(task.is_active);
   controller.performer_controller().Start(performer_index);
@@ -116,5 +121,100 @@ TEST(EngineControllerTest, AcquireReleasePerformer) {
   EXPECT_DOUBLE_EQ(task_position, 3.0);
 }
 
+TEST(EngineControllerTest, StopPerformerInTaskCallback) {
+  const auto size = GetAllocSize<EngineState>(EngineConfig(kSampleRate));
+  auto data = std::make_unique<std::byte[]>(size);
+  Arena arena(data.get(), size);
+  EngineState engine(arena, EngineConfig(kSampleRate));
+  EngineController controller(engine);
+  engine.tempo_map.SetTempo(60.0);
+
+  const uint32_t performer_index = controller.performer_controller().Acquire();
+  const auto& performer = engine.GetPerformer(performer_index);
+
+  // Stop the performer at the end of the first task, which should skip the second task.
+  int begin_count = 0;
+  std::function<void(TaskEventType)> process_callback = [&](TaskEventType type) {
+    if (type == TaskEventType::kBegin) {
+      ++begin_count;
+    } else {
+      controller.performer_controller().Stop(performer_index);
+    }
+  };
+  const auto callback = [](BarelyTaskEventType type, void* user_data) {
+    (*static_cast<std::function<void(TaskEventType)>*>(user_data))(
+        static_cast<TaskEventType>(type));
+  };
+  for (const double position : {0.0, 1.0}) {
+    EXPECT_NE(controller.performer_controller().AcquireTask(performer_index, position, 1.0, 0,
+                                                            callback, &process_callback),
+              kInvalidIndex);
+  }
+  controller.performer_controller().Start(performer_index);
+
+  controller.Update(2.0);
+  EXPECT_FALSE(performer.is_playing);
+  EXPECT_DOUBLE_EQ(performer.position, 1.0);
+  EXPECT_EQ(begin_count, 1);
+  EXPECT_DOUBLE_EQ(engine.timestamp, 2.0);
+}
+
+TEST(EngineControllerTest, PlayClip) {
+  const auto size = GetAllocSize<EngineState>(EngineConfig(kSampleRate));
+  auto data = std::make_unique<std::byte[]>(size);
+  Arena arena(data.get(), size);
+  EngineState engine(arena, EngineConfig(kSampleRate));
+  EngineController controller(engine);
+
+  const uint32_t instrument_index = controller.instrument_controller().Acquire();
+  const uint32_t instrument_id =
+      engine.BuildId(instrument_index, engine.instrument_generations[instrument_index]);
+  const uint32_t performer_index = controller.performer_controller().Acquire();
+
+  // Create a clip with notes out of order.
+  const std::array<BarelyNote, 2> notes = {
+      BarelyNote{1.0, 0.5, 2.0f, 0.5f},
+      BarelyNote{0.0, 1.0, 1.0f, 1.0f},
+  };
+  std::array<uint32_t, 2> task_indices;
+  EXPECT_EQ(controller.performer_controller().AcquireClipTasks(performer_index, instrument_id,
+                                                               notes, task_indices.data()),
+            2);
+
+  // Start the performer with a tempo of one beat per second, and play the whole clip.
+  engine.tempo_map.SetTempo(60.0);
+  controller.performer_controller().Start(performer_index);
+  controller.Update(2.0);
+
+  std::vector<std::pair<int64_t, Cmd>> cmds;
+  while (auto* cmd = engine.cmd_queue.GetNext(INT64_MAX)) {
+    cmds.push_back(*cmd);
+  }
+  ASSERT_EQ(cmds.size(), 6);
+  EXPECT_TRUE(std::holds_alternative<InstrumentCreateCmd>(cmds[0].second));
+
+  const auto expect_note_cmd = [&](const std::pair<int64_t, Cmd>& cmd, int64_t frame, auto type,
+                                   float pitch) {
+    EXPECT_EQ(cmd.first, frame);
+    const auto* note_cmd = std::get_if<decltype(type)>(&cmd.second);
+    ASSERT_NE(note_cmd, nullptr);
+    EXPECT_EQ(note_cmd->instrument_index, instrument_index);
+    EXPECT_FLOAT_EQ(note_cmd->pitch, pitch);
+  };
+  expect_note_cmd(cmds[1], 0, NoteOnCmd{}, 1.0f);
+  expect_note_cmd(cmds[2], kSampleRate, NoteOffCmd{}, 1.0f);
+  expect_note_cmd(cmds[3], kSampleRate, NoteOnCmd{}, 2.0f);
+  expect_note_cmd(cmds[4], kSampleRate, NoteControlCmd{}, 2.0f);
+  EXPECT_FLOAT_EQ(std::get<NoteControlCmd>(cmds[4].second).value, 0.5f);
+  expect_note_cmd(cmds[5], 3 * kSampleRate / 2, NoteOffCmd{}, 2.0f);
+
+  // Notes of a destroyed instrument are not played anymore.
+  controller.performer_controller().SetPosition(performer_index, 0.0);
+  engine.instrument_generations[instrument_index] =
+      engine.GetNextIdGeneration(engine.instrument_generations[instrument_index]);
+  controller.Update(3.0);
+  EXPECT_EQ(engine.cmd_queue.GetNext(INT64_MAX), nullptr);
+}
+
 }  // namespace
 }  // namespace barely
@@ -8,6 +8,9 @@
 #include <atomic>
 #include <cassert>
 #include <cmath>
+#include <cstddef>
+#include <limits>
+#include <span>
 #include <unordered_map>
 
 #include "core/constants.h"
@@ -28,8 +31,10 @@ class EngineProcessor {
   explicit EngineProcessor(EngineState& engine) noexcept
       : engine_(engine), instrument_processor_(engine_) {}
 
+  // Processes the next output samples, where the events of the host are applied at their frames
+  // along with the scheduled commands.
   void Process(float* output_samples, int output_channel_count, int output_frame_count,
-               double timestamp) noexcept {
+               double timestamp, std::span<const BarelyEngineEvent> events = {}) noexcept {
     assert(output_samples != nullptr);
     assert(output_channel_count > 0);
     assert(output_frame_count > 0);
@@ -40,20 +45,40 @@ class EngineProcessor {
     const int64_t process_frame = SecondsToFrames(engine_.sample_rate, timestamp);
     const int64_t end_frame = process_frame + output_frame_count;
     int current_frame = 0;
+    size_t event_index = 0;
+
+    // Process the events before a frame, which splits the samples at each event frame. The events
+    // outside of the output frames are skipped.
+    const auto process_events = [&](int frame) noexcept {
+      for (; event_index < events.size() && events[event_index].frame < frame; ++event_index) {
+        const BarelyEngineEvent& event = events[event_index];
+        if (event.frame < 0 || event.frame >= output_frame_count) {
+          continue;
+        }
+        if (current_frame < event.frame) {
+          ProcessSamples(&engine_.temp_samples[kStereoChannelCount * current_frame],
+                         event.frame - current_frame);
+          current_frame = event.frame;
+        }
+        ProcessEvent(event);
+      }
+    };
 
     engine_.process_fence.store(true, std::memory_order_release);
 
     // Process *all* commands before the end sample.
     for (auto* cmd = engine_.cmd_queue.GetNext(end_frame); cmd;
          cmd = engine_.cmd_queue.GetNext(end_frame)) {
-      if (const int cmd_frame = static_cast<int>(cmd->first - process_frame);
-          current_frame < cmd_frame) {
+      const int cmd_frame = static_cast<int>(cmd->first - process_frame);
+      process_events(cmd_frame);
+      if (current_frame < cmd_frame) {
         ProcessSamples(&engine_.temp_samples[kStereoChannelCount * current_frame],
                        cmd_frame - current_frame);
         current_frame = cmd_frame;
       }
       ProcessCmd(cmd->second);
     }
+    process_events(std::numeric_limits<int>::max());
 
     // Process the rest of the samples.
     if (current_frame < output_frame_count) {
@@ -63,6 +88,11 @@ class EngineProcessor {
 
     engine_.process_fence.store(false, std::memory_order_release);
 
+    engine_.active_voice_count.store(engine_.voice_pool.ActiveCount(), std::memory_order_relaxed);
+    engine_.max_active_voice_count.store(engine_.voice_pool.MaxActiveCount(),
+                                         std::memory_order_relaxed);
+    engine_.voice_capacity.store(engine_.voice_pool.Count(), std::memory_order_relaxed);
+
     // Fill the output samples.
     if (output_channel_count > 1) {
       std::fill_n(output_samples, output_channel_count * output_frame_count, 0.0f);
@@ -105,7 +135,8 @@ class EngineProcessor {
         break;
       case BarelyEngineControlType_kDelayTime:
         engine_.target_params.delay_params.frame_count =
-            std::max(value * engine_.sample_rate, 1.0f);
+            std::min(std::max(value * engine_.sample_rate, 1.0f),
+                     static_cast<float>(engine_.delay_filter.GetMaxFrameCount()));
         break;
       case BarelyEngineControlType_kDelayFeedback:
         engine_.target_params.delay_params.feedback = value * kMaxDelayFeedback;
@@ -168,14 +199,24 @@ class EngineProcessor {
               SetControl(engine_control_cmd.type, engine_control_cmd.value);
             },
             [this](EngineSeedCmd& engine_seed_cmd) noexcept {
-              engine_.audio_rng.ResetSeed(engine_seed_cmd.seed);
+              engine_.audio_seed = static_cast<uint32_t>(engine_seed_cmd.seed);
             },
             [this](InstrumentCreateCmd& instrument_create_cmd) noexcept {
-              instrument_processor_.Init(instrument_create_cmd.instrument_index);
+              instrument_processor_.Init(instrument_create_cmd.instrument_index,
+                                         instrument_create_cmd.instrument_id);
             },
             [this](InstrumentDestroyCmd& instrument_destroy_cmd) noexcept {
               instrument_processor_.Shutdown(instrument_destroy_cmd.instrument_index);
             },
+            [this](InstrumentFreezeCmd& instrument_freeze_cmd) noexcept {
+              instrument_processor_.Freeze(instrument_freeze_cmd.instrument_index,
+                                           instrument_freeze_cmd.first_frame,
+                                           instrument_freeze_cmd.loop_frame_count,
+                                           instrument_freeze_cmd.freeze_generation);
+            },
+            [this](InstrumentThawCmd& instrument_thaw_cmd) noexcept {
+              instrument_processor_.Thaw(instrument_thaw_cmd.instrument_index);
+            },
             [this](InstrumentControlCmd& instrument_control_cmd) noexcept {
               instrument_processor_.SetControl(instrument_control_cmd.instrument_index,
                                                instrument_control_cmd.type,
@@ -194,11 +235,72 @@ class EngineProcessor {
             },
             [this](SampleDataCmd& sample_data_cmd) noexcept {
               instrument_processor_.SetSampleData(sample_data_cmd.instrument_index,
-                                                  sample_data_cmd.first_slice_index);
+                                                  sample_data_cmd.first_slice_index,
+                                                  sample_data_cmd.sample_bank);
+            },
+            [this](VoicePoolCmd& voice_pool_cmd) noexcept {
+              engine_.voice_pool.Extend(*voice_pool_cmd.voice_pool);
             }},
         cmd);
   }
 
+  // Processes an event of the host, which is clamped and thaws its instrument like its setter. The
+  // instrument is validated against the audio thread state, and the control thread catches up with
+  // the thaw through the generation of the thawed freeze.
+  void ProcessEvent(const BarelyEngineEvent& event) noexcept {
+    if (event.type == BarelyEngineEventType_kEngineControl) {
+      if (event.control_type >= 0 && event.control_type < BarelyEngineControlType_kCount) {
+        const auto type = static_cast<BarelyEngineControlType>(event.control_type);
+        SetControl(type, kEngineControls[type].Clamp(event.value));
+      }
+      return;
+    }
+    const uint32_t instrument_index = engine_.GetIdIndex(event.instrument_id);
+    if (instrument_index >= engine_.max_instrument_count ||
+        engine_.instrument_params[instrument_index].instrument_id != event.instrument_id) {
+      return;
+    }
+    if (const InstrumentParams& params = engine_.instrument_params[instrument_index];
+        params.freeze.IsFrozen()) {
+      engine_.host_thawed_freeze_generations[instrument_index].store(params.freeze_generation,
+                                                                     std::memory_order_release);
+      instrument_processor_.Thaw(instrument_index);
+    }
+    switch (event.type) {
+      case BarelyEngineEventType_kInstrumentControl:
+        if (event.control_type >= 0 && event.control_type < BarelyInstrumentControlType_kCount) {
+          const auto type = static_cast<BarelyInstrumentControlType>(event.control_type);
+          instrument_processor_.SetControl(instrument_index, type,
+                                           kInstrumentControls[type].Clamp(event.value));
+        }
+        break;
+      case BarelyEngineEventType_kNoteControl:
+        if (event.control_type >= 0 && event.control_type < BarelyNoteControlType_kCount) {
+          const auto type = static_cast<BarelyNoteControlType>(event.control_type);
+          instrument_processor_.SetNoteControl(instrument_index, event.pitch, type,
+                                               kNoteControls[type].Clamp(event.value));
+        }
+        break;
+      case BarelyEngineEventType_kNoteOff:
+        instrument_processor_.SetNoteOff(instrument_index, event.pitch);
+        break;
+      case BarelyEngineEventType_kNoteOn:
+        instrument_processor_.SetNoteOn(instrument_index, event.pitch);
+        break;
+      default:
+        break;
+    }
+  }
+
+  void ProcessSamples(float* output_samples, int output_frame_count) noexcept {
+    if (engine_.is_compact_effects) {
+      ProcessSamples<true>(output_samples, output_frame_count);
+    } else {
+      ProcessSamples<false>(output_samples, output_frame_count);
+    }
+  }
+
+  template <bool kIsCompactEffects>
   void ProcessSamples(float* output_samples, int output_frame_count) noexcept {
     for (int frame = 0; frame < output_frame_count; ++frame) {
       float delay_frame[kStereoChannelCount] = {};
@@ -212,9 +314,14 @@ class EngineProcessor {
       instrument_processor_.ProcessAllVoices<false>(delay_frame, reverb_frame, sidechain_frame,
                                                     output_frame);
 
-      engine_.delay_filter.Process(delay_frame, reverb_frame, output_frame,
-                                   engine_.current_params.delay_params);
-      engine_.reverb.Process(reverb_frame, output_frame, engine_.current_params.reverb_params);
+      if (engine_.is_delay_enabled) {
+        engine_.delay_filter.Process<kIsCompactEffects>(delay_frame, reverb_frame, output_frame,
+                                                        engine_.current_params.delay_params);
+      }
+      if (engine_.is_reverb_enabled) {
+        engine_.reverb.Process<kIsCompactEffects>(reverb_frame, output_frame,
+                                                  engine_.current_params.reverb_params);
+      }
 
       engine_.comp.Process(output_frame, engine_.current_params.comp_params);
 
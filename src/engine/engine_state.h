@@ -3,10 +3,13 @@
 
 #include <barelymusician.h>
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <bit>
+#include <cmath>
 #include <cstdint>
+#include <optional>
 
 #include "core/arena.h"
 #include "core/control.h"
@@ -19,42 +22,107 @@
 #include "dsp/sidechain.h"
 #include "engine/cmd.h"
 #include "engine/cmd_queue.h"
+#include "engine/freeze_state.h"
 #include "engine/params.h"
 #include "engine/performer_state.h"
+#include "engine/render_cache.h"
+#include "engine/sample_bank_state.h"
 #include "engine/slice_pool.h"
-#include "engine/voice_state.h"
+#include "engine/task_event_queue.h"
+#include "engine/task_state.h"
+#include "engine/tempo_map.h"
+#include "engine/voice_pool.h"
 
 namespace barely {
 
 static_assert((kInvalidIndex + 1) == 0);
 
 struct InstrumentState {
+  SampleBankState* sample_bank = nullptr;  // referenced instead of the slices if set
   uint32_t first_slice_index = kInvalidIndex;
+
+  // Performer whose clip notes are frozen, or invalid index if not frozen, and the freeze frames.
+  uint32_t frozen_performer_index = kInvalidIndex;
+  uint32_t first_freeze_frame = 0;
+  uint32_t freeze_frame_count = 0;
+  uint32_t freeze_generation = 0;  // of the last freeze, which the thaws of the host refer to
+};
+
+// Returns the maximum number of delay frames of an engine configuration, or zero if disabled.
+inline uint32_t GetMaxDelayFrameCount(const BarelyEngineConfig& config) noexcept {
+  if ((config.effect_flags & BarelyEngineEffectFlags_kDelay) == 0 ||
+      !(config.max_delay_time > 0.0f)) {
+    return 0;
+  }
+  return std::bit_ceil(static_cast<uint32_t>(std::ceil(
+      static_cast<float>(config.sample_rate) *
+      std::min(config.max_delay_time,
+               kEngineControls[BarelyEngineControlType_kDelayTime].max_value))));
+}
+
+// Returns the number of freeze frames of an engine configuration, or zero if disabled.
+inline uint32_t GetFreezeFrameCount(const BarelyEngineConfig& config) noexcept {
+  return static_cast<uint32_t>(std::max(config.freeze_frame_count, 0));
+}
+
+// Returns whether an engine configuration stores the effect lines in half precision.
+inline bool IsCompactEffects(const BarelyEngineConfig& config) noexcept {
+  return (config.memory_flags & BarelyEngineMemoryFlags_kCompactEffects) != 0;
+}
+
+struct EngineState;
+
+// Larger pool arrays to grow an engine into, which are allocated from a chained arena. Each pool is
+// left empty unless its new count exceeds the current one.
+struct EnginePoolStorage {
+  EnginePoolStorage(Arena& arena, const EngineState& engine, uint32_t slice_count,
+                    uint32_t task_count, uint32_t voice_count) noexcept;
+  EnginePoolStorage(Arena& arena, uint32_t slice_count, uint32_t task_count,
+                    uint32_t voice_count) noexcept;
+
+  SlicePool slice_pool;
+  Pool<TaskState> task_pool;
+  VoicePool voice_pool;
+
+  uint32_t* task_generations = nullptr;
+  uint32_t* sorted_task_indices = nullptr;
+  TaskEdit* task_edits = nullptr;
 };
 
 struct EngineState {
   EngineState(Arena& arena, const BarelyEngineConfig& config) noexcept
-      : delay_filter(arena, std::bit_ceil(static_cast<uint32_t>(std::ceil(
-                                static_cast<float>(config.sample_rate) *
-                                kEngineControls[BarelyEngineControlType_kDelayTime].max_value)))),
-        reverb(arena, static_cast<float>(config.sample_rate)),
+      : delay_filter(arena, GetMaxDelayFrameCount(config), IsCompactEffects(config)),
+        reverb(arena, static_cast<float>(config.sample_rate),
+               (config.effect_flags & BarelyEngineEffectFlags_kReverb) != 0,
+               IsCompactEffects(config)),
 
         instrument_pool(arena, config.max_instrument_count),
         performer_pool(arena, config.max_performer_count),
         task_pool(arena, config.max_task_count),
         voice_pool(arena, config.max_voice_count),
         slice_pool(arena, config.max_slice_count),
+        render_cache(arena, static_cast<uint32_t>(std::max(config.render_cache_frame_count, 0))),
+        freeze_frames(arena.AllocBuffer<FreezeFrame>(GetFreezeFrameCount(config))),
+        frozen_instrument_indices(arena.AllocBuffer<uint32_t>(
+            (GetFreezeFrameCount(config) > 0) ? static_cast<uint32_t>(config.max_instrument_count)
+                                              : 0)),
+
+        task_event_queue(arena, config.max_performer_count),
 
         cmd_queue(arena, std::bit_ceil(static_cast<uint32_t>(config.max_command_count))),
 
         instrument_generations(arena.AllocArray<uint32_t>(config.max_instrument_count)),
         performer_generations(arena.AllocArray<uint32_t>(config.max_performer_count)),
         task_generations(arena.AllocArray<uint32_t>(config.max_task_count)),
+        sorted_task_indices(arena.AllocArray<uint32_t>(config.max_task_count)),
+        task_edits(arena.AllocArray<TaskEdit>(config.max_task_count)),
 
         instrument_params(arena.AllocArray<InstrumentParams>(config.max_instrument_count)),
         queued_sample_data_counts(
-            arena.AllocArray<std::atomic<int32_t>>(config.max_instrument_count)),
-        temp_samples(arena.AllocArray<float>(kStereoChannelCount * config.max_frame_count)),
+            arena.AllocBuffer<std::atomic<int32_t>>(config.max_instrument_count)),
+        host_thawed_freeze_generations(
+            arena.AllocBuffer<std::atomic<uint32_t>>(config.max_instrument_count)),
+        temp_samples(arena.AllocBuffer<float>(kStereoChannelCount * config.max_frame_count)),
 
         sample_rate(static_cast<float>(config.sample_rate)),
         smoothing_coeff(GetCoefficient(sample_rate, /*50ms*/ 0.05f)),
@@ -64,16 +132,28 @@ struct EngineState {
         id_index_mask((1u << id_index_bit_count) - 1u),
         id_generation_mask((1u << (32u - id_index_bit_count)) - 1u),
 
-        max_frame_count(static_cast<uint32_t>(config.max_frame_count)) {
+        max_frame_count(static_cast<uint32_t>(config.max_frame_count)),
+        max_instrument_count(static_cast<uint32_t>(config.max_instrument_count)),
+        max_voice_count(static_cast<uint32_t>(config.max_voice_count)),
+        freeze_frame_count(GetFreezeFrameCount(config)),
+        is_delay_enabled(GetMaxDelayFrameCount(config) > 0),
+        is_reverb_enabled((config.effect_flags & BarelyEngineEffectFlags_kReverb) != 0),
+        is_compact_effects(IsCompactEffects(config)),
+        voice_capacity(static_cast<uint32_t>(config.max_voice_count)) {
     assert(id_index_bit_count < 32);
     assert(sample_rate > 0.0f);
+    if (config.seed >= 0) {
+      main_rng.ResetSeed(config.seed);
+    }
+    audio_seed = static_cast<uint32_t>(main_rng.GetSeed());
   }
 
   MainRng main_rng;
-  AudioRng audio_rng;
+  EffectParams target_params = {};
 
+  // Audio thread state, which starts on a new cache line away from the control thread state.
+  alignas(kCacheLineSize) uint32_t audio_seed = 0;  // of the random stream of each voice
   EffectParams current_params = {};
-  EffectParams target_params = {};
 
   Compressor comp = {};
   Sidechain sidechain = {};
@@ -81,26 +161,48 @@ struct EngineState {
   DelayFilter delay_filter;
   Reverb reverb;
 
-  Pool<InstrumentState> instrument_pool;
+  // Control thread pools.
+  alignas(kCacheLineSize) Pool<InstrumentState> instrument_pool;
   Pool<PerformerState> performer_pool;
   Pool<TaskState> task_pool;
-  Pool<VoiceState> voice_pool;
+
+  // Audio thread pools.
+  alignas(kCacheLineSize) VoicePool voice_pool;
 
   SlicePool slice_pool;
 
+  RenderCache render_cache;
+
+  FreezeFrame* freeze_frames = nullptr;
+  uint32_t* frozen_instrument_indices = nullptr;  // of the audio thread
+  uint32_t frozen_instrument_count = 0;
+
+  // Control thread state.
+  alignas(kCacheLineSize) TaskEventQueue task_event_queue;
+  std::optional<int32_t> task_event_min_priority;  // of the task events at the current beat
+
   CmdQueue cmd_queue;
 
+  TempoMap tempo_map;
+
+  uint32_t freeze_generation = 0;  // incremented in each instrument freeze
+
   uint32_t* instrument_generations = nullptr;
   uint32_t* performer_generations = nullptr;
   uint32_t* task_generations = nullptr;
 
+  uint32_t* sorted_task_indices = nullptr;  // scratch to create tasks in batches
+  TaskEdit* task_edits = nullptr;           // deferred while updating the active tasks
+
   InstrumentParams* instrument_params = nullptr;
 
   std::atomic<int32_t>* queued_sample_data_counts = nullptr;  // queued commands per instrument
+  // Freeze generation per instrument that the events of the host thawed last, or zero if none.
+  std::atomic<uint32_t>* host_thawed_freeze_generations = nullptr;
 
   float* temp_samples = nullptr;
 
-  double tempo = 120.0;      // beats per minute
+  double beat = 0.0;         // beats
   double timestamp = 0.0;    // seconds
   float sample_rate = 0.0f;  // hertz
 
@@ -111,8 +213,20 @@ struct EngineState {
   uint32_t id_generation_mask = 0;
 
   uint32_t max_frame_count = 0;
+  uint32_t max_instrument_count = 0;
+  uint32_t max_voice_count = 0;  // of the control thread, which leads the audio thread voice pool
+  uint32_t freeze_frame_count = 0;
+
+  bool is_delay_enabled = false;
+  bool is_reverb_enabled = false;
+  bool is_compact_effects = false;
+
+  alignas(kCacheLineSize) std::atomic_bool process_fence;
 
-  std::atomic_bool process_fence;
+  // Voice pool usage that is published by the audio thread after each process.
+  std::atomic<uint32_t> active_voice_count = 0;
+  std::atomic<uint32_t> max_active_voice_count = 0;
+  std::atomic<uint32_t> voice_capacity = 0;
 
   void Approach() noexcept {
     current_params.comp_params.Approach(target_params.comp_params, smoothing_coeff);
@@ -126,13 +240,69 @@ struct EngineState {
     cmd_queue.Add(SecondsToFrames(sample_rate, timestamp), cmd);
   }
 
-  [[nodiscard]] uint32_t SelectSlice(uint32_t instrument_index, uint32_t first_slice_index,
-                                     float pitch) noexcept {
+  [[nodiscard]] uint32_t SelectSlice(uint32_t instrument_index, float pitch,
+                                     AudioRng& rng) const noexcept {
     if (instrument_index == kInvalidIndex ||
         queued_sample_data_counts[instrument_index].load(std::memory_order_acquire) > 0) {
       return kInvalidIndex;
     }
-    return slice_pool.Select(first_slice_index, pitch, audio_rng);
+    const InstrumentParams& params = instrument_params[instrument_index];
+    return (params.sample_bank != nullptr)
+               ? params.sample_bank->Select(pitch, rng)
+               : slice_pool.Select(params.first_slice_index, pitch, rng);
+  }
+
+  // Thaws an instrument, which restarts the notes of the active clip tasks of its frozen performer.
+  void ThawInstrument(uint32_t instrument_index) noexcept {
+    InstrumentState& instrument = GetInstrument(instrument_index);
+    if (instrument.frozen_performer_index == kInvalidIndex) {
+      return;
+    }
+    PerformerState& performer = GetPerformer(instrument.frozen_performer_index);
+    --performer.frozen_instrument_count;
+    instrument.frozen_performer_index = kInvalidIndex;
+    ScheduleCmd(InstrumentThawCmd{instrument_index});
+
+    const uint32_t instrument_id =
+        BuildId(instrument_index, instrument_generations[instrument_index]);
+    for (uint32_t task_index = performer.active_tasks.GetFirst(task_pool);
+         task_index != kInvalidIndex;
+         task_index = performer.active_tasks.GetNext(task_pool, task_index)) {
+      if (const TaskState& task = GetTask(task_index); task.instrument_id == instrument_id) {
+        ScheduleCmd(NoteOnCmd{instrument_index, task.pitch});
+        if (task.gain != 1.0f) {
+          ScheduleCmd(
+              NoteControlCmd{instrument_index, task.pitch, BarelyNoteControlType_kGain, task.gain});
+        }
+      }
+    }
+  }
+
+  // Catches up with the instruments that the events of the host thawed in the audio thread.
+  void ThawHostThawedInstruments() noexcept {
+    for (uint32_t i = 0; i < instrument_pool.ActiveCount(); ++i) {
+      if (const uint32_t instrument_index = instrument_pool.GetActive(i);
+          IsHostThawedInstrument(instrument_index)) {
+        ThawInstrument(instrument_index);
+      }
+    }
+  }
+
+  // Thaws all instruments that are frozen with a performer, or with any performer if invalid.
+  void ThawInstruments(uint32_t performer_index = kInvalidIndex) noexcept {
+    if (performer_index != kInvalidIndex &&
+        GetPerformer(performer_index).frozen_instrument_count == 0) {
+      return;
+    }
+    for (uint32_t i = 0; i < instrument_pool.ActiveCount(); ++i) {
+      const uint32_t instrument_index = instrument_pool.GetActive(i);
+      if (const uint32_t frozen_performer_index =
+              GetInstrument(instrument_index).frozen_performer_index;
+          frozen_performer_index != kInvalidIndex &&
+          (performer_index == kInvalidIndex || frozen_performer_index == performer_index)) {
+        ThawInstrument(instrument_index);
+      }
+    }
   }
 
   [[nodiscard]] uint32_t BuildId(uint32_t index, uint32_t generation) const noexcept {
@@ -149,13 +319,34 @@ struct EngineState {
     return (generation + 1) & id_generation_mask;
   }
 
+  [[nodiscard]] bool IsFrozenInstrument(uint32_t instrument_index) const noexcept {
+    return GetInstrument(instrument_index).frozen_performer_index != kInvalidIndex &&
+           !IsHostThawedInstrument(instrument_index);
+  }
+
+  // Returns whether the events of the host thawed the current freeze of an instrument, where the
+  // thaws of its earlier freezes are ignored.
+  [[nodiscard]] bool IsHostThawedInstrument(uint32_t instrument_index) const noexcept {
+    const InstrumentState& instrument = GetInstrument(instrument_index);
+    return instrument.frozen_performer_index != kInvalidIndex &&
+           host_thawed_freeze_generations[instrument_index].load(std::memory_order_acquire) ==
+               instrument.freeze_generation;
+  }
+
+  [[nodiscard]] bool IsValidInstrument(uint32_t instrument_id) const noexcept {
+    const uint32_t instrument_index = GetIdIndex(instrument_id);
+    return instrument_pool.IsActive(instrument_index) &&
+           GetIdGeneration(instrument_id) == instrument_generations[instrument_index];
+  }
+
   [[nodiscard]] const SliceState* GetSlice(uint32_t instrument_index,
                                            uint32_t slice_index) const noexcept {
     if (instrument_index == kInvalidIndex ||
         queued_sample_data_counts[instrument_index].load(std::memory_order_acquire) > 0) {
       return nullptr;
     }
-    return slice_pool.Get(slice_index);
+    const SampleBankState* sample_bank = instrument_params[instrument_index].sample_bank;
+    return (sample_bank != nullptr) ? sample_bank->Get(slice_index) : slice_pool.Get(slice_index);
   }
 
   [[nodiscard]] InstrumentState& GetInstrument(uint32_t instrument_index) noexcept {
@@ -180,13 +371,102 @@ struct EngineState {
   }
 
   [[nodiscard]] VoiceState& GetVoice(uint32_t voice_index) noexcept {
-    return voice_pool.Get(voice_index);
+    return voice_pool.GetState(voice_index);
   }
   [[nodiscard]] const VoiceState& GetVoice(uint32_t voice_index) const noexcept {
-    return voice_pool.Get(voice_index);
+    return voice_pool.GetState(voice_index);
+  }
+
+  [[nodiscard]] VoiceNoteState& GetVoiceNote(uint32_t voice_index) noexcept {
+    return voice_pool.GetNote(voice_index);
+  }
+  [[nodiscard]] const VoiceNoteState& GetVoiceNote(uint32_t voice_index) const noexcept {
+    return voice_pool.GetNote(voice_index);
   }
 };
 
+// Returns the memory breakdown of an engine configuration, which leaves out the total size.
+inline BarelyEngineMemoryBreakdown GetMemoryBreakdown(const BarelyEngineConfig& config) noexcept {
+  const auto get_size = [](const auto& alloc) noexcept {
+    Arena arena;  // sizing arena
+    alloc(arena);
+    return static_cast<int32_t>(arena.offset());
+  };
+  const uint32_t instrument_count = static_cast<uint32_t>(config.max_instrument_count);
+  const uint32_t performer_count = static_cast<uint32_t>(config.max_performer_count);
+  const uint32_t task_count = static_cast<uint32_t>(config.max_task_count);
+
+  BarelyEngineMemoryBreakdown memory_breakdown = {};
+  memory_breakdown.instrument_pool_size = get_size([&](Arena& arena) noexcept {
+    [[maybe_unused]] const Pool<InstrumentState> instrument_pool(arena, instrument_count);
+    arena.AllocArray<uint32_t>(instrument_count);
+    arena.AllocArray<InstrumentParams>(instrument_count);
+    arena.AllocBuffer<std::atomic<int32_t>>(instrument_count);
+    arena.AllocBuffer<std::atomic<uint32_t>>(instrument_count);
+  });
+  memory_breakdown.performer_pool_size = get_size([&](Arena& arena) noexcept {
+    [[maybe_unused]] const Pool<PerformerState> performer_pool(arena, performer_count);
+    [[maybe_unused]] const TaskEventQueue task_event_queue(arena, performer_count);
+    arena.AllocArray<uint32_t>(performer_count);
+  });
+  memory_breakdown.task_pool_size = get_size([&](Arena& arena) noexcept {
+    [[maybe_unused]] const Pool<TaskState> task_pool(arena, task_count);
+    arena.AllocArray<uint32_t>(task_count);
+    arena.AllocArray<uint32_t>(task_count);
+    arena.AllocArray<TaskEdit>(task_count);
+  });
+  memory_breakdown.voice_pool_size = get_size([&](Arena& arena) noexcept {
+    [[maybe_unused]] const VoicePool voice_pool(
+        arena, static_cast<uint32_t>(config.max_voice_count));
+  });
+  memory_breakdown.slice_pool_size = get_size([&](Arena& arena) noexcept {
+    [[maybe_unused]] const SlicePool slice_pool(arena,
+                                                static_cast<uint32_t>(config.max_slice_count));
+  });
+  memory_breakdown.command_queue_size = get_size([&](Arena& arena) noexcept {
+    [[maybe_unused]] const CmdQueue cmd_queue(
+        arena, std::bit_ceil(static_cast<uint32_t>(config.max_command_count)));
+  });
+  memory_breakdown.delay_size = get_size([&](Arena& arena) noexcept {
+    [[maybe_unused]] const DelayFilter delay_filter(arena, GetMaxDelayFrameCount(config),
+                                                    IsCompactEffects(config));
+  });
+  memory_breakdown.reverb_size = get_size([&](Arena& arena) noexcept {
+    [[maybe_unused]] const Reverb reverb(
+        arena, static_cast<float>(config.sample_rate),
+        (config.effect_flags & BarelyEngineEffectFlags_kReverb) != 0, IsCompactEffects(config));
+  });
+  memory_breakdown.scratch_size = get_size([&](Arena& arena) noexcept {
+    arena.AllocBuffer<float>(kStereoChannelCount * static_cast<size_t>(config.max_frame_count));
+  });
+  memory_breakdown.render_cache_size = get_size([&](Arena& arena) noexcept {
+    [[maybe_unused]] const RenderCache render_cache(
+        arena, static_cast<uint32_t>(std::max(config.render_cache_frame_count, 0)));
+  });
+  memory_breakdown.freeze_size = get_size([&](Arena& arena) noexcept {
+    const uint32_t freeze_frame_count = GetFreezeFrameCount(config);
+    arena.AllocBuffer<FreezeFrame>(freeze_frame_count);
+    arena.AllocBuffer<uint32_t>((freeze_frame_count > 0) ? instrument_count : 0);
+  });
+  return memory_breakdown;
+}
+
+inline EnginePoolStorage::EnginePoolStorage(Arena& arena, const EngineState& engine,
+                                            uint32_t slice_count, uint32_t task_count,
+                                            uint32_t voice_count) noexcept
+    : EnginePoolStorage(arena, (slice_count > engine.slice_pool.Count()) ? slice_count : 0,
+                        (task_count > engine.task_pool.Count()) ? task_count : 0,
+                        (voice_count > engine.max_voice_count) ? voice_count : 0) {}
+
+inline EnginePoolStorage::EnginePoolStorage(Arena& arena, uint32_t slice_count, uint32_t task_count,
+                                            uint32_t voice_count) noexcept
+    : slice_pool(arena, slice_count),
+      task_pool(arena, task_count),
+      voice_pool(arena, voice_count),
+      task_generations(arena.AllocArray<uint32_t>(task_count)),
+      sorted_task_indices(arena.AllocArray<uint32_t>(task_count)),
+      task_edits(arena.AllocArray<TaskEdit>(task_count)) {}
+
 }  // namespace barely
 
 #endif  // BARELYMUSICIAN_ENGINE_ENGINE_STATE_H_
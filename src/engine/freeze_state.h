@@ -0,0 +1,77 @@
+#ifndef BARELYMUSICIAN_ENGINE_FREEZE_STATE_H_
+#define BARELYMUSICIAN_ENGINE_FREEZE_STATE_H_
+
+#include <cassert>
+#include <cstdint>
+
+#include "core/constants.h"
+
+namespace barely {
+
+// Frame of the frozen output of an instrument, which holds its sends along with its output.
+struct FreezeFrame {
+  float delay[kStereoChannelCount] = {};
+  float reverb[kStereoChannelCount] = {};
+  float sidechain[kStereoChannelCount] = {};
+  float output[kStereoChannelCount] = {};
+};
+
+// Frozen output of an instrument, which is recorded for one performer loop while the instrument
+// plays live, and then looped back in place of its voices.
+struct FreezeState {
+  FreezeFrame* frames = nullptr;
+  uint32_t frame_count = 0;
+
+  // Loop length in frames, which is at most the number of frames.
+  double loop_frame_count = 0.0;
+
+  // Recorded frame, or the playback position in frames.
+  double position = 0.0;
+
+  bool is_recording = false;
+
+  // Starts recording into a range of frames.
+  void Start(FreezeFrame* new_frames, uint32_t new_frame_count,
+             double new_loop_frame_count) noexcept {
+    assert(new_frames != nullptr);
+    assert(new_loop_frame_count >= 1.0);
+    assert(new_loop_frame_count <= static_cast<double>(new_frame_count));
+    frames = new_frames;
+    frame_count = new_frame_count;
+    loop_frame_count = new_loop_frame_count;
+    position = 0.0;
+    is_recording = true;
+    frames[0] = {};
+  }
+
+  // Advances to the next frame, and returns true if that completes the recording.
+  [[nodiscard]] bool Advance() noexcept {
+    position += 1.0;
+    if (is_recording) {
+      if (position < static_cast<double>(frame_count)) {
+        frames[static_cast<uint32_t>(position)] = {};
+        return false;
+      }
+      // Continue from the same point of the loop, which the frames were recorded one loop before.
+      position -= loop_frame_count;
+      is_recording = false;
+      return true;
+    }
+    if (position >= loop_frame_count) {
+      position -= loop_frame_count;
+    }
+    return false;
+  }
+
+  [[nodiscard]] FreezeFrame& GetFrame() const noexcept {
+    assert(frames != nullptr);
+    return frames[static_cast<uint32_t>(position)];
+  }
+
+  [[nodiscard]] bool IsFrozen() const noexcept { return frames != nullptr; }
+  [[nodiscard]] bool IsPlaying() const noexcept { return frames != nullptr && !is_recording; }
+};
+
+}  // namespace barely
+
+#endif  // BARELYMUSICIAN_ENGINE_FREEZE_STATE_H_
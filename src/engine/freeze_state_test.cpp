@@ -0,0 +1,40 @@
+#include "engine/freeze_state.h"
+
+#include <array>
+
+#include "gtest/gtest.h"
+
+namespace barely {
+namespace {
+
+TEST(FreezeStateTest, RecordAndPlay) {
+  constexpr double kLoopFrameCount = 2.5;
+  constexpr int kFrameCount = 3;
+
+  std::array<FreezeFrame, kFrameCount> frames;
+  FreezeState freeze;
+  EXPECT_FALSE(freeze.IsFrozen());
+
+  freeze.Start(frames.data(), kFrameCount, kLoopFrameCount);
+  EXPECT_TRUE(freeze.IsFrozen());
+  EXPECT_FALSE(freeze.IsPlaying());
+
+  // Record each frame.
+  for (int i = 0; i < kFrameCount; ++i) {
+    EXPECT_FLOAT_EQ(freeze.GetFrame().output[0], 0.0f);
+    freeze.GetFrame().output[0] = static_cast<float>(i + 1);
+    EXPECT_EQ(freeze.Advance(), i + 1 == kFrameCount);
+  }
+  EXPECT_TRUE(freeze.IsPlaying());
+
+  // Play back from the same point of the loop, where each loop is `kLoopFrameCount` frames long.
+  constexpr std::array<float, 10> kOutputs = {1.0f, 2.0f, 1.0f, 2.0f, 3.0f,
+                                              1.0f, 2.0f, 1.0f, 2.0f, 3.0f};
+  for (const float output : kOutputs) {
+    EXPECT_FLOAT_EQ(freeze.GetFrame().output[0], output);
+    EXPECT_FALSE(freeze.Advance());
+  }
+}
+
+}  // namespace
+}  // namespace barely
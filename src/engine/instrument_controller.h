@@ -5,6 +5,7 @@
 
 #include <atomic>
 #include <cassert>
+#include <cmath>
 #include <cstdint>
 
 #include "core/constants.h"
@@ -14,6 +15,7 @@
 #include "engine/cmd.h"
 #include "engine/cmd_queue.h"
 #include "engine/engine_state.h"
+#include "engine/sample_bank_state.h"
 
 namespace barely {
 
@@ -26,7 +28,9 @@ class InstrumentController {
     if (instrument_index != kInvalidIndex) {
       auto& instrument = engine_.GetInstrument(instrument_index);
       instrument = {};
-      engine_.ScheduleCmd(InstrumentCreateCmd{instrument_index});
+      engine_.ScheduleCmd(InstrumentCreateCmd{
+          instrument_index,
+          engine_.BuildId(instrument_index, engine_.instrument_generations[instrument_index])});
     }
     return instrument_index;
   }
@@ -35,14 +39,68 @@ class InstrumentController {
     engine_.queued_sample_data_counts[instrument_index].fetch_add(1, std::memory_order_acq_rel);
     while (engine_.process_fence.load(std::memory_order_acquire));  // busy wait until next process.
     auto& instrument = engine_.GetInstrument(instrument_index);
+    if (instrument.frozen_performer_index != kInvalidIndex) {
+      --engine_.GetPerformer(instrument.frozen_performer_index).frozen_instrument_count;
+    }
     engine_.slice_pool.Release(instrument.first_slice_index);
+    if (instrument.sample_bank != nullptr) {
+      instrument.sample_bank->RemoveReference();
+    }
     engine_.ScheduleCmd(InstrumentDestroyCmd{instrument_index});
     engine_.instrument_pool.Release(instrument_index);
   }
 
+  // Freezes an instrument with the clip notes of a performer, which records the next loop of the
+  // performer into a free range of the freeze frames.
+  [[nodiscard]] bool Freeze(uint32_t instrument_index, uint32_t performer_index) noexcept {
+    const auto& performer = engine_.GetPerformer(performer_index);
+    if (!performer.is_playing || !performer.is_looping || !(performer.loop_length > 0.0)) {
+      return false;
+    }
+    const double loop_frame_count =
+        engine_.sample_rate *
+        (engine_.tempo_map.GetTimestamp(engine_.timestamp, performer.loop_length) -
+         engine_.timestamp);
+    if (!(loop_frame_count >= 1.0 &&
+          loop_frame_count <= static_cast<double>(engine_.freeze_frame_count))) {
+      return false;
+    }
+    engine_.ThawInstrument(instrument_index);
+
+    // Find the first range of frames that no other frozen instrument uses.
+    const uint32_t frame_count = static_cast<uint32_t>(std::ceil(loop_frame_count));
+    uint32_t first_frame = 0;
+    for (bool is_overlapping = true; is_overlapping;) {
+      is_overlapping = false;
+      for (uint32_t i = 0; i < engine_.instrument_pool.ActiveCount(); ++i) {
+        const auto& other = engine_.GetInstrument(engine_.instrument_pool.GetActive(i));
+        if (other.frozen_performer_index != kInvalidIndex &&
+            other.first_freeze_frame < first_frame + frame_count &&
+            first_frame < other.first_freeze_frame + other.freeze_frame_count) {
+          first_frame = other.first_freeze_frame + other.freeze_frame_count;
+          is_overlapping = true;
+        }
+      }
+    }
+    if (first_frame + frame_count > engine_.freeze_frame_count) {
+      return false;
+    }
+
+    auto& instrument = engine_.GetInstrument(instrument_index);
+    instrument.frozen_performer_index = performer_index;
+    instrument.first_freeze_frame = first_frame;
+    instrument.freeze_frame_count = frame_count;
+    instrument.freeze_generation = ++engine_.freeze_generation;
+    ++engine_.GetPerformer(performer_index).frozen_instrument_count;
+    engine_.ScheduleCmd(InstrumentFreezeCmd{instrument_index, first_frame, loop_frame_count,
+                                            instrument.freeze_generation});
+    return true;
+  }
+
   void SetControl(uint32_t instrument_index, BarelyInstrumentControlType type,
                   float value) noexcept {
     assert(type <= BarelyInstrumentControlType_kCount);
+    engine_.ThawInstrument(instrument_index);
     engine_.ScheduleCmd(
         InstrumentControlCmd{instrument_index, type, kInstrumentControls[type].Clamp(value)});
   }
@@ -50,30 +108,52 @@ class InstrumentController {
   void SetNoteControl(uint32_t instrument_index, float pitch, BarelyNoteControlType type,
                       float value) noexcept {
     assert(type <= BarelyNoteControlType_kCount);
+    engine_.ThawInstrument(instrument_index);
     engine_.ScheduleCmd(
         NoteControlCmd{instrument_index, pitch, type, kNoteControls[type].Clamp(value)});
   }
 
   void SetNoteOff(uint32_t instrument_index, float pitch) noexcept {
+    engine_.ThawInstrument(instrument_index);
     engine_.ScheduleCmd(NoteOffCmd{instrument_index, pitch});
   }
 
   void SetNoteOn(uint32_t instrument_index, float pitch) noexcept {
+    engine_.ThawInstrument(instrument_index);
     engine_.ScheduleCmd(NoteOnCmd{instrument_index, pitch});
   }
 
+  void SetSampleBank(uint32_t instrument_index, SampleBankState* sample_bank) noexcept {
+    SetSampleData(instrument_index, sample_bank, nullptr, 0);
+  }
+
   void SetSampleData(uint32_t instrument_index, const BarelySlice* slices,
                      int32_t slice_count) noexcept {
+    SetSampleData(instrument_index, nullptr, slices, slice_count);
+  }
+
+ private:
+  // Replaces the sample data with either a shared sample bank, or a copy of the slices.
+  void SetSampleData(uint32_t instrument_index, SampleBankState* sample_bank,
+                     const BarelySlice* slices, int32_t slice_count) noexcept {
+    engine_.ThawInstrument(instrument_index);
     engine_.queued_sample_data_counts[instrument_index].fetch_add(1, std::memory_order_acq_rel);
     while (engine_.process_fence.load(std::memory_order_acquire));  // busy wait until next process.
     auto& instrument = engine_.GetInstrument(instrument_index);
     engine_.slice_pool.Release(instrument.first_slice_index);
+    if (instrument.sample_bank != nullptr) {
+      instrument.sample_bank->RemoveReference();
+    }
+    if (sample_bank != nullptr) {
+      sample_bank->AddReference();
+    }
+    instrument.sample_bank = sample_bank;
     instrument.first_slice_index =
         engine_.slice_pool.Acquire(slices, static_cast<uint32_t>(slice_count));
-    engine_.ScheduleCmd(SampleDataCmd{instrument_index, instrument.first_slice_index});
+    engine_.ScheduleCmd(
+        SampleDataCmd{instrument_index, instrument.first_slice_index, instrument.sample_bank});
   }
 
- private:
   EngineState& engine_;
 };
 
@@ -11,12 +11,22 @@
 #include "core/constants.h"
 #include "core/control.h"
 #include "dsp/sample_generators.h"
+#include "engine/render_cache.h"
 
 namespace barely {
 
 void InstrumentProcessor::SetControl(uint32_t instrument_index, BarelyInstrumentControlType type,
                                      float value) noexcept {
   auto& params = engine_.instrument_params[instrument_index];
+  if (type != BarelyInstrumentControlType_kGain && type != BarelyInstrumentControlType_kStereoPan &&
+      type != BarelyInstrumentControlType_kDelaySend &&
+      type != BarelyInstrumentControlType_kReverbSend &&
+      type != BarelyInstrumentControlType_kSidechainSend &&
+      type != BarelyInstrumentControlType_kRetrigger &&
+      type != BarelyInstrumentControlType_kVoiceCount) {
+    // The recording would no longer match its key.
+    AbortRenderCacheRecording(instrument_index);
+  }
   switch (type) {
     case BarelyInstrumentControlType_kGain:
       params.voice_params.gain = value * value;
@@ -106,23 +116,27 @@ void InstrumentProcessor::SetControl(uint32_t instrument_index, BarelyInstrument
       uint32_t active_voice_count = 0;
       uint32_t active_voice_index = params.first_voice_index;
       while (active_voice_index != kInvalidIndex && active_voice_count <= new_voice_count) {
-        active_voice_index = engine_.GetVoice(active_voice_index).next_voice_index;
+        active_voice_index = engine_.GetVoiceNote(active_voice_index).next_voice_index;
         ++active_voice_count;
       }
       // Release the previously active voices beyond the new voice count.
       while (active_voice_index != kInvalidIndex) {
-        auto& voice = engine_.GetVoice(active_voice_index);
-        if (voice.prev_voice_index != kInvalidIndex) {
-          engine_.GetVoice(voice.prev_voice_index).next_voice_index = kInvalidIndex;
-          voice.prev_voice_index = kInvalidIndex;
+        auto& note = engine_.GetVoiceNote(active_voice_index);
+        if (note.prev_voice_index != kInvalidIndex) {
+          engine_.GetVoiceNote(note.prev_voice_index).next_voice_index = kInvalidIndex;
+          note.prev_voice_index = kInvalidIndex;
         }
-        const uint32_t next_voice_index = voice.next_voice_index;
-        voice.next_voice_index = kInvalidIndex;
+        const uint32_t next_voice_index = note.next_voice_index;
+        note.next_voice_index = kInvalidIndex;
+        EndRenderCache(engine_.GetVoice(active_voice_index), /*is_complete=*/false);
         engine_.voice_pool.Release(active_voice_index);
         active_voice_index = next_voice_index;
       }
       params.voice_count = new_voice_count;
     } break;
+    case BarelyInstrumentControlType_kRenderCache:
+      params.is_render_cache_enabled = static_cast<bool>(value);
+      break;
     default:
       assert(!"Invalid control type");
       return;
@@ -134,11 +148,11 @@ void InstrumentProcessor::SetNoteControl(uint32_t instrument_index, float pitch,
   auto& params = engine_.instrument_params[instrument_index];
   uint32_t voice_index = params.first_voice_index;
   while (voice_index != kInvalidIndex) {
-    const auto& voice = engine_.GetVoice(voice_index);
-    if (voice.pitch == pitch) {
+    const auto& note = engine_.GetVoiceNote(voice_index);
+    if (note.pitch == pitch) {
       break;
     }
-    voice_index = voice.next_voice_index;
+    voice_index = note.next_voice_index;
   }
   if (voice_index == kInvalidIndex) {
     return;
@@ -151,10 +165,15 @@ void InstrumentProcessor::SetNoteControl(uint32_t instrument_index, float pitch,
         voice.params.gain *= voice.note_params.gain;
       }
       break;
-    case BarelyNoteControlType_kPitchShift:
-      voice.pitch_shift = value;
-      voice.UpdatePitchIncrements(engine_.GetSlice(voice.instrument_index, voice.slice_index));
-      break;
+    case BarelyNoteControlType_kPitchShift: {
+      auto& note = engine_.GetVoiceNote(voice_index);
+      note.pitch_shift = value;
+      if (voice.is_render_cache_recording) {
+        EndRenderCache(voice, /*is_complete=*/false);
+      }
+      voice.UpdatePitchIncrements(engine_.GetSlice(voice.instrument_index, voice.slice_index),
+                                  note.GetShiftedPitch());
+    } break;
     default:
       assert(!"Invalid note control type");
       break;
@@ -165,17 +184,18 @@ void InstrumentProcessor::SetNoteOff(uint32_t instrument_index, float pitch) noe
   auto& params = engine_.instrument_params[instrument_index];
   uint32_t voice_index = params.first_voice_index;
   while (voice_index != kInvalidIndex) {
-    const auto& voice = engine_.GetVoice(voice_index);
-    if (voice.pitch == pitch) {
+    const auto& note = engine_.GetVoiceNote(voice_index);
+    if (note.pitch == pitch) {
       break;
     }
-    voice_index = voice.next_voice_index;
+    voice_index = note.next_voice_index;
   }
   if (voice_index == kInvalidIndex) {
     return;
   }
   auto& voice = engine_.GetVoice(voice_index);
-  if (params.first_slice_index == kInvalidIndex || params.slice_mode != BarelySliceMode_kOnce) {
+  if ((params.first_slice_index == kInvalidIndex && params.sample_bank == nullptr) ||
+      params.slice_mode != BarelySliceMode_kOnce) {
     voice.envelope.Stop();
   } else {
     voice.stop_on_slice_end = true;
@@ -184,26 +204,95 @@ void InstrumentProcessor::SetNoteOff(uint32_t instrument_index, float pitch) noe
 
 void InstrumentProcessor::SetNoteOn(uint32_t instrument_index, float pitch) noexcept {
   auto& params = engine_.instrument_params[instrument_index];
+  if (params.freeze.IsPlaying()) {
+    return;  // played back from the freeze frames.
+  }
   if (const uint32_t voice_index = AcquireVoice(params, pitch); voice_index != kInvalidIndex) {
     auto& voice = engine_.GetVoice(voice_index);
+    EndRenderCache(voice, /*is_complete=*/false);
     voice.instrument_index = instrument_index;
-    voice.slice_index = engine_.SelectSlice(instrument_index, params.first_slice_index, pitch);
-    voice.Start(params, engine_.GetSlice(instrument_index, voice.slice_index), pitch);
+    voice.rng.ResetSeed(CombineSeed(CombineSeed(engine_.audio_seed, instrument_index),
+                                    params.note_on_count++));
+    voice.slice_index = engine_.SelectSlice(instrument_index, pitch, voice.rng);
+    const SliceState* slice = engine_.GetSlice(instrument_index, voice.slice_index);
+    voice.Start(params, slice, pitch);
+    StartRenderCache(voice, params, slice);
+    auto& note = engine_.GetVoiceNote(voice_index);
+    note.pitch = pitch;
+    note.pitch_shift = 0.0f;
+    note.timestamp = 0;
   }
 }
 
-void InstrumentProcessor::SetSampleData(uint32_t instrument_index,
-                                        uint32_t first_slice_index) noexcept {
+void InstrumentProcessor::SetSampleData(uint32_t instrument_index, uint32_t first_slice_index,
+                                        const SampleBankState* sample_bank) noexcept {
   engine_.queued_sample_data_counts[instrument_index].fetch_sub(1, std::memory_order_acq_rel);
+  AbortRenderCacheRecording(instrument_index);
+  engine_.render_cache.Invalidate(instrument_index);
   auto& params = engine_.instrument_params[instrument_index];
   params.first_slice_index = first_slice_index;
+  params.sample_bank = sample_bank;
   uint32_t active_voice_index = params.first_voice_index;
   while (active_voice_index != kInvalidIndex) {
     auto& voice = engine_.GetVoice(active_voice_index);
-    voice.slice_index =
-        engine_.SelectSlice(instrument_index, params.first_slice_index, voice.pitch);
-    voice.UpdatePitchIncrements(engine_.GetSlice(instrument_index, voice.slice_index));
-    active_voice_index = voice.next_voice_index;
+    const auto& note = engine_.GetVoiceNote(active_voice_index);
+    voice.slice_index = engine_.SelectSlice(instrument_index, note.pitch, voice.rng);
+    voice.UpdatePitchIncrements(engine_.GetSlice(instrument_index, voice.slice_index),
+                                note.GetShiftedPitch());
+    active_voice_index = note.next_voice_index;
+  }
+}
+
+void InstrumentProcessor::AbortRenderCacheRecording(uint32_t instrument_index) noexcept {
+  if (engine_.render_cache.GetRecordingInstrumentIndex() != instrument_index) {
+    return;
+  }
+  uint32_t voice_index = engine_.instrument_params[instrument_index].first_voice_index;
+  while (voice_index != kInvalidIndex) {
+    if (auto& voice = engine_.GetVoice(voice_index); voice.is_render_cache_recording) {
+      EndRenderCache(voice, /*is_complete=*/false);
+      return;
+    }
+    voice_index = engine_.GetVoiceNote(voice_index).next_voice_index;
+  }
+}
+
+void InstrumentProcessor::StartRenderCache(VoiceState& voice, const InstrumentParams& params,
+                                           const SliceState* slice) noexcept {
+  // Only the one-shot slices without noise render the same output in each note.
+  if (!params.is_render_cache_enabled || !engine_.render_cache.IsEnabled() || slice == nullptr ||
+      params.slice_mode != BarelySliceMode_kOnce || params.voice_params.osc_noise_mix > 0.0f ||
+      !voice.envelope.IsStartFrame()) {
+    return;
+  }
+
+  // The gain, pan and sends are applied after the cached output.
+  VoiceParams voice_params = params.voice_params;
+  voice_params.gain = 1.0f;
+  voice_params.stereo_pan = 0.0f;
+  voice_params.delay_send = 0.0f;
+  voice_params.reverb_send = 0.0f;
+  voice_params.sidechain_send = 0.0f;
+
+  uint64_t key = kHashOffsetBasis;
+  key = HashValue(key, voice.instrument_index);
+  key = HashValue(key, voice_params);
+  key = HashValue(key, params.adsr);
+  key = HashValue(key, static_cast<int32_t>(params.osc_mode));
+  key = HashValue(key, params.osc_increment * voice.note_params.osc_increment);
+  key = HashValue(key, params.slice_increment * voice.note_params.slice_increment);
+  key = HashValue(key, slice->samples);
+  key = HashValue(key, slice->sample_count);
+
+  if (const uint32_t entry_index = engine_.render_cache.Find(key); entry_index != kInvalidIndex) {
+    engine_.render_cache.BeginPlaying();
+    voice.render_cache_entry_index = entry_index;
+    voice.render_cache_frame = 0;
+  } else if (const uint32_t recording_entry_index =
+                 engine_.render_cache.BeginRecording(key, voice.instrument_index);
+             recording_entry_index != kInvalidIndex) {
+    voice.is_render_cache_recording = true;
+    voice.render_cache_entry_index = recording_entry_index;
   }
 }
 
@@ -213,37 +302,37 @@ uint32_t InstrumentProcessor::AcquireVoice(InstrumentParams& params, float pitch
   uint32_t oldest_active_voice_index = current_voice_index;
   uint32_t active_voice_count = 0;
   while (current_voice_index != kInvalidIndex) {
-    auto& voice = engine_.GetVoice(current_voice_index);
-    if (voice.pitch == pitch) {
-      if (params.should_retrigger || !voice.envelope.IsOn()) {
+    auto& note = engine_.GetVoiceNote(current_voice_index);
+    if (note.pitch == pitch) {
+      if (params.should_retrigger || !engine_.GetVoice(current_voice_index).envelope.IsOn()) {
         const uint32_t retrigger_voice_index = current_voice_index;
         current_voice_index = params.first_voice_index;
         do {
-          auto& timestamp_voice = engine_.GetVoice(current_voice_index);
-          ++timestamp_voice.timestamp;
-          current_voice_index = timestamp_voice.next_voice_index;
+          auto& timestamp_note = engine_.GetVoiceNote(current_voice_index);
+          ++timestamp_note.timestamp;
+          current_voice_index = timestamp_note.next_voice_index;
         } while (current_voice_index != kInvalidIndex);
         return retrigger_voice_index;
       }
       return kInvalidIndex;  // already on.
     }
-    if (voice.timestamp > engine_.GetVoice(oldest_active_voice_index).timestamp) {
+    if (note.timestamp > engine_.GetVoiceNote(oldest_active_voice_index).timestamp) {
       oldest_active_voice_index = current_voice_index;
     }
-    ++voice.timestamp;
+    ++note.timestamp;
     ++active_voice_count;
     last_voice_index = current_voice_index;
-    current_voice_index = voice.next_voice_index;
+    current_voice_index = note.next_voice_index;
   }
 
   // Try to acquire a new voice.
   if (engine_.voice_pool.CanAcquire() && active_voice_count < params.voice_count) {
     const uint32_t new_voice_index = engine_.voice_pool.Acquire();
-    VoiceState& new_voice = engine_.GetVoice(new_voice_index);
-    new_voice.prev_voice_index = last_voice_index;
-    new_voice.next_voice_index = kInvalidIndex;
+    VoiceNoteState& new_note = engine_.GetVoiceNote(new_voice_index);
+    new_note.prev_voice_index = last_voice_index;
+    new_note.next_voice_index = kInvalidIndex;
     if (last_voice_index != kInvalidIndex) {
-      engine_.GetVoice(last_voice_index).next_voice_index = new_voice_index;
+      engine_.GetVoiceNote(last_voice_index).next_voice_index = new_voice_index;
     } else {
       params.first_voice_index = new_voice_index;
     }
@@ -14,6 +14,7 @@
 #include "dsp/sample_generators.h"
 #include "dsp/tone_filter.h"
 #include "engine/engine_state.h"
+#include "engine/freeze_state.h"
 #include "engine/params.h"
 #include "engine/slice_state.h"
 #include "engine/voice_state.h"
@@ -30,11 +31,14 @@ class InstrumentProcessor {
                       float value) noexcept;
   void SetNoteOff(uint32_t instrument_index, float pitch) noexcept;
   void SetNoteOn(uint32_t instrument_index, float pitch) noexcept;
-  void SetSampleData(uint32_t instrument_index, uint32_t first_slice_index) noexcept;
+  void SetSampleData(uint32_t instrument_index, uint32_t first_slice_index,
+                     const SampleBankState* sample_bank) noexcept;
 
-  void Init(uint32_t instrument_index) const noexcept {
+  void Init(uint32_t instrument_index, uint32_t instrument_id) const noexcept {
+    engine_.render_cache.Invalidate(instrument_index);
     InstrumentParams& instrument_params = engine_.instrument_params[instrument_index];
     instrument_params = {};
+    instrument_params.instrument_id = instrument_id;
     instrument_params.adsr.SetRelease(engine_.sample_rate, 0.0f);
     instrument_params.osc_increment = kReferenceFreq / engine_.sample_rate;
     instrument_params.slice_increment = 1.0f / engine_.sample_rate;
@@ -43,12 +47,43 @@ class InstrumentProcessor {
 
   void Shutdown(uint32_t instrument_index) const noexcept {
     engine_.queued_sample_data_counts[instrument_index].fetch_sub(1, std::memory_order_acq_rel);
+    engine_.instrument_params[instrument_index].instrument_id = 0;
+    Thaw(instrument_index);
+    engine_.render_cache.Invalidate(instrument_index);
     uint32_t voice_index = engine_.instrument_params[instrument_index].first_voice_index;
     while (voice_index != kInvalidIndex) {
       auto& voice = engine_.GetVoice(voice_index);
+      EndRenderCache(voice, /*is_complete=*/false);
       voice.slice_index = kInvalidIndex;
       voice.envelope.Stop();
-      voice_index = voice.next_voice_index;
+      voice_index = engine_.GetVoiceNote(voice_index).next_voice_index;
+    }
+  }
+
+  // Starts recording an instrument into the freeze frames, which get played back once recorded.
+  void Freeze(uint32_t instrument_index, uint32_t first_frame, double loop_frame_count,
+              uint32_t freeze_generation) const noexcept {
+    engine_.instrument_params[instrument_index].freeze_generation = freeze_generation;
+    FreezeState& freeze = engine_.instrument_params[instrument_index].freeze;
+    if (!freeze.IsFrozen()) {
+      engine_.frozen_instrument_indices[engine_.frozen_instrument_count++] = instrument_index;
+    }
+    freeze.Start(&engine_.freeze_frames[first_frame],
+                 static_cast<uint32_t>(std::ceil(loop_frame_count)), loop_frame_count);
+  }
+
+  void Thaw(uint32_t instrument_index) const noexcept {
+    FreezeState& freeze = engine_.instrument_params[instrument_index].freeze;
+    if (!freeze.IsFrozen()) {
+      return;
+    }
+    freeze = {};
+    uint32_t* frozen_instrument_indices = engine_.frozen_instrument_indices;
+    for (uint32_t i = 0; i < engine_.frozen_instrument_count; ++i) {
+      if (frozen_instrument_indices[i] == instrument_index) {
+        frozen_instrument_indices[i] = frozen_instrument_indices[--engine_.frozen_instrument_count];
+        break;
+      }
     }
   }
 
@@ -58,55 +93,119 @@ class InstrumentProcessor {
                         float sidechain_frame[kStereoChannelCount],
                         float output_frame[kStereoChannelCount]) noexcept {
     for (uint32_t i = 0; i < engine_.voice_pool.ActiveCount();) {
-      const uint32_t voice_index = engine_.voice_pool.GetActive(i);
-      VoiceState& voice = engine_.GetVoice(voice_index);
+      VoiceState& voice = engine_.voice_pool.GetActiveState(i);
       if constexpr (kIsSidechainSend) {
         if (!voice.envelope.IsActive()) {
-          ReleaseVoice(voice, engine_.instrument_params[voice.instrument_index]);
+          EndRenderCache(voice, /*is_complete=*/true);
+          const uint32_t voice_index = engine_.voice_pool.GetActive(i);
+          ReleaseVoice(voice_index, engine_.instrument_params[voice.instrument_index]);
           engine_.voice_pool.Release(voice_index);
           continue;
         }
       }
-      ProcessVoice<kIsSidechainSend>(voice, engine_.instrument_params[voice.instrument_index],
-                                     delay_frame, reverb_frame, sidechain_frame, output_frame);
+      if (const InstrumentParams& instrument_params =
+              engine_.instrument_params[voice.instrument_index];
+          instrument_params.freeze.is_recording) {
+        // Record the voice into its freeze frame, which gets mixed in with the frozen instruments.
+        FreezeFrame& freeze_frame = instrument_params.freeze.GetFrame();
+        ProcessVoice<kIsSidechainSend>(
+            voice, instrument_params, freeze_frame.delay, freeze_frame.reverb,
+            kIsSidechainSend ? freeze_frame.sidechain : sidechain_frame, freeze_frame.output);
+      } else {
+        ProcessVoice<kIsSidechainSend>(voice, instrument_params, delay_frame, reverb_frame,
+                                       sidechain_frame, output_frame);
+      }
       ++i;
     }
+    if (engine_.frozen_instrument_count > 0) {
+      ProcessAllFrozen<kIsSidechainSend>(delay_frame, reverb_frame, sidechain_frame, output_frame);
+    }
   }
 
  private:
   [[nodiscard]] uint32_t AcquireVoice(InstrumentParams& params, float pitch) noexcept;
 
-  void ReleaseVoice(VoiceState& voice, InstrumentParams& params) noexcept {
-    if (voice.prev_voice_index != kInvalidIndex) {
-      engine_.GetVoice(voice.prev_voice_index).next_voice_index = voice.next_voice_index;
-      if (voice.next_voice_index != kInvalidIndex) {
-        engine_.GetVoice(voice.next_voice_index).prev_voice_index = voice.prev_voice_index;
+  // Mixes in the current freeze frames, and advances them after the sidechain send pass.
+  template <bool kIsSidechainSend>
+  void ProcessAllFrozen(float delay_frame[kStereoChannelCount],
+                        float reverb_frame[kStereoChannelCount],
+                        float sidechain_frame[kStereoChannelCount],
+                        float output_frame[kStereoChannelCount]) noexcept {
+    for (uint32_t i = 0; i < engine_.frozen_instrument_count; ++i) {
+      const uint32_t instrument_index = engine_.frozen_instrument_indices[i];
+      FreezeState& freeze = engine_.instrument_params[instrument_index].freeze;
+      const FreezeFrame& freeze_frame = freeze.GetFrame();
+      for (int channel = 0; channel < kStereoChannelCount; ++channel) {
+        if constexpr (kIsSidechainSend) {
+          sidechain_frame[channel] += freeze_frame.sidechain[channel];
+        } else {
+          delay_frame[channel] += freeze_frame.delay[channel];
+          reverb_frame[channel] += freeze_frame.reverb[channel];
+          output_frame[channel] += freeze_frame.output[channel];
+        }
       }
-      voice.prev_voice_index = kInvalidIndex;
-    } else {
-      params.first_voice_index = voice.next_voice_index;
-      if (voice.next_voice_index != kInvalidIndex) {
-        engine_.GetVoice(voice.next_voice_index).prev_voice_index = kInvalidIndex;
+      if constexpr (!kIsSidechainSend) {
+        if (freeze.Advance()) {
+          // The recorded loop takes over from the voices.
+          ReleaseAllVoices(instrument_index);
+        }
       }
     }
-    voice.next_voice_index = kInvalidIndex;
   }
 
-  template <bool kIsSidechainSend = false>
-  void ProcessVoice(VoiceState& voice, const InstrumentParams& instrument_params,
-                    float delay_frame[kStereoChannelCount], float reverb_frame[kStereoChannelCount],
-                    float sidechain_frame[kStereoChannelCount],
-                    float output_frame[kStereoChannelCount]) noexcept {
-    if constexpr (kIsSidechainSend) {
-      if (voice.params.sidechain_send <= 0.0f) {
-        return;
+  void ReleaseAllVoices(uint32_t instrument_index) noexcept {
+    InstrumentParams& params = engine_.instrument_params[instrument_index];
+    while (params.first_voice_index != kInvalidIndex) {
+      const uint32_t voice_index = params.first_voice_index;
+      EndRenderCache(engine_.GetVoice(voice_index), /*is_complete=*/false);
+      ReleaseVoice(voice_index, params);
+      engine_.voice_pool.Release(voice_index);
+    }
+  }
+
+  // Aborts the render cache recording of an instrument, if any.
+  void AbortRenderCacheRecording(uint32_t instrument_index) noexcept;
+
+  // Ends the render cache recording or playback of a voice, which keeps the recording only if the
+  // voice played through.
+  void EndRenderCache(VoiceState& voice, bool is_complete) const noexcept {
+    if (voice.is_render_cache_recording) {
+      if (is_complete) {
+        engine_.render_cache.EndRecording();
+      } else {
+        engine_.render_cache.AbortRecording();
       }
+    } else if (voice.render_cache_entry_index != kInvalidIndex) {
+      engine_.render_cache.EndPlaying();
+    }
+    voice.is_render_cache_recording = false;
+    voice.render_cache_entry_index = kInvalidIndex;
+  }
+
+  // Starts playing a started voice from the render cache, or recording it, if it is a one-shot note
+  // of an instrument with the render cache enabled.
+  void StartRenderCache(VoiceState& voice, const InstrumentParams& params,
+                        const SliceState* slice) noexcept;
+
+  void ReleaseVoice(uint32_t voice_index, InstrumentParams& params) noexcept {
+    VoiceNoteState& note = engine_.GetVoiceNote(voice_index);
+    if (note.prev_voice_index != kInvalidIndex) {
+      engine_.GetVoiceNote(note.prev_voice_index).next_voice_index = note.next_voice_index;
+      if (note.next_voice_index != kInvalidIndex) {
+        engine_.GetVoiceNote(note.next_voice_index).prev_voice_index = note.prev_voice_index;
+      }
+      note.prev_voice_index = kInvalidIndex;
     } else {
-      if (voice.params.sidechain_send > 0.0f) {
-        return;
+      params.first_voice_index = note.next_voice_index;
+      if (note.next_voice_index != kInvalidIndex) {
+        engine_.GetVoiceNote(note.next_voice_index).prev_voice_index = kInvalidIndex;
       }
     }
+    note.next_voice_index = kInvalidIndex;
+  }
 
+  // Generates the next voice sample before its gain, pan and sends are applied.
+  float GenerateVoiceSample(VoiceState& voice, const InstrumentParams& instrument_params) noexcept {
     const SliceState* slice = engine_.GetSlice(voice.instrument_index, voice.slice_index);
 
     if (voice.stop_on_slice_end &&
@@ -134,7 +233,7 @@ class InstrumentProcessor {
     const float osc_sample =
         (1.0f - voice.params.osc_noise_mix) *
             GenerateOscSample(voice.params.osc_shape, skewed_osc_phase, osc_increment) +
-        voice.params.osc_noise_mix * engine_.audio_rng.Generate();
+        voice.params.osc_noise_mix * voice.rng.Generate();
     const float osc_output = voice.params.osc_mix * osc_sample;
 
     voice.osc_phase += osc_increment;
@@ -173,6 +272,41 @@ class InstrumentProcessor {
                                     voice.params.bit_crusher_increment);
     output = Distortion(output, voice.params.distortion_amount, voice.params.distortion_drive);
     output = voice.filter.Next(output, voice.params.filter_params);
+    return output;
+  }
+
+  template <bool kIsSidechainSend = false>
+  void ProcessVoice(VoiceState& voice, const InstrumentParams& instrument_params,
+                    float delay_frame[kStereoChannelCount], float reverb_frame[kStereoChannelCount],
+                    float sidechain_frame[kStereoChannelCount],
+                    float output_frame[kStereoChannelCount]) noexcept {
+    if constexpr (kIsSidechainSend) {
+      if (voice.params.sidechain_send <= 0.0f) {
+        return;
+      }
+    } else {
+      if (voice.params.sidechain_send > 0.0f) {
+        return;
+      }
+    }
+
+    float output = 0.0f;
+    if (voice.render_cache_entry_index != kInvalidIndex && !voice.is_render_cache_recording) {
+      // Play back the cached output, while the envelope keeps track of the note.
+      static_cast<void>(voice.envelope.Next());
+      output =
+          engine_.render_cache.GetFrame(voice.render_cache_entry_index, voice.render_cache_frame);
+      if (++voice.render_cache_frame ==
+          engine_.render_cache.GetFrameCount(voice.render_cache_entry_index)) {
+        voice.envelope.Reset();
+      }
+    } else {
+      output = GenerateVoiceSample(voice, instrument_params);
+      if (voice.is_render_cache_recording && !engine_.render_cache.Record(output)) {
+        voice.is_render_cache_recording = false;
+        voice.render_cache_entry_index = kInvalidIndex;
+      }
+    }
 
     output *= voice.params.gain;
 
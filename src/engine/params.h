@@ -12,6 +12,8 @@
 #include "dsp/envelope.h"
 #include "dsp/reverb.h"
 #include "dsp/tone_filter.h"
+#include "engine/freeze_state.h"
+#include "engine/sample_bank_state.h"
 
 namespace barely {
 
@@ -61,12 +63,19 @@ struct InstrumentParams {
   float osc_increment = 0.0f;
   float slice_increment = 0.0f;
 
+  const SampleBankState* sample_bank = nullptr;  // shared instead of the slices if set
   uint32_t first_slice_index = kInvalidIndex;
   uint32_t first_voice_index = kInvalidIndex;
 
+  uint32_t instrument_id = 0;  // of the audio thread, which validates the events of the host
   uint32_t voice_count = 8;
+  uint32_t note_on_count = 0;  // derives the random stream of each voice in order.
+
+  FreezeState freeze = {};  // played back instead of the voices once recorded
+  uint32_t freeze_generation = 0;
 
   bool should_retrigger = false;
+  bool is_render_cache_enabled = false;
 };
 
 }  // namespace barely
@@ -4,10 +4,18 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <utility>
 
 #include "core/constants.h"
+#include "core/control.h"
+#include "engine/cmd.h"
 #include "engine/performer_state.h"
+#include "engine/task_state.h"
 
 namespace barely {
 
@@ -21,27 +29,35 @@ uint32_t PerformerController::Acquire() noexcept {
 }
 
 void PerformerController::Release(uint32_t performer_index) noexcept {
+  engine_.ThawInstruments(performer_index);
   auto& performer = engine_.GetPerformer(performer_index);
 
-  uint32_t task_index = performer.first_active_task_index;
-  while (task_index != kInvalidIndex) {
-    auto& task = engine_.GetTask(task_index);
-    task.is_active = false;
-    task.callback(BarelyTaskEventType_kEnd);
-    const uint32_t next_task_index = task.next_task_index;
+  // Drop the deferred task edits, since all the tasks get released below.
+  for (uint32_t task_index = performer.first_edited_task_index; task_index != kInvalidIndex;
+       task_index = engine_.task_edits[task_index].next_task_index) {
+    engine_.task_edits[task_index].is_deferred = false;
+  }
+  performer.first_edited_task_index = kInvalidIndex;
+  performer.last_edited_task_index = kInvalidIndex;
+  performer.is_deferring_task_edits = false;
+
+  for (uint32_t task_index = performer.active_tasks.GetFirst(engine_.task_pool);
+       task_index != kInvalidIndex;
+       task_index = performer.active_tasks.GetFirst(engine_.task_pool)) {
+    performer.active_tasks.Remove(engine_.task_pool, task_index);
+    engine_.GetTask(task_index).is_active = false;
+    ProcessTaskEvent(task_index, BarelyTaskEventType_kEnd);
     engine_.task_pool.Release(task_index);
-    task_index = next_task_index;
   }
-  performer.first_active_task_index = kInvalidIndex;
 
-  task_index = performer.first_inactive_task_index;
-  while (task_index != kInvalidIndex) {
-    const uint32_t next_task_index = engine_.GetTask(task_index).next_task_index;
+  for (uint32_t task_index = performer.inactive_tasks.GetFirst(engine_.task_pool);
+       task_index != kInvalidIndex;
+       task_index = performer.inactive_tasks.GetFirst(engine_.task_pool)) {
+    performer.inactive_tasks.Remove(engine_.task_pool, task_index);
     engine_.task_pool.Release(task_index);
-    task_index = next_task_index;
   }
-  performer.first_inactive_task_index = kInvalidIndex;
 
+  engine_.task_event_queue.Remove(performer_index);
   engine_.performer_pool.Release(performer_index);
 }
 
@@ -51,21 +67,80 @@ uint32_t PerformerController::AcquireTask(uint32_t performer_index, double posit
   assert(duration >= 0.0);
   const uint32_t task_index = engine_.task_pool.Acquire();
   if (task_index != kInvalidIndex) {
+    auto& performer = engine_.GetPerformer(performer_index);
+    SyncPosition(performer);
     TaskState& task = engine_.GetTask(task_index);
     task = {{callback, user_data}, position, duration, priority, performer_index};
-    InsertInactiveTask(engine_.GetPerformer(performer_index), task_index);
+    InsertTask(performer, task_index);
+    UpdateTaskEvent(performer_index);
   }
   return task_index;
 }
 
+uint32_t PerformerController::AcquireTasks(uint32_t performer_index,
+                                           std::span<const BarelyTaskDesc> task_descs,
+                                           uint32_t* task_indices) noexcept {
+  uint32_t task_count = 0;
+  for (const auto& task_desc : task_descs) {
+    const uint32_t task_index = engine_.task_pool.Acquire();
+    if (task_index == kInvalidIndex) {
+      break;
+    }
+    engine_.GetTask(task_index) = {{task_desc.callback, task_desc.user_data},
+                                   task_desc.position,
+                                   std::max(task_desc.duration, 0.0),
+                                   task_desc.priority,
+                                   performer_index};
+    task_indices[task_count++] = task_index;
+  }
+  InsertTasks(performer_index, {task_indices, task_count});
+  return task_count;
+}
+
+uint32_t PerformerController::AcquireClipTasks(uint32_t performer_index, uint32_t instrument_id,
+                                               std::span<const BarelyNote> notes,
+                                               uint32_t* task_indices) noexcept {
+  engine_.ThawInstruments(performer_index);
+  uint32_t task_count = 0;
+  for (const auto& note : notes) {
+    const uint32_t task_index = engine_.task_pool.Acquire();
+    if (task_index == kInvalidIndex) {
+      break;
+    }
+    auto& task = engine_.GetTask(task_index);
+    task = {{}, note.position, std::max(note.duration, 0.0), 0, performer_index};
+    task.instrument_id = instrument_id;
+    task.pitch = note.pitch;
+    task.gain = kNoteControls[BarelyNoteControlType_kGain].Clamp(note.gain);
+    task_indices[task_count++] = task_index;
+  }
+  InsertTasks(performer_index, {task_indices, task_count});
+  return task_count;
+}
+
 void PerformerController::ReleaseTask(uint32_t task_index) noexcept {
+  ThawClipTask(task_index);
   auto& task = engine_.GetTask(task_index);
-  RemoveTask(engine_.GetPerformer(task.performer_index), task_index);
+  if (TaskEdit* task_edit = GetDeferredTaskEdit(task_index)) {
+    // End the task right away, and keep it detached in place until the edits are applied.
+    if (task.is_active) {
+      ProcessTaskEvent(task_index, BarelyTaskEventType_kEnd);
+    }
+    task.callback = {};
+    task.instrument_id = 0;
+    task_edit->is_release_pending = true;
+    return;
+  }
+  const uint32_t performer_index = task.performer_index;
+  auto& performer = engine_.GetPerformer(performer_index);
+  SyncPosition(performer);
+  RemoveTask(performer, task_index);
   if (task.is_active) {
     task.is_active = false;
-    task.callback(BarelyTaskEventType_kEnd);
+    ProcessTaskEvent(task_index, BarelyTaskEventType_kEnd);
   }
   engine_.task_pool.Release(task_index);
+  UpdateTaskEvent(performer_index);
 }
 
 void PerformerController::SetLoopBeginPosition(uint32_t performer_index,
@@ -74,10 +149,13 @@ void PerformerController::SetLoopBeginPosition(uint32_t performer_index,
   if (performer.loop_begin_position == loop_begin_position) {
     return;
   }
+  engine_.ThawInstruments(performer_index);
+  SyncPosition(performer);
   performer.loop_begin_position = loop_begin_position;
   if (performer.is_looping && performer.position >= performer.GetLoopEndPosition()) {
-    SetPosition(performer_index, performer.LoopAround(performer.position));
+    SetPosition(performer, performer.LoopAround(performer.position));
   }
+  UpdateTaskEvent(performer_index);
 }
 
 void PerformerController::SetLoopLength(uint32_t performer_index, double loop_length) noexcept {
@@ -85,10 +163,13 @@ void PerformerController::SetLoopLength(uint32_t performer_index, double loop_le
   if (performer.loop_length == loop_length) {
     return;
   }
+  engine_.ThawInstruments(performer_index);
+  SyncPosition(performer);
   performer.loop_length = loop_length;
   if (performer.is_looping && performer.position >= performer.GetLoopEndPosition()) {
-    SetPosition(performer_index, performer.LoopAround(performer.position));
+    SetPosition(performer, performer.LoopAround(performer.position));
   }
+  UpdateTaskEvent(performer_index);
 }
 
 void PerformerController::SetLooping(uint32_t performer_index, bool is_looping) noexcept {
@@ -96,54 +177,53 @@ void PerformerController::SetLooping(uint32_t performer_index, bool is_looping)
   if (performer.is_looping == is_looping) {
     return;
   }
+  engine_.ThawInstruments(performer_index);
+  SyncPosition(performer);
   performer.is_looping = is_looping;
   if (performer.is_looping && performer.position >= performer.GetLoopEndPosition()) {
-    SetPosition(performer_index, performer.LoopAround(performer.position));
+    SetPosition(performer, performer.LoopAround(performer.position));
   }
+  UpdateTaskEvent(performer_index);
 }
 
 void PerformerController::SetPosition(uint32_t performer_index, double position) noexcept {
+  engine_.ThawInstruments(performer_index);
   auto& performer = engine_.GetPerformer(performer_index);
-  if (performer.position == position) {
-    return;
-  }
-  if (performer.is_looping && position >= performer.GetLoopEndPosition()) {
-    performer.position = performer.LoopAround(position);
-    while (performer.first_active_task_index != kInvalidIndex) {
-      SetTaskActive(performer, performer.first_active_task_index, false);
-    }
-  } else {
-    performer.position = position;
-    UpdateActiveTasks(performer);
-  }
+  SyncPosition(performer);
+  SetPosition(performer, position);
+  UpdateTaskEvent(performer_index);
 }
 
 void PerformerController::Start(uint32_t performer_index) noexcept {
-  engine_.GetPerformer(performer_index).is_playing = true;
+  engine_.ThawInstruments(performer_index);
+  auto& performer = engine_.GetPerformer(performer_index);
+  SyncPosition(performer);
+  performer.is_playing = true;
+  performer.beat = engine_.beat;
+  UpdateTaskEvent(performer_index);
 }
 
 void PerformerController::Stop(uint32_t performer_index) noexcept {
+  engine_.ThawInstruments(performer_index);
   auto& performer = engine_.GetPerformer(performer_index);
+  SyncPosition(performer);
   performer.is_playing = false;
-  while (performer.first_active_task_index != kInvalidIndex) {
-    SetTaskActive(performer, performer.first_active_task_index, false);
+  for (uint32_t task_index = performer.active_tasks.GetFirst(engine_.task_pool);
+       task_index != kInvalidIndex;
+       task_index = performer.active_tasks.GetFirst(engine_.task_pool)) {
+    SetTaskActive(performer, task_index, false);
   }
+  UpdateTaskEvent(performer_index);
 }
 
 void PerformerController::SetTaskDuration(uint32_t task_index, double duration) noexcept {
   assert(duration >= 0.0);
-  auto& task = engine_.GetTask(task_index);
-  auto& performer = engine_.GetPerformer(task.performer_index);
-  if (task.duration == duration) return;
-  task.duration = duration;
-  if (task.is_active) {
-    if (task.IsInside(performer.position)) {
-      RemoveTask(performer, task_index);
-      InsertActiveTask(performer, task_index);
-    } else {
-      SetTaskActive(performer, task_index, false);
-    }
+  ThawClipTask(task_index);
+  if (TaskEdit* task_edit = GetDeferredTaskEdit(task_index)) {
+    task_edit->duration = duration;
+    return;
   }
+  ApplyTaskDuration(task_index, duration);
 }
 
 void PerformerController::SetTaskCallback(uint32_t task_index, BarelyTaskCallback callback,
@@ -152,44 +232,61 @@ void PerformerController::SetTaskCallback(uint32_t task_index, BarelyTaskCallbac
 }
 
 void PerformerController::SetTaskPosition(uint32_t task_index, double position) noexcept {
-  auto& task = engine_.GetTask(task_index);
-  auto& performer = engine_.GetPerformer(task.performer_index);
-  if (task.position == position) return;
-  task.position = position;
-  if (task.is_active) {
-    if (task.IsInside(performer.position)) {
-      RemoveTask(performer, task_index);
-      InsertActiveTask(performer, task_index);
-    } else {
-      SetTaskActive(performer, task_index, false);
-    }
-  } else {
-    RemoveTask(performer, task_index);
-    InsertInactiveTask(performer, task_index);
+  ThawClipTask(task_index);
+  if (TaskEdit* task_edit = GetDeferredTaskEdit(task_index)) {
+    task_edit->position = position;
+    return;
   }
+  ApplyTaskPosition(task_index, position);
 }
 
 void PerformerController::SetTaskPriority(uint32_t task_index, int32_t priority) noexcept {
-  auto& task = engine_.GetTask(task_index);
-  auto& performer = engine_.GetPerformer(task.performer_index);
-  if (task.priority == priority) return;
-  task.priority = priority;
-  if (task.is_active) {
-    RemoveTask(performer, task_index);
-    InsertActiveTask(performer, task_index);
-  } else {
-    RemoveTask(performer, task_index);
-    InsertInactiveTask(performer, task_index);
+  ThawClipTask(task_index);
+  if (TaskEdit* task_edit = GetDeferredTaskEdit(task_index)) {
+    task_edit->priority = priority;
+    return;
+  }
+  ApplyTaskPriority(task_index, priority);
+}
+
+void PerformerController::BeginTaskEvents(std::span<BarelyTaskEvent> task_events) noexcept {
+  task_events_ = task_events;
+  task_event_count_ = 0;
+}
+
+uint32_t PerformerController::EndTaskEvents() noexcept {
+  task_events_ = {};
+  return task_event_count_;
+}
+
+double PerformerController::GetPosition(uint32_t performer_index) const noexcept {
+  const auto& performer = engine_.GetPerformer(performer_index);
+  if (!performer.is_playing || performer.beat == engine_.beat) {
+    return performer.position;
   }
+  const double position = (performer.next_event_beat == engine_.beat)
+                              ? performer.next_event_position
+                              : performer.position + (engine_.beat - performer.beat);
+  return (performer.is_looping && position >= performer.GetLoopEndPosition())
+             ? performer.LoopAround(position)
+             : position;
 }
 
 void PerformerController::ProcessAllTasksAtPosition(const std::optional<int32_t>& min_priority,
                                                     int32_t max_priority) noexcept {
-  for (uint32_t i = 0; i < engine_.performer_pool.ActiveCount(); ++i) {
-    auto& performer = engine_.GetPerformer(engine_.performer_pool.GetActive(i));
+  // Task events that get updated during the callbacks are already processed up to `max_priority`.
+  engine_.task_event_min_priority = max_priority;
+  for (const uint32_t performer_index : GetDuePerformers()) {
+    if (!engine_.performer_pool.IsActive(performer_index)) {
+      continue;
+    }
+    auto& performer = engine_.GetPerformer(performer_index);
     if (!performer.is_playing) {
+      // Remove the task event of a performer that got stopped during the callbacks.
+      UpdateTaskEvent(performer_index);
       continue;
     }
+    processing_performer_index_ = performer_index;
     // Active tasks get processed in `SetPosition`, so we only need to process inactive tasks.
     for (uint32_t task_index = GetNextInactiveTask(performer); task_index != kInvalidIndex;
          task_index = GetNextInactiveTask(performer)) {
@@ -203,86 +300,218 @@ void PerformerController::ProcessAllTasksAtPosition(const std::optional<int32_t>
       }
     }
     UpdateActiveTasks(performer);
+    processing_performer_index_ = kInvalidIndex;
+    UpdateTaskEvent(performer_index);
   }
+  are_due_task_events_stale_ = false;
 }
 
-void PerformerController::InsertActiveTask(PerformerState& performer,
-                                           uint32_t task_index) noexcept {
-  auto& task = engine_.GetTask(task_index);
-  if (performer.first_active_task_index == kInvalidIndex) {
-    performer.first_active_task_index = task_index;
-    task.prev_task_index = kInvalidIndex;
-    task.next_task_index = kInvalidIndex;
-  } else if (auto& first_active_task = engine_.GetTask(performer.first_active_task_index);
-             task.IsActiveBefore(first_active_task)) {
-    first_active_task.prev_task_index = task_index;
-    task.next_task_index = performer.first_active_task_index;
-    performer.first_active_task_index = task_index;
-  } else {
-    uint32_t active_task_index = performer.first_active_task_index;
-    while (active_task_index != kInvalidIndex) {
-      const auto& active_task = engine_.GetTask(active_task_index);
-      if (active_task.next_task_index == kInvalidIndex ||
-          task.IsActiveBefore(engine_.GetTask(active_task.next_task_index))) {
-        break;
+void PerformerController::SyncAllPositions() noexcept {
+  for (uint32_t i = 0; i < engine_.performer_pool.ActiveCount(); ++i) {
+    SyncPosition(engine_.GetPerformer(engine_.performer_pool.GetActive(i)));
+  }
+}
+
+void PerformerController::UpdatePosition(double duration) noexcept {
+  const auto& task_event_queue = engine_.task_event_queue;
+  const bool is_next_task_event = !task_event_queue.IsEmpty() &&
+                                  task_event_queue.GetNext().beat - engine_.beat == duration;
+  // Land exactly on the next task event beat to avoid accumulating rounding errors.
+  engine_.beat = is_next_task_event ? task_event_queue.GetNext().beat : engine_.beat + duration;
+  engine_.task_event_min_priority = std::nullopt;
+  if (!is_next_task_event) {
+    // The update is not bound by a task event, which only happens once at the end of an update.
+    SyncAllPositions();
+  }
+  // Otherwise, performers without any task events until the current beat get updated lazily.
+  for (const uint32_t performer_index : GetDuePerformers()) {
+    if (engine_.performer_pool.IsActive(performer_index)) {
+      auto& performer = engine_.GetPerformer(performer_index);
+      processing_performer_index_ = performer_index;
+      SyncPosition(performer);
+      processing_performer_index_ = kInvalidIndex;
+      if (!performer.is_playing) {
+        // The callbacks stopped the performer, so its task event is no longer due.
+        UpdateTaskEvent(performer_index);
       }
-      active_task_index = active_task.next_task_index;
     }
-    auto& active_task = engine_.GetTask(active_task_index);
-    if (active_task.next_task_index != kInvalidIndex) {
-      engine_.GetTask(active_task.next_task_index).prev_task_index = task_index;
+  }
+  // Due task events get updated once they are processed, or when the next task event is queried.
+  are_due_task_events_stale_ = true;
+}
+
+void PerformerController::GetNextTaskEvent(const std::optional<int32_t>& min_priority,
+                                           double& duration, int32_t& priority) noexcept {
+  if (are_due_task_events_stale_ || min_priority != engine_.task_event_min_priority) {
+    engine_.task_event_min_priority = min_priority;
+    for (const uint32_t performer_index :
+         engine_.task_event_queue.GetPerformersUntil(engine_.beat)) {
+      UpdateTaskEvent(performer_index);
     }
-    task.next_task_index = active_task.next_task_index;
-    active_task.next_task_index = task_index;
-    task.prev_task_index = active_task_index;
+    are_due_task_events_stale_ = false;
+  }
+  if (engine_.task_event_queue.IsEmpty()) {
+    return;
+  }
+  const auto& event = engine_.task_event_queue.GetNext();
+  if (const double event_duration = event.beat - engine_.beat; event_duration < duration) {
+    duration = event_duration;
+    priority = event.priority;
+  } else if (event_duration == duration && event.priority < priority) {
+    priority = event.priority;
   }
 }
 
-void PerformerController::InsertInactiveTask(PerformerState& performer,
-                                             uint32_t task_index) noexcept {
-  auto& task = engine_.GetTask(task_index);
-  if (performer.first_inactive_task_index == kInvalidIndex) {
-    performer.first_inactive_task_index = task_index;
-    task.prev_task_index = kInvalidIndex;
-    task.next_task_index = kInvalidIndex;
-  } else if (auto& first_inactive_task = engine_.GetTask(performer.first_inactive_task_index);
-             task.IsInactiveBefore(first_inactive_task)) {
-    first_inactive_task.prev_task_index = task_index;
-    task.next_task_index = performer.first_inactive_task_index;
-    performer.first_inactive_task_index = task_index;
-  } else {
-    uint32_t inactive_task_index = performer.first_inactive_task_index;
-    while (inactive_task_index != kInvalidIndex) {
-      const auto& inactive_task = engine_.GetTask(inactive_task_index);
-      if (inactive_task.next_task_index == kInvalidIndex ||
-          task.IsInactiveBefore(engine_.GetTask(inactive_task.next_task_index))) {
-        break;
-      }
-      inactive_task_index = inactive_task.next_task_index;
+std::span<uint32_t> PerformerController::GetDuePerformers() noexcept {
+  const std::span<uint32_t> performer_indices =
+      engine_.task_event_queue.GetPerformersUntil(engine_.beat);
+  // Keep the same processing order as the performer pool.
+  std::sort(performer_indices.begin(), performer_indices.end(),
+            [&](uint32_t lhs, uint32_t rhs) noexcept {
+              return engine_.performer_pool.GetActiveIndex(lhs) <
+                     engine_.performer_pool.GetActiveIndex(rhs);
+            });
+  return performer_indices;
+}
+
+void PerformerController::SetPosition(PerformerState& performer, double position) noexcept {
+  if (performer.position == position) {
+    return;
+  }
+  if (performer.is_looping && position >= performer.GetLoopEndPosition()) {
+    performer.position = performer.LoopAround(position);
+    for (uint32_t task_index = performer.active_tasks.GetFirst(engine_.task_pool);
+         task_index != kInvalidIndex;
+         task_index = performer.active_tasks.GetFirst(engine_.task_pool)) {
+      SetTaskActive(performer, task_index, false);
     }
-    auto& inactive_task = engine_.GetTask(inactive_task_index);
-    if (inactive_task.next_task_index != kInvalidIndex) {
-      engine_.GetTask(inactive_task.next_task_index).prev_task_index = task_index;
+  } else {
+    performer.position = position;
+    UpdateActiveTasks(performer);
+  }
+}
+
+void PerformerController::SyncPosition(PerformerState& performer) noexcept {
+  if (!performer.is_playing || performer.beat == engine_.beat) {
+    return;
+  }
+  // Use the exact task event position when it is due to keep it in sync with the task positions.
+  const double position = (performer.next_event_beat == engine_.beat)
+                              ? performer.next_event_position
+                              : performer.position + (engine_.beat - performer.beat);
+  performer.beat = engine_.beat;
+  SetPosition(performer, position);
+}
+
+void PerformerController::UpdateTaskEvent(uint32_t performer_index) noexcept {
+  if (performer_index == processing_performer_index_) {
+    // The task event gets updated once the processing is done.
+    return;
+  }
+  auto& performer = engine_.GetPerformer(performer_index);
+  double duration = std::numeric_limits<double>::infinity();
+  int32_t priority = INT32_MAX;
+  GetNextTaskEvent(performer, engine_.task_event_min_priority, duration, priority);
+  if (duration < std::numeric_limits<double>::infinity()) {
+    // Keep the event strictly after the current beat to ensure that the position gets updated.
+    performer.next_event_beat =
+        (duration > 0.0)
+            ? std::max(engine_.beat + duration,
+                       std::nextafter(engine_.beat, std::numeric_limits<double>::max()))
+            : engine_.beat;
+    performer.next_event_position = performer.position + duration;
+    engine_.task_event_queue.Set(performer_index, performer.next_event_beat, priority);
+  } else {
+    performer.next_event_beat = std::numeric_limits<double>::infinity();
+    engine_.task_event_queue.Remove(performer_index);
+  }
+}
+
+void PerformerController::ApplyTaskDuration(uint32_t task_index, double duration) noexcept {
+  auto& task = engine_.GetTask(task_index);
+  const uint32_t performer_index = task.performer_index;
+  auto& performer = engine_.GetPerformer(performer_index);
+  if (task.duration == duration) return;
+  SyncPosition(performer);
+  task.duration = duration;
+  if (task.is_active) {
+    if (task.IsInside(performer.position)) {
+      RemoveTask(performer, task_index);
+      InsertTask(performer, task_index);
+    } else {
+      SetTaskActive(performer, task_index, false);
     }
-    task.next_task_index = inactive_task.next_task_index;
-    inactive_task.next_task_index = task_index;
-    task.prev_task_index = inactive_task_index;
+  } else {
+    performer.inactive_tasks.Update(engine_.task_pool, task_index);
   }
+  UpdateTaskEvent(performer_index);
 }
 
-void PerformerController::RemoveTask(PerformerState& performer, uint32_t task_index) noexcept {
+void PerformerController::ApplyTaskPosition(uint32_t task_index, double position) noexcept {
+  auto& task = engine_.GetTask(task_index);
+  const uint32_t performer_index = task.performer_index;
+  auto& performer = engine_.GetPerformer(performer_index);
+  if (task.position == position) return;
+  SyncPosition(performer);
+  task.position = position;
+  if (task.is_active && !task.IsInside(performer.position)) {
+    SetTaskActive(performer, task_index, false);
+  } else {
+    RemoveTask(performer, task_index);
+    InsertTask(performer, task_index);
+  }
+  UpdateTaskEvent(performer_index);
+}
+
+void PerformerController::ApplyTaskPriority(uint32_t task_index, int32_t priority) noexcept {
   auto& task = engine_.GetTask(task_index);
-  if (task.prev_task_index == kInvalidIndex) {
-    (task.is_active ? performer.first_active_task_index : performer.first_inactive_task_index) =
-        task.next_task_index;
+  const uint32_t performer_index = task.performer_index;
+  auto& performer = engine_.GetPerformer(performer_index);
+  if (task.priority == priority) return;
+  SyncPosition(performer);
+  task.priority = priority;
+  RemoveTask(performer, task_index);
+  InsertTask(performer, task_index);
+  UpdateTaskEvent(performer_index);
+}
+
+void PerformerController::InsertTasks(uint32_t performer_index,
+                                      std::span<const uint32_t> task_indices) noexcept {
+  auto& performer = engine_.GetPerformer(performer_index);
+  SyncPosition(performer);
+  // Sort the tasks once, where the tasks with the same key keep their order in the batch.
+  const std::span<uint32_t> sorted_task_indices(engine_.sorted_task_indices, task_indices.size());
+  for (uint32_t i = 0; i < sorted_task_indices.size(); ++i) {
+    sorted_task_indices[i] = i;
+  }
+  std::sort(sorted_task_indices.begin(), sorted_task_indices.end(),
+            [&](uint32_t lhs, uint32_t rhs) noexcept {
+              const auto& lhs_task = engine_.GetTask(task_indices[lhs]);
+              const auto& rhs_task = engine_.GetTask(task_indices[rhs]);
+              return lhs_task.IsInactiveBefore(rhs_task) ||
+                     (!rhs_task.IsInactiveBefore(lhs_task) && lhs < rhs);
+            });
+  for (uint32_t& task_index : sorted_task_indices) {
+    task_index = task_indices[task_index];
+  }
+  performer.inactive_tasks.InsertSorted(engine_.task_pool, sorted_task_indices);
+  UpdateTaskEvent(performer_index);
+}
+
+void PerformerController::InsertTask(PerformerState& performer, uint32_t task_index) noexcept {
+  if (engine_.GetTask(task_index).is_active) {
+    performer.active_tasks.Insert(engine_.task_pool, task_index);
   } else {
-    engine_.GetTask(task.prev_task_index).next_task_index = task.next_task_index;
+    performer.inactive_tasks.Insert(engine_.task_pool, task_index);
   }
-  if (task.next_task_index != kInvalidIndex) {
-    engine_.GetTask(task.next_task_index).prev_task_index = task.prev_task_index;
+}
+
+void PerformerController::RemoveTask(PerformerState& performer, uint32_t task_index) noexcept {
+  if (engine_.GetTask(task_index).is_active) {
+    performer.active_tasks.Remove(engine_.task_pool, task_index);
+  } else {
+    performer.inactive_tasks.Remove(engine_.task_pool, task_index);
   }
-  task.prev_task_index = kInvalidIndex;
-  task.next_task_index = kInvalidIndex;
 }
 
 void PerformerController::SetTaskActive(PerformerState& performer, uint32_t task_index,
@@ -292,43 +521,140 @@ void PerformerController::SetTaskActive(PerformerState& performer, uint32_t task
 
   RemoveTask(performer, task_index);
   task.is_active = is_active;
+  InsertTask(performer, task_index);
+  ProcessTaskEvent(task_index, is_active ? BarelyTaskEventType_kBegin : BarelyTaskEventType_kEnd);
+}
 
-  if (is_active) {
-    InsertActiveTask(performer, task_index);
-    task.callback(BarelyTaskEventType_kBegin);
+void PerformerController::ProcessTaskEvent(uint32_t task_index,
+                                           BarelyTaskEventType type) noexcept {
+  const auto& task = engine_.GetTask(task_index);
+  if (task.instrument_id != 0) {
+    // Clip tasks play their notes directly, as long as their instrument is still alive.
+    if (const uint32_t instrument_index = engine_.GetIdIndex(task.instrument_id);
+        engine_.instrument_pool.IsActive(instrument_index) &&
+        engine_.GetIdGeneration(task.instrument_id) ==
+            engine_.instrument_generations[instrument_index]) {
+      // Only the notes of the frozen performer get played back from the freeze frames.
+      if (const uint32_t frozen_performer_index =
+              engine_.GetInstrument(instrument_index).frozen_performer_index;
+          frozen_performer_index != kInvalidIndex &&
+          frozen_performer_index != task.performer_index) {
+        engine_.ThawInstrument(instrument_index);
+      }
+      if (type == BarelyTaskEventType_kBegin) {
+        engine_.ScheduleCmd(NoteOnCmd{instrument_index, task.pitch});
+        if (task.gain != 1.0f) {
+          engine_.ScheduleCmd(
+              NoteControlCmd{instrument_index, task.pitch, BarelyNoteControlType_kGain, task.gain});
+        }
+      } else {
+        engine_.ScheduleCmd(NoteOffCmd{instrument_index, task.pitch});
+      }
+    }
+  }
+  if (task.callback && !task_events_.empty()) {
+    if (task_event_count_ < task_events_.size()) {
+      task_events_[task_event_count_] = {
+          engine_.BuildId(task_index, engine_.task_generations[task_index]), type,
+          engine_.GetPerformer(task.performer_index).position, engine_.timestamp};
+    } else {
+      // The buffer is full in the middle of processing a position, so the callback cannot wait.
+      task.callback(type);
+    }
+    ++task_event_count_;
   } else {
-    InsertInactiveTask(performer, task_index);
-    task.callback(BarelyTaskEventType_kEnd);
+    task.callback(type);
   }
 }
 
 void PerformerController::UpdateActiveTasks(PerformerState& performer) noexcept {
-  uint32_t task_index = performer.first_active_task_index;
-  while (task_index != kInvalidIndex) {
-    auto& task = engine_.GetTask(task_index);
-    if (task.IsInside(performer.position)) {
-      task_index = task.next_task_index;
+  // Edits of active tasks in callbacks are deferred to keep the active tasks in place, so that the
+  // ended tasks can be visited in order in a single pass.
+  const bool was_deferring_task_edits = std::exchange(performer.is_deferring_task_edits, true);
+  for (uint32_t task_index = performer.active_tasks.GetFirst(engine_.task_pool);
+       task_index != kInvalidIndex &&
+       engine_.GetTask(task_index).GetEndPosition() <= performer.position;) {
+    const uint32_t next_task_index = performer.active_tasks.GetNext(engine_.task_pool, task_index);
+    SetTaskActive(performer, task_index, false);
+    // Start over if a callback changed the active tasks via the performer, e.g., by stopping it.
+    task_index = (next_task_index != kInvalidIndex &&
+                  engine_.task_pool.IsActive(next_task_index) &&
+                  engine_.GetTask(next_task_index).is_active)
+                     ? next_task_index
+                     : performer.active_tasks.GetFirst(engine_.task_pool);
+  }
+  // Remaining tasks can only be outside if they begin after the position, which are always ordered
+  // after the ended tasks.
+  for (uint32_t task_index =
+           performer.active_tasks.GetFirstBoundAfter(engine_.task_pool, performer.position);
+       task_index != kInvalidIndex; task_index = performer.active_tasks.GetFirstBoundAfter(
+                                        engine_.task_pool, performer.position)) {
+    SetTaskActive(performer, task_index, false);
+  }
+  performer.is_deferring_task_edits = was_deferring_task_edits;
+  if (!was_deferring_task_edits) {
+    ApplyDeferredTaskEdits(performer);
+  }
+}
+
+void PerformerController::ApplyDeferredTaskEdits(PerformerState& performer) noexcept {
+  // Keep deferring the edits in the callbacks along the way, which get appended to the list.
+  performer.is_deferring_task_edits = true;
+  while (performer.first_edited_task_index != kInvalidIndex) {
+    const uint32_t task_index = performer.first_edited_task_index;
+    TaskEdit& task_edit = engine_.task_edits[task_index];
+    performer.first_edited_task_index = task_edit.next_task_index;
+    if (performer.first_edited_task_index == kInvalidIndex) {
+      performer.last_edited_task_index = kInvalidIndex;
+    }
+    task_edit.is_deferred = false;
+    if (task_edit.is_release_pending) {
+      const uint32_t performer_index = engine_.GetTask(task_index).performer_index;
+      RemoveTask(performer, task_index);
+      engine_.task_pool.Release(task_index);
+      UpdateTaskEvent(performer_index);
     } else {
-      SetTaskActive(performer, task_index, false);
-      // Restart the iteration since links can get invalidated after a callback.
-      task_index = performer.first_active_task_index;
+      ApplyTaskDuration(task_index, task_edit.duration);
+      ApplyTaskPosition(task_index, task_edit.position);
+      ApplyTaskPriority(task_index, task_edit.priority);
     }
   }
+  performer.is_deferring_task_edits = false;
+}
+
+TaskEdit* PerformerController::GetDeferredTaskEdit(uint32_t task_index) noexcept {
+  const auto& task = engine_.GetTask(task_index);
+  auto& performer = engine_.GetPerformer(task.performer_index);
+  TaskEdit& task_edit = engine_.task_edits[task_index];
+  if (task_edit.is_deferred) {
+    return &task_edit;
+  }
+  if (!performer.is_deferring_task_edits || !task.is_active) {
+    return nullptr;
+  }
+  task_edit = {task.position, task.duration, task.priority};
+  task_edit.is_deferred = true;
+  if (performer.last_edited_task_index != kInvalidIndex) {
+    engine_.task_edits[performer.last_edited_task_index].next_task_index = task_index;
+  } else {
+    performer.first_edited_task_index = task_index;
+  }
+  performer.last_edited_task_index = task_index;
+  return &task_edit;
 }
 
 uint32_t PerformerController::GetNextInactiveTask(const PerformerState& performer) const noexcept {
   if (!performer.is_playing) {
     return kInvalidIndex;
   }
-  uint32_t task_index = performer.first_inactive_task_index;
-  while (task_index != kInvalidIndex) {
-    const auto& task = engine_.GetTask(task_index);
-    if (task.position >= performer.position || task.GetEndPosition() > performer.position) {
-      return task_index;
-    }
-    task_index = task.next_task_index;
+  // An inactive task that overlaps the position is always ordered before the ones that begin at or
+  // after the position.
+  if (const uint32_t task_index =
+          performer.inactive_tasks.GetFirstBoundAfter(engine_.task_pool, performer.position);
+      task_index != kInvalidIndex && engine_.GetTask(task_index).position < performer.position) {
+    return task_index;
   }
-  return kInvalidIndex;
+  return performer.inactive_tasks.GetLowerBound(engine_.task_pool, performer.position, INT32_MIN);
 }
 
 void PerformerController::GetNextTaskEvent(const PerformerState& performer,
@@ -338,23 +664,35 @@ void PerformerController::GetNextTaskEvent(const PerformerState& performer,
     return;
   }
 
+  const auto& inactive_tasks = performer.inactive_tasks;
   const double loop_end_position = performer.GetLoopEndPosition();
 
-  // Check inactive tasks.
-  uint32_t task_index = performer.first_inactive_task_index;
-  while (task_index != kInvalidIndex) {
-    const auto& task = engine_.GetTask(task_index);
-    if (task.position <= performer.position) {
-      // If the performer position is inside an inactive task, we can return immediately.
-      if (task.GetEndPosition() > performer.position ||
-          (task.position == performer.position &&
-           (!min_priority.has_value() || *min_priority < task.priority))) {
-        priority = (duration > 0.0) ? task.priority : std::min(task.priority, priority);
-        duration = 0.0;
-        return;
-      }
-      if (performer.is_looping && task.position >= performer.loop_begin_position &&
-          task.position < loop_end_position) {
+  // Find the first inactive task that begins at or before the position and is due to be processed.
+  uint32_t immediate_task_index =
+      inactive_tasks.GetFirstBoundAfter(engine_.task_pool, performer.position);
+  if (immediate_task_index != kInvalidIndex &&
+      engine_.GetTask(immediate_task_index).position > performer.position) {
+    immediate_task_index = kInvalidIndex;
+  }
+  if (const uint32_t task_index =
+          min_priority.has_value()
+              ? inactive_tasks.GetUpperBound(engine_.task_pool, performer.position, *min_priority)
+              : inactive_tasks.GetLowerBound(engine_.task_pool, performer.position, INT32_MIN);
+      task_index != kInvalidIndex && engine_.GetTask(task_index).position == performer.position &&
+      (immediate_task_index == kInvalidIndex ||
+       engine_.GetTask(task_index).IsInactiveBefore(engine_.GetTask(immediate_task_index)))) {
+    immediate_task_index = task_index;
+  }
+
+  // Check the first looped inactive task that begins before the position.
+  if (performer.is_looping) {
+    if (const uint32_t task_index = inactive_tasks.GetLowerBound(
+            engine_.task_pool, performer.loop_begin_position, INT32_MIN);
+        task_index != kInvalidIndex) {
+      const auto& task = engine_.GetTask(task_index);
+      if (task.position <= performer.position && task.position < loop_end_position &&
+          (immediate_task_index == kInvalidIndex ||
+           task.IsInactiveBefore(engine_.GetTask(immediate_task_index)))) {
         if (const double looped_inactive_duration =
                 task.position - performer.position + performer.loop_length;
             looped_inactive_duration < duration) {
@@ -364,22 +702,51 @@ void PerformerController::GetNextTaskEvent(const PerformerState& performer,
           priority = task.priority;
         }
       }
-    } else {
-      if (const double inactive_duration = task.position - performer.position;
-          inactive_duration < duration) {
-        duration = inactive_duration;
+    }
+    // Check the first inactive task that overlaps the loop begin position, which begins as soon as
+    // the position loops around.
+    if (const uint32_t task_index = inactive_tasks.GetFirstBoundAfter(
+            engine_.task_pool, performer.loop_begin_position);
+        task_index != kInvalidIndex && immediate_task_index == kInvalidIndex &&
+        performer.position < loop_end_position &&
+        engine_.GetTask(task_index).position < performer.loop_begin_position) {
+      const auto& task = engine_.GetTask(task_index);
+      if (const double looped_inactive_duration = loop_end_position - performer.position;
+          looped_inactive_duration < duration) {
+        duration = looped_inactive_duration;
         priority = task.priority;
-      } else if (inactive_duration == duration && task.priority < priority) {
+      } else if (looped_inactive_duration == duration && task.priority < priority) {
         priority = task.priority;
       }
-      break;
     }
-    task_index = task.next_task_index;
+  }
+
+  // If the performer position is inside an inactive task, we can return immediately.
+  if (immediate_task_index != kInvalidIndex) {
+    const auto& task = engine_.GetTask(immediate_task_index);
+    priority = (duration > 0.0) ? task.priority : std::min(task.priority, priority);
+    duration = 0.0;
+    return;
+  }
+
+  // Check the first inactive task that begins after the position.
+  if (const uint32_t task_index =
+          inactive_tasks.GetUpperBound(engine_.task_pool, performer.position, INT32_MAX);
+      task_index != kInvalidIndex) {
+    const auto& task = engine_.GetTask(task_index);
+    if (const double inactive_duration = task.position - performer.position;
+        inactive_duration < duration) {
+      duration = inactive_duration;
+      priority = task.priority;
+    } else if (inactive_duration == duration && task.priority < priority) {
+      priority = task.priority;
+    }
   }
 
   // Check active tasks.
-  if (performer.first_active_task_index != kInvalidIndex) {
-    const auto& active_task = engine_.GetTask(performer.first_active_task_index);
+  if (const uint32_t task_index = performer.active_tasks.GetFirst(engine_.task_pool);
+      task_index != kInvalidIndex) {
+    const auto& active_task = engine_.GetTask(task_index);
     const double end_position = performer.is_looping
                                     ? std::min(active_task.GetEndPosition(), loop_end_position)
                                     : active_task.GetEndPosition();
@@ -5,9 +5,12 @@
 
 #include <cstdint>
 #include <optional>
+#include <span>
 
+#include "core/constants.h"
 #include "engine/engine_state.h"
 #include "engine/performer_state.h"
+#include "engine/task_state.h"
 
 namespace barely {
 
@@ -21,6 +24,12 @@ class PerformerController {
   [[nodiscard]] uint32_t AcquireTask(uint32_t performer_index, double position, double duration,
                                      int32_t priority, BarelyTaskCallback callback,
                                      void* user_data) noexcept;
+  [[nodiscard]] uint32_t AcquireTasks(uint32_t performer_index,
+                                      std::span<const BarelyTaskDesc> task_descs,
+                                      uint32_t* task_indices) noexcept;
+  [[nodiscard]] uint32_t AcquireClipTasks(uint32_t performer_index, uint32_t instrument_id,
+                                          std::span<const BarelyNote> notes,
+                                          uint32_t* task_indices) noexcept;
   void ReleaseTask(uint32_t task_index) noexcept;
 
   void SetLoopBeginPosition(uint32_t performer_index, double loop_begin_position) noexcept;
@@ -35,38 +44,80 @@ class PerformerController {
   void SetTaskPosition(uint32_t task_index, double position) noexcept;
   void SetTaskPriority(uint32_t task_index, int32_t priority) noexcept;
 
+  // Begins appending the task events to a buffer instead of processing their callbacks.
+  void BeginTaskEvents(std::span<BarelyTaskEvent> task_events) noexcept;
+
+  // Ends appending the task events, and returns the number of task events, which exceeds the buffer
+  // size if the callbacks of the remaining task events got processed.
+  [[nodiscard]] uint32_t EndTaskEvents() noexcept;
+
+  [[nodiscard]] bool HasTaskEvents() const noexcept { return task_event_count_ > 0; }
+  [[nodiscard]] bool IsTaskEventBufferFull() const noexcept {
+    return !task_events_.empty() && task_event_count_ >= task_events_.size();
+  }
+
+  // Returns the position of a performer, which might be pending to get updated.
+  [[nodiscard]] double GetPosition(uint32_t performer_index) const noexcept;
+
+  // Processes the task events at the current beat in the performers that are due.
   void ProcessAllTasksAtPosition(const std::optional<int32_t>& min_priority,
                                  int32_t max_priority) noexcept;
 
-  void UpdatePosition(double duration) noexcept {
-    for (uint32_t i = 0; i < engine_.performer_pool.ActiveCount(); ++i) {
-      const uint32_t performer_index = engine_.performer_pool.GetActive(i);
-      if (const auto& performer = engine_.GetPerformer(performer_index); performer.is_playing) {
-        SetPosition(performer_index, performer.position + duration);
-      }
-    }
-  }
+  // Updates the positions of all playing performers to the current beat.
+  void SyncAllPositions() noexcept;
+
+  // Advances the current beat, and updates the positions of the performers that are due.
+  void UpdatePosition(double duration) noexcept;
 
+  // Returns the next task event across all performers in constant time.
   void GetNextTaskEvent(const std::optional<int32_t>& min_priority, double& duration,
-                        int32_t& priority) const noexcept {
-    for (uint32_t i = 0; i < engine_.performer_pool.ActiveCount(); ++i) {
-      GetNextTaskEvent(engine_.GetPerformer(engine_.performer_pool.GetActive(i)), min_priority,
-                       duration, priority);
-    }
-  }
+                        int32_t& priority) noexcept;
 
  private:
-  void InsertActiveTask(PerformerState& performer, uint32_t task_index) noexcept;
-  void InsertInactiveTask(PerformerState& performer, uint32_t task_index) noexcept;
+  [[nodiscard]] std::span<uint32_t> GetDuePerformers() noexcept;
+  void SetPosition(PerformerState& performer, double position) noexcept;
+  void SyncPosition(PerformerState& performer) noexcept;
+  void UpdateTaskEvent(uint32_t performer_index) noexcept;
+
+  void InsertTasks(uint32_t performer_index, std::span<const uint32_t> task_indices) noexcept;
+  void InsertTask(PerformerState& performer, uint32_t task_index) noexcept;
   void RemoveTask(PerformerState& performer, uint32_t task_index) noexcept;
+  void ProcessTaskEvent(uint32_t task_index, BarelyTaskEventType type) noexcept;
   void SetTaskActive(PerformerState& performer, uint32_t task_index, bool is_active) noexcept;
   void UpdateActiveTasks(PerformerState& performer) noexcept;
 
+  // Thaws the instruments that are frozen with the performer of a clip task.
+  void ThawClipTask(uint32_t task_index) noexcept {
+    if (const auto& task = engine_.GetTask(task_index); task.instrument_id != 0) {
+      engine_.ThawInstruments(task.performer_index);
+    }
+  }
+
+  void ApplyTaskDuration(uint32_t task_index, double duration) noexcept;
+  void ApplyTaskPosition(uint32_t task_index, double position) noexcept;
+  void ApplyTaskPriority(uint32_t task_index, int32_t priority) noexcept;
+
+  // Applies the deferred task edits of a performer in order.
+  void ApplyDeferredTaskEdits(PerformerState& performer) noexcept;
+
+  // Returns the deferred edit of a task, or nullptr if the task can be edited right away.
+  [[nodiscard]] TaskEdit* GetDeferredTaskEdit(uint32_t task_index) noexcept;
+
   [[nodiscard]] uint32_t GetNextInactiveTask(const PerformerState& performer) const noexcept;
   void GetNextTaskEvent(const PerformerState& performer, const std::optional<int32_t>& min_priority,
                         double& duration, int32_t& priority) const noexcept;
 
   EngineState& engine_;
+
+  // Performer that is being processed, which defers its task event updates until it is done.
+  uint32_t processing_performer_index_ = kInvalidIndex;
+
+  // Buffer to append the task events to, and the number of appended task events.
+  std::span<BarelyTaskEvent> task_events_ = {};
+  uint32_t task_event_count_ = 0;
+
+  // Denotes whether the due task events are pending to get updated after the position update.
+  bool are_due_task_events_stale_ = false;
 };
 
 }  // namespace barely
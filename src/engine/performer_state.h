@@ -1,14 +1,10 @@
 #ifndef BARELYMUSICIAN_ENGINE_PERFORMER_STATE_H_
 #define BARELYMUSICIAN_ENGINE_PERFORMER_STATE_H_
 
-#include <barelymusician.h>
-
-#include <cfloat>
 #include <cmath>
-#include <cstdint>
+#include <limits>
 
-#include "core/callback.h"
-#include "core/constants.h"
+#include "engine/task_timeline.h"
 
 namespace barely {
 
@@ -18,12 +14,29 @@ struct PerformerState {
   double loop_length = 1.0;
   double position = 0.0;
 
-  uint32_t first_active_task_index = kInvalidIndex;
-  uint32_t first_inactive_task_index = kInvalidIndex;
+  // Engine beat at which the position was last updated, which gets lazily advanced while playing.
+  double beat = 0.0;
+
+  // Engine beat and position of the next task event.
+  double next_event_beat = std::numeric_limits<double>::infinity();
+  double next_event_position = 0.0;
+
+  TaskTimeline<TaskOrder::kEnd> active_tasks;
+  TaskTimeline<TaskOrder::kPosition> inactive_tasks;
+
+  // Tasks with deferred edits in order, which get applied once the active tasks are updated.
+  uint32_t first_edited_task_index = kInvalidIndex;
+  uint32_t last_edited_task_index = kInvalidIndex;
+
+  // Number of instruments whose clip notes of this performer are frozen.
+  uint32_t frozen_instrument_count = 0;
 
   bool is_looping = false;
   bool is_playing = false;
 
+  // Denotes whether the edits of active tasks are deferred or not.
+  bool is_deferring_task_edits = false;
+
   [[nodiscard]] double LoopAround(double new_position) const noexcept {
     return loop_length > 0.0
                ? loop_begin_position + std::fmod(new_position - loop_begin_position, loop_length)
@@ -35,39 +48,6 @@ struct PerformerState {
   }
 };
 
-struct TaskState {
-  Callback<BarelyTaskCallback> callback = {};
-
-  double position = 0.0;
-  double duration = 0.0;
-  int32_t priority = 0;
-
-  uint32_t performer_index = kInvalidIndex;
-
-  uint32_t prev_task_index = kInvalidIndex;
-  uint32_t next_task_index = kInvalidIndex;
-
-  // Denotes whether the task is active or not.
-  bool is_active = false;
-
-  [[nodiscard]] double GetEndPosition() const noexcept { return position + duration; }
-
-  [[nodiscard]] bool IsActiveBefore(const TaskState& other) const noexcept {
-    const double end_position = GetEndPosition();
-    const double other_end_position = other.GetEndPosition();
-    return end_position < other_end_position ||
-           (end_position == other_end_position && priority < other.priority);
-  }
-
-  [[nodiscard]] bool IsInactiveBefore(const TaskState& other) const noexcept {
-    return position < other.position || (position == other.position && priority < other.priority);
-  }
-
-  [[nodiscard]] bool IsInside(double other_position) const noexcept {
-    return other_position >= position && other_position < GetEndPosition();
-  }
-};
-
 }  // namespace barely
 
 #endif  // BARELYMUSICIAN_ENGINE_PERFORMER_STATE_H_
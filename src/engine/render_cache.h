@@ -0,0 +1,161 @@
+#ifndef BARELYMUSICIAN_ENGINE_RENDER_CACHE_H_
+#define BARELYMUSICIAN_ENGINE_RENDER_CACHE_H_
+
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+
+#include "core/arena.h"
+#include "core/constants.h"
+
+namespace barely {
+
+// Cache of the rendered voice outputs, which replays the identical one-shot notes instead of
+// processing them again. Each entry is recorded by the first voice that plays its note through,
+// and the recorded frames stay until the cache fills up while none of them are playing. Only
+// accessed by the audio thread.
+class RenderCache {
+ public:
+  // Maximum number of entries.
+  static constexpr uint32_t kMaxEntryCount = 256;
+
+  RenderCache(Arena& arena, uint32_t frame_count) noexcept
+      : entries_(arena.AllocBuffer<Entry>((frame_count > 0) ? kMaxEntryCount : 0)),
+        frames_(arena.AllocBuffer<float>(frame_count)),
+        frame_capacity_(frame_count) {}
+
+  // Returns the ready entry of a key, or invalid index if not found.
+  [[nodiscard]] uint32_t Find(uint64_t key) const noexcept {
+    for (uint32_t i = 0; i < entry_count_; ++i) {
+      if (entries_[i].is_ready && entries_[i].key == key) {
+        return i;
+      }
+    }
+    return kInvalidIndex;
+  }
+
+  // Invalidates the entries of an instrument, e.g. when its sample data changes.
+  void Invalidate(uint32_t instrument_index) noexcept {
+    for (uint32_t i = 0; i < entry_count_; ++i) {
+      if (entries_[i].instrument_index == instrument_index) {
+        entries_[i].is_ready = false;
+      }
+    }
+  }
+
+  [[nodiscard]] bool IsEnabled() const noexcept { return frame_capacity_ > 0; }
+
+  // Begins recording a new entry, or returns invalid index if another entry is being recorded, or
+  // if the cache is full while its entries are playing.
+  [[nodiscard]] uint32_t BeginRecording(uint64_t key, uint32_t instrument_index) noexcept {
+    if (!IsEnabled() || recording_entry_index_ != kInvalidIndex) {
+      return kInvalidIndex;
+    }
+    if (entry_count_ == kMaxEntryCount || frame_count_ == frame_capacity_) {
+      if (playing_count_ > 0) {
+        return kInvalidIndex;
+      }
+      entry_count_ = 0;
+      frame_count_ = 0;
+    }
+    entries_[entry_count_] = {key, frame_count_, 0, instrument_index, false};
+    recording_entry_index_ = entry_count_++;
+    return recording_entry_index_;
+  }
+
+  // Records the next frame, or aborts the recording and returns false if the cache is full.
+  [[nodiscard]] bool Record(float sample) noexcept {
+    assert(recording_entry_index_ != kInvalidIndex);
+    Entry& entry = entries_[recording_entry_index_];
+    if (entry.first_frame + entry.frame_count == frame_capacity_) {
+      AbortRecording();
+      return false;
+    }
+    frames_[entry.first_frame + entry.frame_count++] = sample;
+    return true;
+  }
+
+  // Ends the recording, which makes its entry ready to play.
+  void EndRecording() noexcept {
+    assert(recording_entry_index_ != kInvalidIndex);
+    Entry& entry = entries_[recording_entry_index_];
+    if (entry.frame_count == 0) {
+      AbortRecording();
+      return;
+    }
+    entry.is_ready = true;
+    frame_count_ = entry.first_frame + entry.frame_count;
+    recording_entry_index_ = kInvalidIndex;
+  }
+
+  // Aborts the recording, which discards its entry.
+  void AbortRecording() noexcept {
+    assert(recording_entry_index_ != kInvalidIndex);
+    assert(recording_entry_index_ + 1 == entry_count_);
+    --entry_count_;
+    recording_entry_index_ = kInvalidIndex;
+  }
+
+  // Returns the instrument of the recording, or invalid index if not recording.
+  [[nodiscard]] uint32_t GetRecordingInstrumentIndex() const noexcept {
+    return (recording_entry_index_ != kInvalidIndex)
+               ? entries_[recording_entry_index_].instrument_index
+               : kInvalidIndex;
+  }
+
+  // Begins playing an entry, which keeps the recorded frames until `EndPlaying` is called.
+  void BeginPlaying() noexcept { ++playing_count_; }
+  void EndPlaying() noexcept {
+    assert(playing_count_ > 0);
+    --playing_count_;
+  }
+
+  [[nodiscard]] float GetFrame(uint32_t entry_index, uint32_t frame) const noexcept {
+    assert(entry_index < entry_count_);
+    assert(frame < entries_[entry_index].frame_count);
+    return frames_[entries_[entry_index].first_frame + frame];
+  }
+
+  [[nodiscard]] uint32_t GetFrameCount(uint32_t entry_index) const noexcept {
+    assert(entry_index < entry_count_);
+    return entries_[entry_index].frame_count;
+  }
+
+ private:
+  struct Entry {
+    uint64_t key = 0;
+    uint32_t first_frame = 0;
+    uint32_t frame_count = 0;
+    uint32_t instrument_index = kInvalidIndex;
+    bool is_ready = false;
+  };
+
+  Entry* entries_ = nullptr;
+  float* frames_ = nullptr;
+
+  uint32_t entry_count_ = 0;
+  uint32_t frame_count_ = 0;  // of the ready entries
+  uint32_t frame_capacity_ = 0;
+
+  uint32_t recording_entry_index_ = kInvalidIndex;
+  uint32_t playing_count_ = 0;
+};
+
+// Initial value of a 64-bit FNV-1a hash.
+inline constexpr uint64_t kHashOffsetBasis = 0xCBF29CE484222325u;
+
+// Accumulates a value into a 64-bit FNV-1a hash.
+template <typename T>
+constexpr uint64_t HashValue(uint64_t hash, const T& value) noexcept {
+  using Words = std::array<uint32_t, sizeof(T) / sizeof(uint32_t)>;
+  static_assert(sizeof(T) == sizeof(Words));
+  for (const uint32_t word : std::bit_cast<Words>(value)) {
+    hash = (hash ^ word) * 0x100000001B3u;
+  }
+  return hash;
+}
+
+}  // namespace barely
+
+#endif  // BARELYMUSICIAN_ENGINE_RENDER_CACHE_H_
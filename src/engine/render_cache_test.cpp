@@ -0,0 +1,112 @@
+#include "engine/render_cache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "core/arena.h"
+#include "core/constants.h"
+#include "gtest/gtest.h"
+
+namespace barely {
+namespace {
+
+TEST(RenderCacheTest, RecordAndFind) {
+  constexpr uint32_t kFrameCount = 8;
+  constexpr uint64_t kKey = 1;
+  constexpr uint32_t kInstrumentIndex = 2;
+
+  const auto size = GetAllocSize<RenderCache>(kFrameCount);
+  auto data = std::make_unique<std::byte[]>(size);
+  Arena arena(data.get(), size);
+
+  RenderCache render_cache(arena, kFrameCount);
+  EXPECT_TRUE(render_cache.IsEnabled());
+  EXPECT_EQ(render_cache.Find(kKey), kInvalidIndex);
+
+  const uint32_t entry_index = render_cache.BeginRecording(kKey, kInstrumentIndex);
+  ASSERT_NE(entry_index, kInvalidIndex);
+  EXPECT_EQ(render_cache.GetRecordingInstrumentIndex(), kInstrumentIndex);
+
+  // Only one entry can be recorded at a time.
+  EXPECT_EQ(render_cache.BeginRecording(kKey + 1, kInstrumentIndex), kInvalidIndex);
+
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(render_cache.Record(static_cast<float>(i)));
+  }
+  EXPECT_EQ(render_cache.Find(kKey), kInvalidIndex);
+
+  render_cache.EndRecording();
+  EXPECT_EQ(render_cache.GetRecordingInstrumentIndex(), kInvalidIndex);
+  EXPECT_EQ(render_cache.Find(kKey), entry_index);
+  ASSERT_EQ(render_cache.GetFrameCount(entry_index), 4);
+  for (uint32_t i = 0; i < 4; ++i) {
+    EXPECT_FLOAT_EQ(render_cache.GetFrame(entry_index, i), static_cast<float>(i));
+  }
+
+  render_cache.Invalidate(kInstrumentIndex + 1);
+  EXPECT_EQ(render_cache.Find(kKey), entry_index);
+
+  render_cache.Invalidate(kInstrumentIndex);
+  EXPECT_EQ(render_cache.Find(kKey), kInvalidIndex);
+}
+
+TEST(RenderCacheTest, AbortRecording) {
+  constexpr uint32_t kFrameCount = 4;
+
+  const auto size = GetAllocSize<RenderCache>(kFrameCount);
+  auto data = std::make_unique<std::byte[]>(size);
+  Arena arena(data.get(), size);
+
+  RenderCache render_cache(arena, kFrameCount);
+
+  ASSERT_NE(render_cache.BeginRecording(1, 0), kInvalidIndex);
+  EXPECT_TRUE(render_cache.Record(1.0f));
+  render_cache.AbortRecording();
+  EXPECT_EQ(render_cache.Find(1), kInvalidIndex);
+
+  // The recording is aborted once it runs out of frames.
+  ASSERT_NE(render_cache.BeginRecording(2, 0), kInvalidIndex);
+  for (uint32_t i = 0; i < kFrameCount; ++i) {
+    EXPECT_TRUE(render_cache.Record(1.0f));
+  }
+  EXPECT_FALSE(render_cache.Record(1.0f));
+  EXPECT_EQ(render_cache.GetRecordingInstrumentIndex(), kInvalidIndex);
+  EXPECT_EQ(render_cache.Find(2), kInvalidIndex);
+}
+
+TEST(RenderCacheTest, ClearWhenFull) {
+  constexpr uint32_t kFrameCount = 2;
+
+  const auto size = GetAllocSize<RenderCache>(kFrameCount);
+  auto data = std::make_unique<std::byte[]>(size);
+  Arena arena(data.get(), size);
+
+  RenderCache render_cache(arena, kFrameCount);
+
+  const uint32_t entry_index = render_cache.BeginRecording(1, 0);
+  ASSERT_NE(entry_index, kInvalidIndex);
+  EXPECT_TRUE(render_cache.Record(1.0f));
+  EXPECT_TRUE(render_cache.Record(2.0f));
+  render_cache.EndRecording();
+
+  // The full cache is kept while its entries are playing.
+  render_cache.BeginPlaying();
+  EXPECT_EQ(render_cache.BeginRecording(2, 0), kInvalidIndex);
+  EXPECT_EQ(render_cache.Find(1), entry_index);
+
+  // Otherwise, it is cleared for the new entry.
+  render_cache.EndPlaying();
+  EXPECT_NE(render_cache.BeginRecording(2, 0), kInvalidIndex);
+  EXPECT_EQ(render_cache.Find(1), kInvalidIndex);
+}
+
+TEST(RenderCacheTest, Disabled) {
+  Arena arena;
+  RenderCache render_cache(arena, 0);
+  EXPECT_FALSE(render_cache.IsEnabled());
+  EXPECT_EQ(render_cache.BeginRecording(1, 0), kInvalidIndex);
+}
+
+}  // namespace
+}  // namespace barely
@@ -0,0 +1,101 @@
+#ifndef BARELYMUSICIAN_ENGINE_SAMPLE_BANK_STATE_H_
+#define BARELYMUSICIAN_ENGINE_SAMPLE_BANK_STATE_H_
+
+#include <barelymusician.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+
+#include "core/arena.h"
+#include "core/constants.h"
+#include "core/rng.h"
+#include "engine/slice_state.h"
+
+namespace barely {
+
+// Read-only bank of slices, which can be shared by any number of instruments across engines. The
+// slices are sorted by their root pitches at construction, along with a key index of the distinct
+// root pitches to select a slice in logarithmic time.
+class SampleBankState {
+ public:
+  SampleBankState(Arena& arena, const BarelySlice* slices, uint32_t slice_count) noexcept
+      : slices_(arena.AllocArray<SliceState>(slice_count)),
+        key_pitches_(arena.AllocArray<float>(slice_count)),
+        key_slice_indices_(arena.AllocArray<uint32_t>(slice_count + 1)) {
+    if (arena.is_null() || slice_count == 0) {
+      return;
+    }
+    assert(slices != nullptr);
+    for (uint32_t i = 0; i < slice_count; ++i) {
+      const BarelySlice& slice = slices[i];
+      slices_[i] = {slice.samples, slice.sample_count, static_cast<float>(slice.sample_rate),
+                    slice.root_pitch, kInvalidIndex};
+    }
+    std::stable_sort(slices_, slices_ + slice_count,
+                     [](const SliceState& lhs, const SliceState& rhs) noexcept {
+                       return lhs.root_pitch < rhs.root_pitch;
+                     });
+    for (uint32_t i = 0; i < slice_count; ++i) {
+      if (key_count_ == 0 || slices_[i].root_pitch != key_pitches_[key_count_ - 1]) {
+        key_pitches_[key_count_] = slices_[i].root_pitch;
+        key_slice_indices_[key_count_] = i;
+        ++key_count_;
+      }
+    }
+    key_slice_indices_[key_count_] = slice_count;
+  }
+
+  // Adds a reference from an instrument, which is safe to call from any thread.
+  void AddReference() noexcept { reference_count_.fetch_add(1, std::memory_order_relaxed); }
+
+  // Removes a reference from an instrument, which is safe to call from any thread.
+  void RemoveReference() noexcept {
+    [[maybe_unused]] const uint32_t reference_count =
+        reference_count_.fetch_sub(1, std::memory_order_acq_rel);
+    assert(reference_count > 0);
+  }
+
+  // Returns the number of instruments that reference the bank.
+  [[nodiscard]] uint32_t GetReferenceCount() const noexcept {
+    return reference_count_.load(std::memory_order_acquire);
+  }
+
+  // Returns a slice, which is safe to call from the audio thread.
+  [[nodiscard]] const SliceState* Get(uint32_t slice_index) const noexcept {
+    return (slice_index != kInvalidIndex) ? &slices_[slice_index] : nullptr;
+  }
+
+  // Selects a slice with the nearest root pitch, which is safe to call from the audio thread. Ties
+  // select the lower root pitch, and slices that share a root pitch are selected randomly.
+  [[nodiscard]] uint32_t Select(float pitch, AudioRng& rng) const noexcept {
+    if (key_count_ == 0) {
+      return kInvalidIndex;
+    }
+    uint32_t key =
+        static_cast<uint32_t>(std::lower_bound(key_pitches_, key_pitches_ + key_count_, pitch) -
+                              key_pitches_);
+    if (key == key_count_ ||
+        (key > 0 && pitch - key_pitches_[key - 1] <= key_pitches_[key] - pitch)) {
+      --key;
+    }
+    const uint32_t begin_slice_index = key_slice_indices_[key];
+    const uint32_t slice_count = key_slice_indices_[key + 1] - begin_slice_index;
+    return begin_slice_index + ((slice_count == 1) ? 0 : rng.Generate(0, slice_count));
+  }
+
+ private:
+  SliceState* slices_ = nullptr;
+
+  // Distinct root pitches in increasing order, and the index of their first slice.
+  float* key_pitches_ = nullptr;
+  uint32_t* key_slice_indices_ = nullptr;
+  uint32_t key_count_ = 0;
+
+  std::atomic<uint32_t> reference_count_ = 0;
+};
+
+}  // namespace barely
+
+#endif  // BARELYMUSICIAN_ENGINE_SAMPLE_BANK_STATE_H_
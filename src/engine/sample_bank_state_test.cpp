@@ -0,0 +1,76 @@
+#include "engine/sample_bank_state.h"
+
+#include <barelymusician.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "core/arena.h"
+#include "core/constants.h"
+#include "core/rng.h"
+#include "engine/slice_state.h"
+#include "gmock/gmock-matchers.h"
+#include "gtest/gtest.h"
+
+namespace barely {
+namespace {
+
+using ::testing::Field;
+using ::testing::Pointee;
+
+TEST(SampleBankStateTest, Select) {
+  constexpr int kSampleRate = 1;
+  constexpr std::array<float, 1> kSamples = {1.0f};
+
+  // Pass the slices out of order, which should get sorted by their root pitches.
+  const std::array<BarelySlice, 4> kSlices = {
+      BarelySlice{kSamples.data(), 1, kSampleRate, 35.0f},
+      BarelySlice{kSamples.data(), 1, kSampleRate, 15.0f},
+      BarelySlice{kSamples.data(), 1, kSampleRate, 5.0f},
+      BarelySlice{kSamples.data(), 1, kSampleRate, 15.0f},
+  };
+
+  const auto size =
+      GetAllocSize<SampleBankState>(kSlices.data(), static_cast<uint32_t>(kSlices.size()));
+  auto data = std::make_unique<std::byte[]>(size);
+  Arena arena(data.get(), size);
+
+  AudioRng rng;
+  const SampleBankState sample_bank(arena, kSlices.data(), static_cast<uint32_t>(kSlices.size()));
+
+  for (int i = 0; i <= 40; ++i) {
+    const uint32_t slice_index = sample_bank.Select(static_cast<float>(i), rng);
+    ASSERT_NE(slice_index, kInvalidIndex);
+    EXPECT_THAT(
+        sample_bank.Get(slice_index),
+        Pointee(Field(&SliceState::root_pitch, ((i <= 10) ? 5.0f : (i <= 25.0f ? 15.0f : 35.0f)))))
+        << i;
+  }
+}
+
+TEST(SampleBankStateTest, AddRemoveReference) {
+  constexpr std::array<float, 1> kSamples = {1.0f};
+  const std::array<BarelySlice, 1> kSlices = {BarelySlice{kSamples.data(), 1, 1, 0.0f}};
+
+  const auto size =
+      GetAllocSize<SampleBankState>(kSlices.data(), static_cast<uint32_t>(kSlices.size()));
+  auto data = std::make_unique<std::byte[]>(size);
+  Arena arena(data.get(), size);
+
+  SampleBankState sample_bank(arena, kSlices.data(), static_cast<uint32_t>(kSlices.size()));
+  EXPECT_EQ(sample_bank.GetReferenceCount(), 0);
+
+  sample_bank.AddReference();
+  sample_bank.AddReference();
+  EXPECT_EQ(sample_bank.GetReferenceCount(), 2);
+
+  sample_bank.RemoveReference();
+  EXPECT_EQ(sample_bank.GetReferenceCount(), 1);
+  sample_bank.RemoveReference();
+  EXPECT_EQ(sample_bank.GetReferenceCount(), 0);
+}
+
+}  // namespace
+}  // namespace barely
@@ -3,7 +3,9 @@
 
 #include <barelymusician.h>
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 
@@ -18,10 +20,9 @@ class SlicePool {
  public:
   SlicePool(Arena& arena, uint32_t count) noexcept
       : slices_(arena.AllocArray<SliceState>(count)), free_(arena.AllocArray<uint32_t>(count)) {
-    if (arena.is_null()) {
+    if (arena.is_null() || count == 0) {
       return;
     }
-    assert(count > 0);
     assert(count != kInvalidIndex);
     count_ = count;
     free_count_ = count;
@@ -36,6 +37,7 @@ class SlicePool {
     }
     assert(slices != nullptr);
 
+    SliceState* slices_data = slices_.load(std::memory_order_relaxed);  // written by this thread
     const uint32_t first_slice_index = free_[free_read_index_];
 
     uint32_t slice_index = first_slice_index;
@@ -47,7 +49,7 @@ class SlicePool {
       const BarelySlice& slice = slices[i];
       const uint32_t next_slice_index =
           (i + 1 < slice_count) ? free_[free_read_index_] : kInvalidIndex;
-      slices_[slice_index] = {
+      slices_data[slice_index] = {
           slice.samples,    slice.sample_count, static_cast<float>(slice.sample_rate),
           slice.root_pitch, next_slice_index,
       };
@@ -55,34 +57,69 @@ class SlicePool {
     }
 
     free_count_ -= slice_count;
+    max_active_count_ = std::max(max_active_count_, count_ - free_count_);
 
     return first_slice_index;
   }
 
   void Release(uint32_t first_slice_index) noexcept {
+    const SliceState* slices_data = slices_.load(std::memory_order_relaxed);
     uint32_t slice_index = first_slice_index;
     while (slice_index != kInvalidIndex) {
       free_[free_write_index_] = slice_index;
       if (++free_write_index_ == count_) {
         free_write_index_ = 0;
       }
-      slice_index = slices_[slice_index].next_slice_index;
+      slice_index = slices_data[slice_index].next_slice_index;
       ++free_count_;
     }
   }
 
+  [[nodiscard]] uint32_t ActiveCount() const noexcept { return count_ - free_count_; }
+
+  [[nodiscard]] uint32_t Count() const noexcept { return count_; }
+
+  [[nodiscard]] uint32_t MaxActiveCount() const noexcept { return max_active_count_; }
+
+  // Moves the slices into the larger arrays of another pool, keeping their indices, and takes over
+  // those arrays. The previous arrays stay valid with the same slices for the audio thread until it
+  // picks up the new ones.
+  void Extend(SlicePool& other) noexcept {
+    assert(other.count_ > count_);
+    std::copy_n(slices_.load(std::memory_order_relaxed), count_,
+                other.slices_.load(std::memory_order_relaxed));
+
+    // Keep the order of the free slices, followed by the new slices.
+    for (uint32_t i = 0; i < free_count_; ++i) {
+      other.free_[i] = free_[(free_read_index_ + i) % count_];
+    }
+    for (uint32_t i = count_; i < other.count_; ++i) {
+      other.free_[free_count_ + i - count_] = i;
+    }
+    free_count_ += other.count_ - count_;
+    free_read_index_ = 0;
+    free_write_index_ = free_count_ % other.count_;
+
+    free_ = other.free_;
+    count_ = other.count_;
+    slices_.store(other.slices_.load(std::memory_order_relaxed), std::memory_order_release);
+  }
+
+  // Returns a slice, which is safe to call from the audio thread.
   [[nodiscard]] const SliceState* Get(uint32_t slice_index) const noexcept {
-    if (slice_index < count_) {
-      return &slices_[slice_index];
+    if (slice_index != kInvalidIndex) {
+      return &slices_.load(std::memory_order_acquire)[slice_index];
     }
     return nullptr;
   }
 
+  // Selects a slice for a given pitch, which is safe to call from the audio thread.
   [[nodiscard]] uint32_t Select(uint32_t first_slice_index, float pitch,
                                 AudioRng& rng) const noexcept {
     if (first_slice_index == kInvalidIndex) {
       return kInvalidIndex;
     }
+    const SliceState* slices = slices_.load(std::memory_order_acquire);
 
     static constexpr uint32_t kMaxSelectedCount = 16;
     std::array<uint32_t, kMaxSelectedCount> selected_slices;
@@ -91,24 +128,24 @@ class SlicePool {
     uint32_t slice_index = first_slice_index;
     while (slice_index != kInvalidIndex) {
       if (selected_slice_count == 0 ||
-          slices_[slice_index].root_pitch ==
-              slices_[selected_slices[selected_slice_count - 1]].root_pitch) {
+          slices[slice_index].root_pitch ==
+              slices[selected_slices[selected_slice_count - 1]].root_pitch) {
         if (selected_slice_count < kMaxSelectedCount) {
           selected_slices[selected_slice_count++] = slice_index;
         }
       } else {
-        const SliceState& slice = slices_[slice_index];
-        const float previous_root_pitch = slices_[selected_slices[0]].root_pitch;
+        const SliceState& slice = slices[slice_index];
+        const float previous_root_pitch = slices[selected_slices[0]].root_pitch;
         if (pitch <= slice.root_pitch) {
           if (pitch - previous_root_pitch > slice.root_pitch - pitch) {
             selected_slices[0] = slice_index;
             selected_slice_count = 1;
             while (slice_index != kInvalidIndex &&
-                   slices_[slice_index].root_pitch == slice.root_pitch) {
+                   slices[slice_index].root_pitch == slice.root_pitch) {
               if (selected_slice_count < kMaxSelectedCount) {
                 selected_slices[selected_slice_count++] = slice_index;
               }
-              slice_index = slices_[slice_index].next_slice_index;
+              slice_index = slices[slice_index].next_slice_index;
             }
           }
           return selected_slices[(selected_slice_count == 1)
@@ -118,7 +155,7 @@ class SlicePool {
         selected_slices[0] = slice_index;
         selected_slice_count = 1;
       }
-      slice_index = slices_[slice_index].next_slice_index;
+      slice_index = slices[slice_index].next_slice_index;
     }
 
     assert(selected_slice_count > 0);
@@ -126,13 +163,15 @@ class SlicePool {
   }
 
  private:
-  SliceState* slices_ = nullptr;
+  // Written by the control thread, and read by both threads.
+  std::atomic<SliceState*> slices_ = nullptr;
   uint32_t* free_ = nullptr;
 
   uint32_t count_ = 0;
   uint32_t free_read_index_ = 0;
   uint32_t free_write_index_ = 0;
   uint32_t free_count_ = 0;
+  uint32_t max_active_count_ = 0;  // since construction
 };
 
 }  // namespace barely
@@ -0,0 +1,160 @@
+#ifndef BARELYMUSICIAN_ENGINE_TASK_EVENT_QUEUE_H_
+#define BARELYMUSICIAN_ENGINE_TASK_EVENT_QUEUE_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <span>
+#include <utility>
+
+#include "core/arena.h"
+#include "core/constants.h"
+
+namespace barely {
+
+// Priority queue of performers that is ordered by the beat of their next task event.
+class TaskEventQueue {
+ public:
+  struct Event {
+    // Engine beat of the event.
+    double beat = 0.0;
+
+    // Task priority of the event.
+    int32_t priority = 0;
+  };
+
+  TaskEventQueue(Arena& arena, uint32_t count) noexcept
+      : events_(arena.AllocArray<Event>(count)),
+        heap_(arena.AllocArray<uint32_t>(count)),
+        heap_indices_(arena.AllocArray<uint32_t>(count)),
+        performer_indices_(arena.AllocArray<uint32_t>(count)) {
+    if (arena.is_null()) {
+      return;
+    }
+    assert(count > 0);
+    std::fill_n(heap_indices_, count, kInvalidIndex);
+  }
+
+  // Returns the performers with an event at or before a given beat in an arbitrary order, which
+  // remain valid until the next call.
+  [[nodiscard]] std::span<uint32_t> GetPerformersUntil(double beat) noexcept {
+    uint32_t count = 0;
+    if (size_ > 0 && events_[heap_[0]].beat <= beat) {
+      performer_indices_[count++] = 0;
+    }
+    // Visit the heap breadth-first, which only descends through the events that are due.
+    for (uint32_t i = 0; i < count; ++i) {
+      for (uint32_t child_heap_index = 2 * performer_indices_[i] + 1;
+           child_heap_index < std::min(2 * performer_indices_[i] + 3, size_); ++child_heap_index) {
+        if (events_[heap_[child_heap_index]].beat <= beat) {
+          performer_indices_[count++] = child_heap_index;
+        }
+      }
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+      performer_indices_[i] = heap_[performer_indices_[i]];
+    }
+    return {performer_indices_, count};
+  }
+
+  // Returns the next event.
+  [[nodiscard]] const Event& GetNext() const noexcept {
+    assert(size_ > 0);
+    return events_[heap_[0]];
+  }
+
+  // Returns whether the queue is empty or not.
+  [[nodiscard]] bool IsEmpty() const noexcept { return size_ == 0; }
+
+  // Removes the event of a performer, if any.
+  void Remove(uint32_t performer_index) noexcept {
+    const uint32_t heap_index = heap_indices_[performer_index];
+    if (heap_index == kInvalidIndex) {
+      return;
+    }
+    heap_indices_[performer_index] = kInvalidIndex;
+    if (const uint32_t last_performer_index = heap_[--size_]; heap_index < size_) {
+      heap_[heap_index] = last_performer_index;
+      heap_indices_[last_performer_index] = heap_index;
+      SiftDown(SiftUp(heap_index));
+    }
+  }
+
+  // Sets the event of a performer.
+  void Set(uint32_t performer_index, double beat, int32_t priority) noexcept {
+    events_[performer_index] = {beat, priority};
+    uint32_t heap_index = heap_indices_[performer_index];
+    if (heap_index == kInvalidIndex) {
+      heap_index = size_++;
+      heap_[heap_index] = performer_index;
+      heap_indices_[performer_index] = heap_index;
+    }
+    SiftDown(SiftUp(heap_index));
+  }
+
+ private:
+  [[nodiscard]] bool IsBefore(uint32_t performer_index, uint32_t other_performer_index) const {
+    const Event& event = events_[performer_index];
+    const Event& other_event = events_[other_performer_index];
+    if (event.beat != other_event.beat) {
+      return event.beat < other_event.beat;
+    }
+    if (event.priority != other_event.priority) {
+      return event.priority < other_event.priority;
+    }
+    return performer_index < other_performer_index;
+  }
+
+  void Swap(uint32_t heap_index, uint32_t other_heap_index) noexcept {
+    std::swap(heap_[heap_index], heap_[other_heap_index]);
+    heap_indices_[heap_[heap_index]] = heap_index;
+    heap_indices_[heap_[other_heap_index]] = other_heap_index;
+  }
+
+  void SiftDown(uint32_t heap_index) noexcept {
+    while (true) {
+      uint32_t min_heap_index = heap_index;
+      for (uint32_t child_heap_index = 2 * heap_index + 1;
+           child_heap_index < std::min(2 * heap_index + 3, size_); ++child_heap_index) {
+        if (IsBefore(heap_[child_heap_index], heap_[min_heap_index])) {
+          min_heap_index = child_heap_index;
+        }
+      }
+      if (min_heap_index == heap_index) {
+        return;
+      }
+      Swap(heap_index, min_heap_index);
+      heap_index = min_heap_index;
+    }
+  }
+
+  [[nodiscard]] uint32_t SiftUp(uint32_t heap_index) noexcept {
+    while (heap_index > 0) {
+      const uint32_t parent_heap_index = (heap_index - 1) / 2;
+      if (!IsBefore(heap_[heap_index], heap_[parent_heap_index])) {
+        break;
+      }
+      Swap(heap_index, parent_heap_index);
+      heap_index = parent_heap_index;
+    }
+    return heap_index;
+  }
+
+  // Array of events per performer.
+  Event* events_ = nullptr;
+
+  // Array of performer indices in heap order.
+  uint32_t* heap_ = nullptr;
+
+  // Array of heap indices per performer.
+  uint32_t* heap_indices_ = nullptr;
+
+  // Array of performer indices that are returned by `GetPerformersUntil`.
+  uint32_t* performer_indices_ = nullptr;
+
+  uint32_t size_ = 0;
+};
+
+}  // namespace barely
+
+#endif  // BARELYMUSICIAN_ENGINE_TASK_EVENT_QUEUE_H_
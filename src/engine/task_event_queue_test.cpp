@@ -0,0 +1,90 @@
+#include "engine/task_event_queue.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "core/arena.h"
+#include "gmock/gmock-matchers.h"
+#include "gtest/gtest.h"
+
+namespace barely {
+namespace {
+
+using ::testing::UnorderedElementsAre;
+
+constexpr uint32_t kPerformerCount = 100;
+
+TEST(TaskEventQueueTest, SetRemove) {
+  const auto size = GetAllocSize<TaskEventQueue>(kPerformerCount);
+  auto data = std::make_unique<std::byte[]>(size);
+  Arena arena(data.get(), size);
+  TaskEventQueue queue(arena, kPerformerCount);
+  EXPECT_TRUE(queue.IsEmpty());
+
+  queue.Set(0, 2.0, 0);
+  queue.Set(1, 1.0, 5);
+  queue.Set(2, 1.0, -5);
+  EXPECT_FALSE(queue.IsEmpty());
+  EXPECT_DOUBLE_EQ(queue.GetNext().beat, 1.0);
+  EXPECT_EQ(queue.GetNext().priority, -5);
+
+  // Update an existing event.
+  queue.Set(2, 3.0, -5);
+  EXPECT_DOUBLE_EQ(queue.GetNext().beat, 1.0);
+  EXPECT_EQ(queue.GetNext().priority, 5);
+
+  queue.Remove(1);
+  EXPECT_DOUBLE_EQ(queue.GetNext().beat, 2.0);
+  queue.Remove(1);  // no-op
+  queue.Remove(0);
+  EXPECT_DOUBLE_EQ(queue.GetNext().beat, 3.0);
+  queue.Remove(2);
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+TEST(TaskEventQueueTest, GetPerformersUntil) {
+  const auto size = GetAllocSize<TaskEventQueue>(kPerformerCount);
+  auto data = std::make_unique<std::byte[]>(size);
+  Arena arena(data.get(), size);
+  TaskEventQueue queue(arena, kPerformerCount);
+  EXPECT_TRUE(queue.GetPerformersUntil(10.0).empty());
+
+  for (uint32_t i = 0; i < kPerformerCount; ++i) {
+    queue.Set(i, static_cast<double>((i * 37) % kPerformerCount), 0);
+  }
+  EXPECT_THAT(queue.GetPerformersUntil(0.0), UnorderedElementsAre(0));
+  EXPECT_THAT(queue.GetPerformersUntil(2.0), UnorderedElementsAre(0, 46, 73));
+
+  for (uint32_t i = 0; i < kPerformerCount; i += 2) {
+    queue.Remove(i);
+  }
+  const auto performer_indices = queue.GetPerformersUntil(50.0);
+  std::vector<uint32_t> expected_performer_indices;
+  for (uint32_t i = 1; i < kPerformerCount; i += 2) {
+    if ((i * 37) % kPerformerCount <= 50) {
+      expected_performer_indices.push_back(i);
+    }
+  }
+  EXPECT_EQ(performer_indices.size(), expected_performer_indices.size());
+  for (const uint32_t performer_index : performer_indices) {
+    EXPECT_NE(std::find(expected_performer_indices.begin(), expected_performer_indices.end(),
+                        performer_index),
+              expected_performer_indices.end());
+  }
+
+  // Pop all events in order.
+  double beat = 0.0;
+  while (!queue.IsEmpty()) {
+    EXPECT_GE(queue.GetNext().beat, beat);
+    beat = queue.GetNext().beat;
+    const auto next_performer_indices = queue.GetPerformersUntil(beat);
+    ASSERT_EQ(next_performer_indices.size(), 1);
+    queue.Remove(next_performer_indices[0]);
+  }
+}
+
+}  // namespace
+}  // namespace barely
@@ -0,0 +1,76 @@
+#ifndef BARELYMUSICIAN_ENGINE_TASK_STATE_H_
+#define BARELYMUSICIAN_ENGINE_TASK_STATE_H_
+
+#include <barelymusician.h>
+
+#include <cstdint>
+
+#include "core/callback.h"
+#include "core/constants.h"
+
+namespace barely {
+
+struct TaskState {
+  Callback<BarelyTaskCallback> callback = {};
+
+  double position = 0.0;
+  double duration = 0.0;
+  int32_t priority = 0;
+
+  uint32_t performer_index = kInvalidIndex;
+
+  // Task timeline links.
+  uint32_t parent_task_index = kInvalidIndex;
+  uint32_t left_task_index = kInvalidIndex;
+  uint32_t right_task_index = kInvalidIndex;
+
+  // Instrument identifier to play the note of a clip task on, or zero for other tasks.
+  uint32_t instrument_id = 0;
+
+  // Maximum bound position in the task timeline subtree.
+  double max_bound_position = 0.0;
+
+  // Note of a clip task.
+  float pitch = 0.0f;
+  float gain = 1.0f;
+
+  // Denotes whether the task is active or not.
+  bool is_active = false;
+
+  [[nodiscard]] double GetEndPosition() const noexcept { return position + duration; }
+
+  [[nodiscard]] bool IsActiveBefore(const TaskState& other) const noexcept {
+    const double end_position = GetEndPosition();
+    const double other_end_position = other.GetEndPosition();
+    return end_position < other_end_position ||
+           (end_position == other_end_position && priority < other.priority);
+  }
+
+  [[nodiscard]] bool IsInactiveBefore(const TaskState& other) const noexcept {
+    return position < other.position || (position == other.position && priority < other.priority);
+  }
+
+  [[nodiscard]] bool IsInside(double other_position) const noexcept {
+    return other_position >= position && other_position < GetEndPosition();
+  }
+};
+
+// Edit of an active task that is deferred while its performer is updating the active tasks.
+struct TaskEdit {
+  double position = 0.0;
+  double duration = 0.0;
+  int32_t priority = 0;
+
+  // Next task with a deferred edit in the same performer.
+  uint32_t next_task_index = kInvalidIndex;
+
+  // Denotes whether the task is pending to get released or not.
+  bool is_release_pending = false;
+
+  // Denotes whether the edit is deferred or not.
+  bool is_deferred = false;
+};
+
+}  // namespace barely
+
+#endif  // BARELYMUSICIAN_ENGINE_TASK_STATE_H_
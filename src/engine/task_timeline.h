@@ -0,0 +1,398 @@
+#ifndef BARELYMUSICIAN_ENGINE_TASK_TIMELINE_H_
+#define BARELYMUSICIAN_ENGINE_TASK_TIMELINE_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <span>
+#include <utility>
+
+#include "core/constants.h"
+#include "core/pool.h"
+#include "engine/task_state.h"
+
+namespace barely {
+
+// Task timeline order.
+enum class TaskOrder : uint8_t {
+  // Ordered by end position and priority, bounded by position (active tasks).
+  kEnd = 0,
+  // Ordered by position and priority, bounded by end position (inactive tasks).
+  kPosition,
+};
+
+// Ordered set of tasks that is stored as an intrusive treap in the task pool.
+//
+// Tasks with equal keys keep their insertion order. Each subtree tracks its maximum bound position
+// to find the first task that is bounded after a given position. All operations are logarithmic.
+template <TaskOrder kOrder>
+class TaskTimeline {
+ public:
+  // Inserts a task after all the tasks with the same key.
+  void Insert(Pool<TaskState>& task_pool, uint32_t task_index) noexcept {
+    TaskState& task = task_pool.Get(task_index);
+    task.parent_task_index = kInvalidIndex;
+    task.left_task_index = kInvalidIndex;
+    task.right_task_index = kInvalidIndex;
+    task.max_bound_position = GetBoundPosition(task);
+
+    if (root_task_index_ == kInvalidIndex) {
+      root_task_index_ = task_index;
+      return;
+    }
+
+    uint32_t parent_task_index = root_task_index_;
+    while (true) {
+      TaskState& parent_task = task_pool.Get(parent_task_index);
+      parent_task.max_bound_position =
+          std::max(parent_task.max_bound_position, task.max_bound_position);
+      uint32_t& child_task_index =
+          IsBefore(task, parent_task) ? parent_task.left_task_index : parent_task.right_task_index;
+      if (child_task_index == kInvalidIndex) {
+        child_task_index = task_index;
+        task.parent_task_index = parent_task_index;
+        break;
+      }
+      parent_task_index = child_task_index;
+    }
+
+    while (task.parent_task_index != kInvalidIndex &&
+           GetHeapPriority(task_index) > GetHeapPriority(task.parent_task_index)) {
+      RotateUp(task_pool, task_index);
+    }
+  }
+
+  // Inserts sorted tasks after all the tasks with the same key, which builds them into a subtree in
+  // linear time to merge it into the timeline at once.
+  void InsertSorted(Pool<TaskState>& task_pool, std::span<const uint32_t> task_indices) noexcept {
+    uint32_t sorted_root_task_index = kInvalidIndex;
+    uint32_t last_task_index = kInvalidIndex;
+    for (const uint32_t task_index : task_indices) {
+      TaskState& task = task_pool.Get(task_index);
+      assert((last_task_index == kInvalidIndex ||
+              !IsBefore(task, task_pool.Get(last_task_index))) &&
+             "Tasks must be sorted");
+      // Tasks with lower heap priorities on the right spine become the left subtree of the task.
+      uint32_t left_task_index = kInvalidIndex;
+      while (last_task_index != kInvalidIndex &&
+             GetHeapPriority(last_task_index) < GetHeapPriority(task_index)) {
+        TaskState& last_task = task_pool.Get(last_task_index);
+        UpdateMaxBoundPosition(task_pool, last_task);
+        left_task_index = last_task_index;
+        last_task_index = last_task.parent_task_index;
+      }
+      task.right_task_index = kInvalidIndex;
+      task.parent_task_index = last_task_index;
+      SetLeft(task_pool, task_index, left_task_index);
+      if (last_task_index != kInvalidIndex) {
+        task_pool.Get(last_task_index).right_task_index = task_index;
+      } else {
+        sorted_root_task_index = task_index;
+      }
+      last_task_index = task_index;
+    }
+    for (; last_task_index != kInvalidIndex;
+         last_task_index = task_pool.Get(last_task_index).parent_task_index) {
+      UpdateMaxBoundPosition(task_pool, task_pool.Get(last_task_index));
+    }
+
+    root_task_index_ = Merge(task_pool, root_task_index_, sorted_root_task_index);
+    if (root_task_index_ != kInvalidIndex) {
+      task_pool.Get(root_task_index_).parent_task_index = kInvalidIndex;
+    }
+  }
+
+  // Removes a task.
+  void Remove(Pool<TaskState>& task_pool, uint32_t task_index) noexcept {
+    TaskState& task = task_pool.Get(task_index);
+    while (task.left_task_index != kInvalidIndex || task.right_task_index != kInvalidIndex) {
+      if (task.right_task_index == kInvalidIndex ||
+          (task.left_task_index != kInvalidIndex &&
+           GetHeapPriority(task.left_task_index) > GetHeapPriority(task.right_task_index))) {
+        RotateUp(task_pool, task.left_task_index);
+      } else {
+        RotateUp(task_pool, task.right_task_index);
+      }
+    }
+
+    const uint32_t parent_task_index = task.parent_task_index;
+    if (parent_task_index == kInvalidIndex) {
+      assert(root_task_index_ == task_index);
+      root_task_index_ = kInvalidIndex;
+    } else {
+      TaskState& parent_task = task_pool.Get(parent_task_index);
+      (parent_task.left_task_index == task_index ? parent_task.left_task_index
+                                                 : parent_task.right_task_index) = kInvalidIndex;
+      UpdateMaxBoundPositions(task_pool, parent_task_index);
+    }
+    task.parent_task_index = kInvalidIndex;
+  }
+
+  // Updates a task after its bound position changed without changing its key.
+  void Update(Pool<TaskState>& task_pool, uint32_t task_index) noexcept {
+    UpdateMaxBoundPositions(task_pool, task_index);
+  }
+
+  // Returns the first task, or an invalid index if the timeline is empty.
+  [[nodiscard]] uint32_t GetFirst(const Pool<TaskState>& task_pool) const noexcept {
+    uint32_t task_index = root_task_index_;
+    if (task_index != kInvalidIndex) {
+      for (uint32_t left_task_index = task_pool.Get(task_index).left_task_index;
+           left_task_index != kInvalidIndex;
+           left_task_index = task_pool.Get(task_index).left_task_index) {
+        task_index = left_task_index;
+      }
+    }
+    return task_index;
+  }
+
+  // Returns the first task with a bound position after a given position, or an invalid index.
+  [[nodiscard]] uint32_t GetFirstBoundAfter(const Pool<TaskState>& task_pool,
+                                            double position) const noexcept {
+    uint32_t task_index = root_task_index_;
+    if (task_index == kInvalidIndex || task_pool.Get(task_index).max_bound_position <= position) {
+      return kInvalidIndex;
+    }
+    while (true) {
+      const TaskState& task = task_pool.Get(task_index);
+      if (task.left_task_index != kInvalidIndex &&
+          task_pool.Get(task.left_task_index).max_bound_position > position) {
+        task_index = task.left_task_index;
+      } else if (GetBoundPosition(task) > position) {
+        return task_index;
+      } else {
+        assert(task.right_task_index != kInvalidIndex);
+        task_index = task.right_task_index;
+      }
+    }
+  }
+
+  // Returns the first task with a key that is not before a given key, or an invalid index.
+  [[nodiscard]] uint32_t GetLowerBound(const Pool<TaskState>& task_pool, double key_position,
+                                       int32_t priority) const noexcept {
+    uint32_t lower_bound_task_index = kInvalidIndex;
+    uint32_t task_index = root_task_index_;
+    while (task_index != kInvalidIndex) {
+      const TaskState& task = task_pool.Get(task_index);
+      const double task_key_position = GetKeyPosition(task);
+      if (task_key_position < key_position ||
+          (task_key_position == key_position && task.priority < priority)) {
+        task_index = task.right_task_index;
+      } else {
+        lower_bound_task_index = task_index;
+        task_index = task.left_task_index;
+      }
+    }
+    return lower_bound_task_index;
+  }
+
+  // Returns the next task in order, or an invalid index.
+  [[nodiscard]] uint32_t GetNext(const Pool<TaskState>& task_pool,
+                                 uint32_t task_index) const noexcept {
+    const TaskState& task = task_pool.Get(task_index);
+    if (task.right_task_index != kInvalidIndex) {
+      task_index = task.right_task_index;
+      for (uint32_t left_task_index = task_pool.Get(task_index).left_task_index;
+           left_task_index != kInvalidIndex;
+           left_task_index = task_pool.Get(task_index).left_task_index) {
+        task_index = left_task_index;
+      }
+      return task_index;
+    }
+    uint32_t parent_task_index = task.parent_task_index;
+    while (parent_task_index != kInvalidIndex &&
+           task_pool.Get(parent_task_index).right_task_index == task_index) {
+      task_index = parent_task_index;
+      parent_task_index = task_pool.Get(parent_task_index).parent_task_index;
+    }
+    return parent_task_index;
+  }
+
+  // Returns the first task with a key that is after a given key, or an invalid index.
+  [[nodiscard]] uint32_t GetUpperBound(const Pool<TaskState>& task_pool, double key_position,
+                                       int32_t priority) const noexcept {
+    uint32_t upper_bound_task_index = kInvalidIndex;
+    uint32_t task_index = root_task_index_;
+    while (task_index != kInvalidIndex) {
+      const TaskState& task = task_pool.Get(task_index);
+      const double task_key_position = GetKeyPosition(task);
+      if (task_key_position < key_position ||
+          (task_key_position == key_position && task.priority <= priority)) {
+        task_index = task.right_task_index;
+      } else {
+        upper_bound_task_index = task_index;
+        task_index = task.left_task_index;
+      }
+    }
+    return upper_bound_task_index;
+  }
+
+  // Returns whether the timeline is empty or not.
+  [[nodiscard]] bool IsEmpty() const noexcept { return root_task_index_ == kInvalidIndex; }
+
+ private:
+  [[nodiscard]] static double GetBoundPosition(const TaskState& task) noexcept {
+    if constexpr (kOrder == TaskOrder::kEnd) {
+      return task.position;
+    } else {
+      return task.GetEndPosition();
+    }
+  }
+
+  [[nodiscard]] static double GetKeyPosition(const TaskState& task) noexcept {
+    if constexpr (kOrder == TaskOrder::kEnd) {
+      return task.GetEndPosition();
+    } else {
+      return task.position;
+    }
+  }
+
+  // Returns a pseudo-random heap priority that is derived from the task index, which keeps the
+  // expected depth logarithmic regardless of the insertion order.
+  [[nodiscard]] static uint32_t GetHeapPriority(uint32_t task_index) noexcept {
+    task_index ^= task_index >> 16;
+    task_index *= 0x85ebca6bu;
+    task_index ^= task_index >> 13;
+    task_index *= 0xc2b2ae35u;
+    task_index ^= task_index >> 16;
+    return task_index;
+  }
+
+  [[nodiscard]] static bool IsBefore(const TaskState& task, const TaskState& other) noexcept {
+    if constexpr (kOrder == TaskOrder::kEnd) {
+      return task.IsActiveBefore(other);
+    } else {
+      return task.IsInactiveBefore(other);
+    }
+  }
+
+  // Merges two subtrees, where the tasks of the latter subtree are ordered after the ones with the
+  // same key in the former subtree.
+  [[nodiscard]] static uint32_t Merge(Pool<TaskState>& task_pool, uint32_t task_index,
+                                      uint32_t other_task_index) noexcept {
+    if (task_index == kInvalidIndex) {
+      return other_task_index;
+    }
+    if (other_task_index == kInvalidIndex) {
+      return task_index;
+    }
+    if (GetHeapPriority(task_index) > GetHeapPriority(other_task_index)) {
+      const TaskState& task = task_pool.Get(task_index);
+      const auto [left_task_index, right_task_index] =
+          Split(task_pool, other_task_index, task, /*is_inclusive=*/false);
+      SetChildren(task_pool, task_index, Merge(task_pool, task.left_task_index, left_task_index),
+                  Merge(task_pool, task.right_task_index, right_task_index));
+      return task_index;
+    }
+    const TaskState& other_task = task_pool.Get(other_task_index);
+    const auto [left_task_index, right_task_index] =
+        Split(task_pool, task_index, other_task, /*is_inclusive=*/true);
+    SetChildren(task_pool, other_task_index,
+                Merge(task_pool, left_task_index, other_task.left_task_index),
+                Merge(task_pool, right_task_index, other_task.right_task_index));
+    return other_task_index;
+  }
+
+  // Splits a subtree into the tasks that are ordered before a given task, optionally including the
+  // ones with the same key, and the rest.
+  [[nodiscard]] static std::pair<uint32_t, uint32_t> Split(Pool<TaskState>& task_pool,
+                                                           uint32_t task_index,
+                                                           const TaskState& split_task,
+                                                           bool is_inclusive) noexcept {
+    if (task_index == kInvalidIndex) {
+      return {kInvalidIndex, kInvalidIndex};
+    }
+    const TaskState& task = task_pool.Get(task_index);
+    if (IsBefore(task, split_task) || (is_inclusive && !IsBefore(split_task, task))) {
+      const auto [left_task_index, right_task_index] =
+          Split(task_pool, task.right_task_index, split_task, is_inclusive);
+      SetChildren(task_pool, task_index, task.left_task_index, left_task_index);
+      return {task_index, right_task_index};
+    }
+    const auto [left_task_index, right_task_index] =
+        Split(task_pool, task.left_task_index, split_task, is_inclusive);
+    SetChildren(task_pool, task_index, right_task_index, task.right_task_index);
+    return {left_task_index, task_index};
+  }
+
+  static void SetChildren(Pool<TaskState>& task_pool, uint32_t task_index,
+                          uint32_t left_task_index, uint32_t right_task_index) noexcept {
+    TaskState& task = task_pool.Get(task_index);
+    SetLeft(task_pool, task_index, left_task_index);
+    task.right_task_index = right_task_index;
+    if (right_task_index != kInvalidIndex) {
+      task_pool.Get(right_task_index).parent_task_index = task_index;
+    }
+    UpdateMaxBoundPosition(task_pool, task);
+  }
+
+  static void SetLeft(Pool<TaskState>& task_pool, uint32_t task_index,
+                      uint32_t left_task_index) noexcept {
+    task_pool.Get(task_index).left_task_index = left_task_index;
+    if (left_task_index != kInvalidIndex) {
+      task_pool.Get(left_task_index).parent_task_index = task_index;
+    }
+  }
+
+  // Rotates a task above its parent while keeping the order.
+  void RotateUp(Pool<TaskState>& task_pool, uint32_t task_index) noexcept {
+    TaskState& task = task_pool.Get(task_index);
+    const uint32_t parent_task_index = task.parent_task_index;
+    TaskState& parent_task = task_pool.Get(parent_task_index);
+    const uint32_t grandparent_task_index = parent_task.parent_task_index;
+
+    if (parent_task.left_task_index == task_index) {
+      parent_task.left_task_index = task.right_task_index;
+      if (task.right_task_index != kInvalidIndex) {
+        task_pool.Get(task.right_task_index).parent_task_index = parent_task_index;
+      }
+      task.right_task_index = parent_task_index;
+    } else {
+      parent_task.right_task_index = task.left_task_index;
+      if (task.left_task_index != kInvalidIndex) {
+        task_pool.Get(task.left_task_index).parent_task_index = parent_task_index;
+      }
+      task.left_task_index = parent_task_index;
+    }
+    parent_task.parent_task_index = task_index;
+    task.parent_task_index = grandparent_task_index;
+
+    if (grandparent_task_index == kInvalidIndex) {
+      root_task_index_ = task_index;
+    } else if (TaskState& grandparent_task = task_pool.Get(grandparent_task_index);
+               grandparent_task.left_task_index == parent_task_index) {
+      grandparent_task.left_task_index = task_index;
+    } else {
+      grandparent_task.right_task_index = task_index;
+    }
+
+    UpdateMaxBoundPosition(task_pool, parent_task);
+    UpdateMaxBoundPosition(task_pool, task);
+  }
+
+  static void UpdateMaxBoundPosition(const Pool<TaskState>& task_pool, TaskState& task) noexcept {
+    task.max_bound_position = GetBoundPosition(task);
+    if (task.left_task_index != kInvalidIndex) {
+      task.max_bound_position =
+          std::max(task.max_bound_position, task_pool.Get(task.left_task_index).max_bound_position);
+    }
+    if (task.right_task_index != kInvalidIndex) {
+      task.max_bound_position = std::max(task.max_bound_position,
+                                         task_pool.Get(task.right_task_index).max_bound_position);
+    }
+  }
+
+  static void UpdateMaxBoundPositions(Pool<TaskState>& task_pool, uint32_t task_index) noexcept {
+    while (task_index != kInvalidIndex) {
+      TaskState& task = task_pool.Get(task_index);
+      UpdateMaxBoundPosition(task_pool, task);
+      task_index = task.parent_task_index;
+    }
+  }
+
+  uint32_t root_task_index_ = kInvalidIndex;
+};
+
+}  // namespace barely
+
+#endif  // BARELYMUSICIAN_ENGINE_TASK_TIMELINE_H_
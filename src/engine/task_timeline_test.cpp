@@ -0,0 +1,216 @@
+#include "engine/task_timeline.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "core/arena.h"
+#include "core/constants.h"
+#include "core/pool.h"
+#include "engine/task_state.h"
+#include "gmock/gmock-matchers.h"
+#include "gtest/gtest.h"
+
+namespace barely {
+namespace {
+
+using ::testing::ElementsAre;
+
+constexpr uint32_t kTaskCount = 1000;
+
+template <TaskOrder kOrder>
+std::vector<uint32_t> GetAll(const TaskTimeline<kOrder>& timeline,
+                             const Pool<TaskState>& task_pool) {
+  std::vector<uint32_t> task_indices;
+  for (uint32_t task_index = timeline.GetFirst(task_pool); task_index != kInvalidIndex;
+       task_index = timeline.GetNext(task_pool, task_index)) {
+    task_indices.push_back(task_index);
+  }
+  return task_indices;
+}
+
+uint32_t AcquireTask(Pool<TaskState>& task_pool, double position, double duration,
+                     int32_t priority) {
+  const uint32_t task_index = task_pool.Acquire();
+  auto& task = task_pool.Get(task_index);
+  task.position = position;
+  task.duration = duration;
+  task.priority = priority;
+  return task_index;
+}
+
+TEST(TaskTimelineTest, InsertRemove) {
+  const auto size = GetAllocSize<Pool<TaskState>>(kTaskCount);
+  auto data = std::make_unique<std::byte[]>(size);
+  Arena arena(data.get(), size);
+  Pool<TaskState> task_pool(arena, kTaskCount);
+
+  TaskTimeline<TaskOrder::kPosition> timeline;
+  EXPECT_TRUE(timeline.IsEmpty());
+  EXPECT_EQ(timeline.GetFirst(task_pool), kInvalidIndex);
+
+  const uint32_t task_0 = AcquireTask(task_pool, 2.0, 1.0, 0);
+  const uint32_t task_1 = AcquireTask(task_pool, 1.0, 0.5, 1);
+  const uint32_t task_2 = AcquireTask(task_pool, 1.0, 4.0, -1);
+  const uint32_t task_3 = AcquireTask(task_pool, 1.0, 0.0, 1);  // same key as `task_1`.
+  for (const uint32_t task_index : {task_0, task_1, task_2, task_3}) {
+    timeline.Insert(task_pool, task_index);
+  }
+  EXPECT_FALSE(timeline.IsEmpty());
+  EXPECT_THAT(GetAll(timeline, task_pool), ElementsAre(task_2, task_1, task_3, task_0));
+
+  timeline.Remove(task_pool, task_1);
+  EXPECT_THAT(GetAll(timeline, task_pool), ElementsAre(task_2, task_3, task_0));
+
+  timeline.Remove(task_pool, task_2);
+  timeline.Remove(task_pool, task_0);
+  EXPECT_THAT(GetAll(timeline, task_pool), ElementsAre(task_3));
+
+  timeline.Remove(task_pool, task_3);
+  EXPECT_TRUE(timeline.IsEmpty());
+}
+
+TEST(TaskTimelineTest, InsertSorted) {
+  const auto size = GetAllocSize<Pool<TaskState>>(kTaskCount);
+  auto data = std::make_unique<std::byte[]>(size);
+  Arena arena(data.get(), size);
+  Pool<TaskState> task_pool(arena, kTaskCount);
+
+  TaskTimeline<TaskOrder::kPosition> timeline;
+  const uint32_t task_0 = AcquireTask(task_pool, 2.0, 1.0, 0);
+  const uint32_t task_1 = AcquireTask(task_pool, 1.0, 0.5, 0);
+  for (const uint32_t task_index : {task_0, task_1}) {
+    timeline.Insert(task_pool, task_index);
+  }
+
+  const uint32_t task_2 = AcquireTask(task_pool, 0.0, 4.0, 0);
+  const uint32_t task_3 = AcquireTask(task_pool, 1.0, 0.0, 0);  // same key as `task_1`.
+  const uint32_t task_4 = AcquireTask(task_pool, 1.0, 0.0, 0);  // same key as `task_1`.
+  const uint32_t task_5 = AcquireTask(task_pool, 3.0, 0.0, -1);
+  const std::vector<uint32_t> sorted_task_indices = {task_2, task_3, task_4, task_5};
+  timeline.InsertSorted(task_pool, sorted_task_indices);
+  EXPECT_THAT(GetAll(timeline, task_pool),
+              ElementsAre(task_2, task_1, task_3, task_4, task_0, task_5));
+  EXPECT_EQ(timeline.GetFirstBoundAfter(task_pool, 3.0), task_2);
+  EXPECT_EQ(timeline.GetFirstBoundAfter(task_pool, 4.0), kInvalidIndex);
+
+  for (const uint32_t task_index : {task_2, task_0, task_3}) {
+    timeline.Remove(task_pool, task_index);
+  }
+  EXPECT_THAT(GetAll(timeline, task_pool), ElementsAre(task_1, task_4, task_5));
+  EXPECT_EQ(timeline.GetFirstBoundAfter(task_pool, 1.0), task_1);
+
+  // Insert many sorted tasks with equal keys in batches.
+  std::vector<uint32_t> task_indices;
+  for (uint32_t i = 0; task_pool.CanAcquire(); ++i) {
+    task_indices.push_back(AcquireTask(task_pool, static_cast<double>(i / 50), 0.0, 0));
+    if (task_indices.size() == 100 || !task_pool.CanAcquire()) {
+      timeline.InsertSorted(task_pool, task_indices);
+      task_indices.clear();
+    }
+  }
+  const std::vector<uint32_t> ordered_task_indices = GetAll(timeline, task_pool);
+  ASSERT_EQ(ordered_task_indices.size(), kTaskCount - 3);
+  for (uint32_t i = 1; i < ordered_task_indices.size(); ++i) {
+    const auto& prev_task = task_pool.Get(ordered_task_indices[i - 1]);
+    const auto& task = task_pool.Get(ordered_task_indices[i]);
+    EXPECT_FALSE(task.IsInactiveBefore(prev_task));
+  }
+}
+
+TEST(TaskTimelineTest, Bounds) {
+  const auto size = GetAllocSize<Pool<TaskState>>(kTaskCount);
+  auto data = std::make_unique<std::byte[]>(size);
+  Arena arena(data.get(), size);
+  Pool<TaskState> task_pool(arena, kTaskCount);
+
+  TaskTimeline<TaskOrder::kPosition> timeline;
+  const uint32_t task_0 = AcquireTask(task_pool, 0.0, 5.0, 0);
+  const uint32_t task_1 = AcquireTask(task_pool, 1.0, 0.5, 0);
+  const uint32_t task_2 = AcquireTask(task_pool, 2.0, 0.0, -1);
+  const uint32_t task_3 = AcquireTask(task_pool, 2.0, 0.0, 1);
+  for (const uint32_t task_index : {task_0, task_1, task_2, task_3}) {
+    timeline.Insert(task_pool, task_index);
+  }
+
+  EXPECT_EQ(timeline.GetLowerBound(task_pool, 1.0, INT32_MIN), task_1);
+  EXPECT_EQ(timeline.GetLowerBound(task_pool, 2.0, 0), task_3);
+  EXPECT_EQ(timeline.GetLowerBound(task_pool, 2.0, 2), kInvalidIndex);
+  EXPECT_EQ(timeline.GetUpperBound(task_pool, 1.0, INT32_MAX), task_2);
+  EXPECT_EQ(timeline.GetUpperBound(task_pool, 2.0, -1), task_3);
+  EXPECT_EQ(timeline.GetUpperBound(task_pool, 2.0, 1), kInvalidIndex);
+
+  // End positions are used as bounds.
+  EXPECT_EQ(timeline.GetFirstBoundAfter(task_pool, 1.25), task_0);
+  EXPECT_EQ(timeline.GetFirstBoundAfter(task_pool, 5.0), kInvalidIndex);
+
+  task_pool.Get(task_0).duration = 1.0;
+  timeline.Update(task_pool, task_0);
+  EXPECT_EQ(timeline.GetFirstBoundAfter(task_pool, 1.25), task_1);
+  EXPECT_EQ(timeline.GetFirstBoundAfter(task_pool, 1.5), task_2);
+  EXPECT_EQ(timeline.GetFirstBoundAfter(task_pool, 2.0), kInvalidIndex);
+}
+
+TEST(TaskTimelineTest, ActiveOrder) {
+  const auto size = GetAllocSize<Pool<TaskState>>(kTaskCount);
+  auto data = std::make_unique<std::byte[]>(size);
+  Arena arena(data.get(), size);
+  Pool<TaskState> task_pool(arena, kTaskCount);
+
+  TaskTimeline<TaskOrder::kEnd> timeline;
+  const uint32_t task_0 = AcquireTask(task_pool, 0.0, 3.0, 0);
+  const uint32_t task_1 = AcquireTask(task_pool, 1.0, 1.0, 0);
+  const uint32_t task_2 = AcquireTask(task_pool, 1.5, 0.5, -1);
+  for (const uint32_t task_index : {task_0, task_1, task_2}) {
+    timeline.Insert(task_pool, task_index);
+  }
+  EXPECT_THAT(GetAll(timeline, task_pool), ElementsAre(task_2, task_1, task_0));
+
+  // Positions are used as bounds.
+  EXPECT_EQ(timeline.GetFirstBoundAfter(task_pool, 1.0), task_2);
+  EXPECT_EQ(timeline.GetFirstBoundAfter(task_pool, 0.5), task_2);
+  EXPECT_EQ(timeline.GetFirstBoundAfter(task_pool, -1.0), task_2);
+  EXPECT_EQ(timeline.GetFirstBoundAfter(task_pool, 1.5), kInvalidIndex);
+}
+
+TEST(TaskTimelineTest, ManyTasks) {
+  const auto size = GetAllocSize<Pool<TaskState>>(kTaskCount);
+  auto data = std::make_unique<std::byte[]>(size);
+  Arena arena(data.get(), size);
+  Pool<TaskState> task_pool(arena, kTaskCount);
+
+  TaskTimeline<TaskOrder::kPosition> timeline;
+  std::vector<uint32_t> task_indices;
+  for (uint32_t i = 0; i < kTaskCount; ++i) {
+    // Insert in a scrambled order with many equal keys.
+    const double position = static_cast<double>((i * 7919) % 97);
+    task_indices.push_back(AcquireTask(task_pool, position, 0.0, static_cast<int32_t>(i % 3)));
+    timeline.Insert(task_pool, task_indices.back());
+  }
+
+  std::vector<uint32_t> ordered_task_indices = GetAll(timeline, task_pool);
+  ASSERT_EQ(ordered_task_indices.size(), kTaskCount);
+  for (uint32_t i = 1; i < kTaskCount; ++i) {
+    const auto& prev_task = task_pool.Get(ordered_task_indices[i - 1]);
+    const auto& task = task_pool.Get(ordered_task_indices[i]);
+    EXPECT_FALSE(task.IsInactiveBefore(prev_task));
+    if (!prev_task.IsInactiveBefore(task)) {
+      // Equal keys keep their insertion order.
+      EXPECT_LT(ordered_task_indices[i - 1], ordered_task_indices[i]);
+    }
+  }
+
+  for (uint32_t i = 0; i < kTaskCount; i += 2) {
+    timeline.Remove(task_pool, task_indices[i]);
+  }
+  ordered_task_indices = GetAll(timeline, task_pool);
+  ASSERT_EQ(ordered_task_indices.size(), kTaskCount / 2);
+  for (uint32_t i = 1; i < kTaskCount / 2; ++i) {
+    EXPECT_FALSE(task_pool.Get(ordered_task_indices[i])
+                     .IsInactiveBefore(task_pool.Get(ordered_task_indices[i - 1])));
+  }
+}
+
+}  // namespace
+}  // namespace barely
@@ -0,0 +1,163 @@
+#ifndef BARELYMUSICIAN_ENGINE_TEMPO_MAP_H_
+#define BARELYMUSICIAN_ENGINE_TEMPO_MAP_H_
+
+#include <barelymusician.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <span>
+
+#include "core/time.h"
+
+namespace barely {
+
+// Piecewise constant or linear tempo over time, which caches the cumulative beats at each tempo
+// point to convert between beats and seconds in logarithmic time.
+class TempoMap {
+ public:
+  // Maximum number of tempo points.
+  static constexpr uint32_t kMaxPointCount = 64;
+
+  // Returns the number of beats between two timestamps.
+  [[nodiscard]] double GetBeats(double begin_timestamp, double end_timestamp) const noexcept {
+    assert(begin_timestamp <= end_timestamp);
+    const uint32_t begin_index = GetSegmentIndex(begin_timestamp);
+    const uint32_t end_index = GetSegmentIndex(end_timestamp);
+    if (begin_index == end_index) {
+      return GetSegmentBeats(begin_index, begin_timestamp, end_timestamp);
+    }
+    return GetSegmentBeats(begin_index, begin_timestamp, segments_[begin_index + 1].timestamp) +
+           (segments_[end_index].beat - segments_[begin_index + 1].beat) +
+           GetSegmentBeats(end_index, segments_[end_index].timestamp, end_timestamp);
+  }
+
+  // Returns the tempo at a given timestamp.
+  [[nodiscard]] double GetTempo(double timestamp) const noexcept {
+    return GetSegmentTempo(GetSegmentIndex(timestamp), timestamp);
+  }
+
+  // Returns the timestamp after a number of beats from a given timestamp, or infinity if the tempo
+  // stops before reaching there.
+  [[nodiscard]] double GetTimestamp(double timestamp, double beats) const noexcept {
+    assert(beats >= 0.0);
+    uint32_t index = GetSegmentIndex(timestamp);
+    if (index + 1 < segment_count_) {
+      if (const double segment_beats =
+              GetSegmentBeats(index, timestamp, segments_[index + 1].timestamp);
+          beats > segment_beats) {
+        // Solve from the beginning of the first segment that reaches the target beat.
+        const double beat = segments_[index + 1].beat + (beats - segment_beats);
+        index = static_cast<uint32_t>(
+                    std::ranges::lower_bound(segments_.begin() + index + 1,
+                                             segments_.begin() + segment_count_, beat,
+                                             std::less<>{}, &Segment::beat) -
+                    segments_.begin()) -
+                1;
+        timestamp = segments_[index].timestamp;
+        beats = beat - segments_[index].beat;
+      }
+    }
+    return timestamp + GetSegmentDuration(index, timestamp, beats);
+  }
+
+  // Sets the tempo points, which override the constant tempo from the first point onwards.
+  void SetPoints(std::span<const BarelyTempoPoint> points) noexcept {
+    segment_count_ = 1 + static_cast<uint32_t>(std::min(points.size(), size_t{kMaxPointCount}));
+    for (uint32_t i = 1; i < segment_count_; ++i) {
+      const BarelyTempoPoint& point = points[i - 1];
+      segments_[i] = {point.timestamp, std::max(point.tempo, 0.0), point.is_ramp ? 1.0 : 0.0};
+    }
+    std::stable_sort(segments_.begin() + 1, segments_.begin() + segment_count_,
+                     [](const Segment& lhs, const Segment& rhs) noexcept {
+                       return lhs.timestamp < rhs.timestamp;
+                     });
+    // The constant tempo segment extends to the first point, which is the zero beat reference.
+    segments_[0].timestamp = (segment_count_ > 1) ? segments_[1].timestamp : 0.0;
+    for (uint32_t i = 1; i < segment_count_; ++i) {
+      Segment& segment = segments_[i];
+      const Segment* next_segment = (i + 1 < segment_count_) ? &segments_[i + 1] : nullptr;
+      segment.slope = (segment.slope > 0.0 && next_segment != nullptr &&
+                       next_segment->timestamp > segment.timestamp)
+                          ? (next_segment->tempo - segment.tempo) /
+                                (next_segment->timestamp - segment.timestamp)
+                          : 0.0;
+      segment.beat = segments_[i - 1].beat +
+                     GetSegmentBeats(i - 1, segments_[i - 1].timestamp, segment.timestamp);
+    }
+  }
+
+  // Sets a constant tempo, which clears the tempo points.
+  void SetTempo(double tempo) noexcept {
+    segments_[0] = {0.0, std::max(tempo, 0.0), 0.0, 0.0};
+    segment_count_ = 1;
+  }
+
+ private:
+  struct Segment {
+    // Beginning timestamp in seconds.
+    double timestamp = 0.0;
+
+    // Beginning tempo in beats per minute.
+    double tempo = 120.0;
+
+    // Tempo change rate in beats per minute per second.
+    double slope = 0.0;
+
+    // Cumulative beats at the beginning relative to the first tempo point.
+    double beat = 0.0;
+  };
+
+  [[nodiscard]] double GetSegmentBeats(uint32_t index, double begin_timestamp,
+                                       double end_timestamp) const noexcept {
+    // The mean tempo of a linear ramp integrates to the exact number of beats.
+    return SecondsToBeats(GetSegmentTempo(index, 0.5 * (begin_timestamp + end_timestamp)),
+                          end_timestamp - begin_timestamp);
+  }
+
+  [[nodiscard]] double GetSegmentDuration(uint32_t index, double timestamp,
+                                          double beats) const noexcept {
+    if (beats <= 0.0) {
+      return 0.0;
+    }
+    const double tempo = GetSegmentTempo(index, timestamp);
+    const double slope = segments_[index].slope;
+    if (slope == 0.0) {
+      return (tempo > 0.0) ? BeatsToSeconds(tempo, beats) : std::numeric_limits<double>::infinity();
+    }
+    // Solve `tempo * t + slope * t^2 / 2 = 60 * beats` with the numerically stable root.
+    const double scaled_beats = kMinutesToSeconds * beats;
+    const double discriminant = tempo * tempo + 2.0 * slope * scaled_beats;
+    return (discriminant >= 0.0) ? 2.0 * scaled_beats / (tempo + std::sqrt(discriminant))
+                                 : std::numeric_limits<double>::infinity();
+  }
+
+  [[nodiscard]] uint32_t GetSegmentIndex(double timestamp) const noexcept {
+    return static_cast<uint32_t>(std::ranges::upper_bound(segments_.begin() + 1,
+                                                          segments_.begin() + segment_count_,
+                                                          timestamp, std::less<>{},
+                                                          &Segment::timestamp) -
+                                 segments_.begin()) -
+           1;
+  }
+
+  [[nodiscard]] double GetSegmentTempo(uint32_t index, double timestamp) const noexcept {
+    const Segment& segment = segments_[index];
+    return (segment.slope != 0.0)
+               ? std::max(segment.tempo + segment.slope * (timestamp - segment.timestamp), 0.0)
+               : segment.tempo;
+  }
+
+  // Array of segments, where the first one holds the constant tempo before the tempo points.
+  std::array<Segment, kMaxPointCount + 1> segments_ = {};
+  uint32_t segment_count_ = 1;
+};
+
+}  // namespace barely
+
+#endif  // BARELYMUSICIAN_ENGINE_TEMPO_MAP_H_
@@ -0,0 +1,88 @@
+#include "engine/tempo_map.h"
+
+#include <barelymusician.h>
+
+#include <array>
+#include <cmath>
+#include <limits>
+
+#include "gtest/gtest.h"
+
+namespace barely {
+namespace {
+
+TEST(TempoMapTest, ConstantTempo) {
+  TempoMap tempo_map;
+  tempo_map.SetTempo(120.0);
+  EXPECT_DOUBLE_EQ(tempo_map.GetTempo(1.0), 120.0);
+  EXPECT_DOUBLE_EQ(tempo_map.GetBeats(1.0, 4.0), 6.0);
+  EXPECT_DOUBLE_EQ(tempo_map.GetTimestamp(1.0, 6.0), 4.0);
+
+  tempo_map.SetTempo(0.0);
+  EXPECT_DOUBLE_EQ(tempo_map.GetBeats(1.0, 4.0), 0.0);
+  EXPECT_DOUBLE_EQ(tempo_map.GetTimestamp(1.0, 0.0), 1.0);
+  EXPECT_EQ(tempo_map.GetTimestamp(1.0, 1.0), std::numeric_limits<double>::infinity());
+}
+
+TEST(TempoMapTest, ConstantPoints) {
+  TempoMap tempo_map;
+  tempo_map.SetTempo(60.0);
+
+  // Pass the points out of order, which should get sorted by their timestamps.
+  const std::array<BarelyTempoPoint, 3> points = {
+      BarelyTempoPoint{4.0, 0.0, false},
+      BarelyTempoPoint{1.0, 120.0, false},
+      BarelyTempoPoint{2.0, 240.0, false},
+  };
+  tempo_map.SetPoints(points);
+  EXPECT_DOUBLE_EQ(tempo_map.GetTempo(0.5), 60.0);
+  EXPECT_DOUBLE_EQ(tempo_map.GetTempo(1.0), 120.0);
+  EXPECT_DOUBLE_EQ(tempo_map.GetTempo(3.0), 240.0);
+  EXPECT_DOUBLE_EQ(tempo_map.GetTempo(5.0), 0.0);
+
+  EXPECT_DOUBLE_EQ(tempo_map.GetBeats(0.0, 1.0), 1.0);
+  EXPECT_DOUBLE_EQ(tempo_map.GetBeats(0.0, 2.0), 3.0);
+  EXPECT_DOUBLE_EQ(tempo_map.GetBeats(0.5, 3.0), 6.5);
+  EXPECT_DOUBLE_EQ(tempo_map.GetBeats(0.0, 10.0), 11.0);
+
+  EXPECT_DOUBLE_EQ(tempo_map.GetTimestamp(0.0, 1.0), 1.0);
+  EXPECT_DOUBLE_EQ(tempo_map.GetTimestamp(0.0, 3.0), 2.0);
+  EXPECT_DOUBLE_EQ(tempo_map.GetTimestamp(0.5, 6.5), 3.0);
+  EXPECT_DOUBLE_EQ(tempo_map.GetTimestamp(0.0, 11.0), 4.0);
+  EXPECT_EQ(tempo_map.GetTimestamp(0.0, 12.0), std::numeric_limits<double>::infinity());
+
+  // Setting the tempo should clear the points.
+  tempo_map.SetTempo(60.0);
+  EXPECT_DOUBLE_EQ(tempo_map.GetBeats(0.0, 10.0), 10.0);
+}
+
+TEST(TempoMapTest, RampPoints) {
+  TempoMap tempo_map;
+  tempo_map.SetTempo(60.0);
+
+  // Ramp from 60 to 180 beats per minute in two seconds, which takes four beats.
+  const std::array<BarelyTempoPoint, 2> points = {
+      BarelyTempoPoint{1.0, 60.0, true},
+      BarelyTempoPoint{3.0, 180.0, false},
+  };
+  tempo_map.SetPoints(points);
+  EXPECT_DOUBLE_EQ(tempo_map.GetTempo(2.0), 120.0);
+  EXPECT_DOUBLE_EQ(tempo_map.GetTempo(4.0), 180.0);
+
+  EXPECT_DOUBLE_EQ(tempo_map.GetBeats(1.0, 3.0), 4.0);
+  EXPECT_DOUBLE_EQ(tempo_map.GetBeats(1.0, 2.0), 1.5);
+  EXPECT_DOUBLE_EQ(tempo_map.GetBeats(0.0, 4.0), 8.0);
+
+  EXPECT_DOUBLE_EQ(tempo_map.GetTimestamp(1.0, 1.5), 2.0);
+  EXPECT_DOUBLE_EQ(tempo_map.GetTimestamp(2.0, 2.5), 3.0);
+  EXPECT_DOUBLE_EQ(tempo_map.GetTimestamp(0.0, 8.0), 4.0);
+
+  // Conversions should round trip within the ramp.
+  for (int i = 0; i <= 20; ++i) {
+    const double timestamp = 0.75 + 0.125 * static_cast<double>(i);
+    EXPECT_NEAR(tempo_map.GetTimestamp(0.5, tempo_map.GetBeats(0.5, timestamp)), timestamp, 1e-12);
+  }
+}
+
+}  // namespace
+}  // namespace barely
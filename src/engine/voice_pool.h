@@ -0,0 +1,87 @@
+#ifndef BARELYMUSICIAN_ENGINE_VOICE_POOL_H_
+#define BARELYMUSICIAN_ENGINE_VOICE_POOL_H_
+
+#include <barelymusician.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+#include "core/arena.h"
+#include "core/pool.h"
+#include "engine/voice_state.h"
+
+namespace barely {
+
+// Pool of voices, which packs the per-sample voice states in their active order for the render
+// loop, while the note states stay at their voice indices for the command handlers.
+class VoicePool {
+ public:
+  VoicePool(Arena& arena, uint32_t count) noexcept
+      : states_(arena.AllocBuffer<VoiceState>(count)), note_pool_(arena, count) {}
+
+  // Acquires a new voice at the end of the active voices, or returns invalid index if maximum
+  // capacity was reached.
+  [[nodiscard]] uint32_t Acquire() noexcept { return note_pool_.Acquire(); }
+
+  // Releases a voice, where the last active voice state moves into its place.
+  void Release(uint32_t voice_index) noexcept {
+    const uint32_t active_index = note_pool_.GetActiveIndex(voice_index);
+    if (const uint32_t last_active_index = note_pool_.ActiveCount() - 1;
+        active_index != last_active_index) {
+      states_[active_index] = states_[last_active_index];
+    }
+    note_pool_.Release(voice_index);
+  }
+
+  [[nodiscard]] uint32_t ActiveCount() const noexcept { return note_pool_.ActiveCount(); }
+
+  [[nodiscard]] uint32_t Count() const noexcept { return note_pool_.Count(); }
+
+  [[nodiscard]] uint32_t MaxActiveCount() const noexcept { return note_pool_.MaxActiveCount(); }
+
+  [[nodiscard]] bool CanAcquire() const noexcept { return note_pool_.CanAcquire(); }
+
+  [[nodiscard]] bool IsActive(uint32_t voice_index) const noexcept {
+    return note_pool_.IsActive(voice_index);
+  }
+
+  [[nodiscard]] uint32_t GetActive(uint32_t active_index) const noexcept {
+    return note_pool_.GetActive(active_index);
+  }
+
+  [[nodiscard]] VoiceState& GetActiveState(uint32_t active_index) noexcept {
+    assert(active_index < note_pool_.ActiveCount());
+    return states_[active_index];
+  }
+
+  [[nodiscard]] VoiceNoteState& GetNote(uint32_t voice_index) noexcept {
+    return note_pool_.Get(voice_index);
+  }
+  [[nodiscard]] const VoiceNoteState& GetNote(uint32_t voice_index) const noexcept {
+    return note_pool_.Get(voice_index);
+  }
+
+  [[nodiscard]] VoiceState& GetState(uint32_t voice_index) noexcept {
+    return states_[note_pool_.GetActiveIndex(voice_index)];
+  }
+  [[nodiscard]] const VoiceState& GetState(uint32_t voice_index) const noexcept {
+    return states_[note_pool_.GetActiveIndex(voice_index)];
+  }
+
+  // Moves the voices into the larger arrays of another pool, keeping their indices, and takes over
+  // those arrays.
+  void Extend(VoicePool& other) noexcept {
+    std::copy_n(states_, note_pool_.ActiveCount(), other.states_);
+    note_pool_.Extend(other.note_pool_);
+    states_ = other.states_;
+  }
+
+ private:
+  VoiceState* states_ = nullptr;  // in active order
+  Pool<VoiceNoteState> note_pool_;
+};
+
+}  // namespace barely
+
+#endif  // BARELYMUSICIAN_ENGINE_VOICE_POOL_H_
@@ -0,0 +1,47 @@
+#include "engine/voice_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "core/arena.h"
+#include "core/constants.h"
+#include "gtest/gtest.h"
+
+namespace barely {
+namespace {
+
+TEST(VoicePoolTest, ReleasePacksStates) {
+  constexpr uint32_t kCount = 4;
+
+  const auto size = GetAllocSize<VoicePool>(kCount);
+  auto data = std::make_unique<std::byte[]>(size);
+  Arena arena(data.get(), size);
+
+  VoicePool pool(arena, kCount);
+  for (uint32_t i = 0; i < kCount; ++i) {
+    const uint32_t voice_index = pool.Acquire();
+    ASSERT_NE(voice_index, kInvalidIndex);
+    pool.GetState(voice_index).slice_index = voice_index;
+    pool.GetNote(voice_index).pitch = static_cast<float>(voice_index);
+  }
+  EXPECT_FALSE(pool.CanAcquire());
+
+  // The last active state should move into the released slot, while the notes stay in place.
+  const uint32_t released_voice_index = pool.GetActive(1);
+  const uint32_t last_voice_index = pool.GetActive(kCount - 1);
+  pool.Release(released_voice_index);
+  EXPECT_EQ(pool.ActiveCount(), kCount - 1);
+  EXPECT_FALSE(pool.IsActive(released_voice_index));
+  EXPECT_EQ(pool.GetActive(1), last_voice_index);
+  EXPECT_EQ(pool.GetActiveState(1).slice_index, last_voice_index);
+
+  for (uint32_t i = 0; i < pool.ActiveCount(); ++i) {
+    const uint32_t voice_index = pool.GetActive(i);
+    EXPECT_EQ(pool.GetState(voice_index).slice_index, voice_index);
+    EXPECT_FLOAT_EQ(pool.GetNote(voice_index).pitch, static_cast<float>(voice_index));
+  }
+}
+
+}  // namespace
+}  // namespace barely
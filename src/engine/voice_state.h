@@ -2,23 +2,32 @@
 #define BARELYMUSICIAN_ENGINE_VOICE_STATE_H_
 
 #include <array>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
 
+#include "core/arena.h"
 #include "core/constants.h"
 #include "core/control.h"
+#include "core/rng.h"
 #include "dsp/bit_crusher.h"
 #include "dsp/envelope.h"
 #include "dsp/tone_filter.h"
 #include "engine/params.h"
+#include "engine/slice_state.h"
 
 namespace barely {
 
-struct VoiceState {
-  BitCrusher bit_crusher = {};
+// Per-sample state of a voice, which is packed in the active order of the voice pool for the render
+// loop. The processing state that changes in each sample fits in the first cache line with the note
+// parameters, followed by the voice stream and parameters, and the note flags.
+struct alignas(kCacheLineSize) VoiceState {
   Envelope envelope = {};
+  BitCrusher bit_crusher = {};
   ToneFilter filter = {};
 
-  VoiceParams params = {};
+  float osc_phase = 0.0f;
+  float slice_offset = 0.0f;
 
   struct {
     float gain = 1.0f;
@@ -26,22 +35,20 @@ struct VoiceState {
     float slice_increment = 0.0f;
   } note_params = {};
 
-  float pitch = 0.0f;
-  float pitch_shift = 0.0f;
-
-  float osc_phase = 0.0f;
-  float slice_offset = 0.0f;
+  AudioRng rng = {};  // seeded in each note on to keep the voice streams independent.
 
   uint32_t instrument_index = kInvalidIndex;
   uint32_t slice_index = kInvalidIndex;
 
-  uint32_t prev_voice_index = kInvalidIndex;
-  uint32_t next_voice_index = kInvalidIndex;
-
-  uint32_t timestamp = 0;  // incremented in each voice start for round-robin voice stealing.
+  VoiceParams params = {};
 
   bool stop_on_slice_end = false;
 
+  // Render cache entry, which is played back instead of processing the voice unless recording.
+  bool is_render_cache_recording = false;
+  uint32_t render_cache_entry_index = kInvalidIndex;
+  uint32_t render_cache_frame = 0;
+
   void Approach(const VoiceParams& new_params, float coeff) noexcept {
     params.filter_params.Approach(new_params.filter_params, coeff);
     ApproachValue(params.gain, note_params.gain * new_params.gain, coeff);
@@ -60,23 +67,19 @@ struct VoiceState {
   }
 
   void Start(const InstrumentParams& instrument_params, const SliceState* slice,
-             float note_pitch) noexcept {
+             float pitch) noexcept {
     params = instrument_params.voice_params;
     note_params = {.gain = 1.0f};
-    pitch = note_pitch;
-    pitch_shift = 0.0f;
-    UpdatePitchIncrements(slice);
+    UpdatePitchIncrements(slice, pitch);
     bit_crusher.Reset();
     filter.Reset();
     osc_phase = 0.0f;
     slice_offset = 0.0f;
     stop_on_slice_end = false;
     envelope.Start(instrument_params.adsr);
-    timestamp = 0;
   }
 
-  void UpdatePitchIncrements(const SliceState* slice) noexcept {
-    const float shifted_pitch = pitch + pitch_shift;
+  void UpdatePitchIncrements(const SliceState* slice, float shifted_pitch) noexcept {
     note_params.osc_increment = std::pow(2.0f, shifted_pitch);
     note_params.slice_increment =
         (slice != nullptr && slice->sample_count > 0)
@@ -85,6 +88,22 @@ struct VoiceState {
   }
 };
 
+static_assert(offsetof(VoiceState, note_params) + sizeof(VoiceState::note_params) <=
+              kCacheLineSize);
+
+// Note state of a voice, which stays at its voice index for the command handlers.
+struct VoiceNoteState {
+  float pitch = 0.0f;
+  float pitch_shift = 0.0f;
+
+  uint32_t prev_voice_index = kInvalidIndex;
+  uint32_t next_voice_index = kInvalidIndex;
+
+  uint32_t timestamp = 0;  // incremented in each voice start for round-robin voice stealing.
+
+  [[nodiscard]] float GetShiftedPitch() const noexcept { return pitch + pitch_shift; }
+};
+
 }  // namespace barely
 
 #endif  // BARELYMUSICIAN_ENGINE_VOICE_STATE_H_